@@ -0,0 +1,56 @@
+// Measures how BFS expansion scales with the number of threads, from one
+// thread up to the hardware concurrency.
+//
+// Usage: bench_bfs_threads [bfs_depth...]   (e.g. 16 20)
+
+#include <fmt/format.h>
+
+#include <algorithm>
+#include <cstddef>
+#include <optional>
+#include <random>
+#include <thread>
+#include <vector>
+
+#include "bench_common.hpp"
+#include "graph.hpp"
+#include "table.hpp"
+
+constexpr uint32_t c_deck_seed = 2;
+
+auto make_table() -> Table {
+    std::optional<std::mt19937> rng = std::mt19937(c_deck_seed);
+    return Table(random_deck(rng));
+}
+
+auto thread_counts() -> std::vector<size_t> {
+    size_t max_threads =
+        std::max<size_t>(1, std::thread::hardware_concurrency());
+    std::vector<size_t> counts;
+    for (size_t n = 1; n < max_threads; n *= 2) {
+        counts.push_back(n);
+    }
+    counts.push_back(max_threads);
+    return counts;
+}
+
+auto main(int argc, char** argv) -> int {
+    auto depths = parse_sizes(argc, argv, {16, 20});
+    for (size_t depth : depths) {
+        double serial_s = 0.0;
+        for (size_t n_threads : thread_counts()) {
+            Graph graph(make_table());
+            double bfs_s = time_seconds(
+                [&] { graph.generate_bfs(depth, std::nullopt, n_threads); });
+            if (n_threads == 1) {
+                serial_s = bfs_s;
+                fmt::print("depth {}: {} nodes, {} edges\n", depth,
+                           graph.size(), graph.n_edges());
+            }
+            fmt::print("  {:>3} threads  {:>8.3f} Mnodes/s  {:>5.2f}x\n",
+                       n_threads, mops(graph.size(), bfs_s),
+                       serial_s / bfs_s);
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,41 @@
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <cstdlib>
+#include <string>
+#include <vector>
+
+// Runs `fn` once and returns the elapsed wall-clock time in seconds.
+template <typename Fn>
+auto time_seconds(Fn&& fn) -> double {
+    auto start = std::chrono::steady_clock::now();
+    fn();
+    auto end = std::chrono::steady_clock::now();
+    return std::chrono::duration<double>(end - start).count();
+}
+
+// Operations per second, in millions.
+inline auto mops(size_t n_ops, double seconds) -> double {
+    return static_cast<double>(n_ops) / seconds / 1e6;
+}
+
+// Parses positional arguments as sizes, falling back to `defaults`.
+inline auto parse_sizes(int argc, char** argv,
+                        const std::vector<size_t>& defaults)
+    -> std::vector<size_t> {
+    if (argc < 2) {
+        return defaults;
+    }
+    std::vector<size_t> sizes;
+    for (int i = 1; i < argc; i++) {
+        sizes.push_back(static_cast<size_t>(std::stod(argv[i])));
+    }
+    return sizes;
+}
+
+// Prevents the compiler from optimising away a computed value.
+template <typename T>
+inline auto do_not_optimise(const T& value) -> void {
+    asm volatile("" : : "r,m"(value) : "memory");
+}
@@ -0,0 +1,82 @@
+// Compares the linked `Table` layout with the array-backed `StackTable` on
+// greedy playouts: each step generates the legal moves, ranks them with
+// `move_value` and applies the best one, which is the inner loop of a
+// solver.
+//
+// Usage: bench_layouts [n_games...]   (e.g. 100 1000)
+
+#include <fmt/format.h>
+
+#include <cstddef>
+#include <optional>
+#include <random>
+#include <utility>
+#include <vector>
+
+#include "bench_common.hpp"
+#include "moves.hpp"
+#include "ranking.hpp"
+#include "stack_table.hpp"
+#include "table.hpp"
+
+constexpr uint32_t c_deck_seed = 2;
+constexpr size_t c_max_steps = 200;
+
+template <typename TableT>
+auto playout(TableT table) -> size_t {
+    std::optional<Move> prev_move;
+    size_t steps = 0;
+    for (; steps < c_max_steps; steps++) {
+        auto moves = generate_moves(table, prev_move);
+        if (moves.empty()) {
+            break;
+        }
+        Move best = moves[0];
+        size_t best_value = move_value(best, table);
+        for (const Move& move : moves) {
+            size_t value = move_value(move, table);
+            if (value > best_value) {
+                best = move;
+                best_value = value;
+            }
+        }
+        apply_move(table, best);
+        prev_move = best;
+    }
+    return steps;
+}
+
+template <typename TableT>
+auto run(const std::vector<TableT>& tables) -> std::pair<size_t, double> {
+    size_t n_steps = 0;
+    double seconds = time_seconds([&] {
+        for (const auto& table : tables) {
+            n_steps += playout(table);
+        }
+    });
+    do_not_optimise(n_steps);
+    return {n_steps, seconds};
+}
+
+auto main(int argc, char** argv) -> int {
+    auto game_counts = parse_sizes(argc, argv, {100, 1000});
+    std::optional<std::mt19937> rng = std::mt19937(c_deck_seed);
+    fmt::print("sizeof(Table) {} B, sizeof(StackTable) {} B\n", sizeof(Table),
+               sizeof(StackTable));
+    for (size_t n_games : game_counts) {
+        std::vector<Table> tables;
+        std::vector<StackTable> stack_tables;
+        for (size_t i = 0; i < n_games; i++) {
+            tables.emplace_back(random_deck(rng));
+            stack_tables.emplace_back(tables.back());
+        }
+        auto [linked_steps, linked_s] = run(tables);
+        auto [stack_steps, stack_s] = run(stack_tables);
+        fmt::print("{} games, {} steps\n", n_games, linked_steps);
+        fmt::print("  Table             {:>8.3f} Msteps/s\n",
+                   mops(linked_steps, linked_s));
+        fmt::print("  StackTable        {:>8.3f} Msteps/s\n",
+                   mops(stack_steps, stack_s));
+    }
+    return 0;
+}
@@ -0,0 +1,117 @@
+// Measures move generation throughput over the states of a BFS graph, and
+// the node expansion rate of the BFS itself. It also compares expanding a
+// state by copying the table for every child with applying and undoing
+// each move on the table in place.
+//
+// The `std::vector` column reproduces the allocations the generator made
+// before it wrote into an inline `MoveList`: a vector reserved for eight
+// moves, plus a second vector when filtering against the previous move.
+//
+// Usage: bench_moves [bfs_depth...]   (e.g. 12 16 20)
+
+#include <fmt/format.h>
+
+#include <algorithm>
+#include <cstddef>
+#include <iterator>
+#include <optional>
+#include <random>
+#include <vector>
+
+#include "bench_common.hpp"
+#include "graph.hpp"
+#include "legality.hpp"
+#include "moves.hpp"
+#include "table.hpp"
+
+constexpr uint32_t c_deck_seed = 2;
+constexpr size_t c_repeats = 5;
+
+auto make_table() -> Table {
+    std::optional<std::mt19937> rng = std::mt19937(c_deck_seed);
+    return Table(random_deck(rng));
+}
+
+auto generate_moves_vector(const Table& table, std::optional<Move> prev_move)
+    -> std::vector<Move> {
+    auto list = generate_moves(table);
+    std::vector<Move> moves;
+    moves.reserve(8);
+    std::ranges::copy(list, std::back_inserter(moves));
+    if (!prev_move) {
+        return moves;
+    }
+    std::vector<Move> filtered_moves;
+    filtered_moves.reserve(8);
+    std::ranges::copy_if(
+        moves, std::back_inserter(filtered_moves),
+        [&prev_move](const Move& m) { return !prev_move->is_opposite(m); });
+    return filtered_moves;
+}
+
+auto main(int argc, char** argv) -> int {
+    auto depths = parse_sizes(argc, argv, {12, 16, 20});
+    fmt::print("tableau target kernel: {}\n", tableau_targets_kernel());
+    for (size_t depth : depths) {
+        Graph graph(make_table());
+        double bfs_s = time_seconds([&] { graph.generate_bfs(depth); });
+        std::vector<Table> tables;
+        tables.reserve(graph.size());
+        for (NodeId id = 0; id < graph.size(); id++) {
+            tables.push_back(graph.table(id));
+        }
+        const auto prev_move = Move::create_stock_to_waste();
+        size_t n_moves = 0;
+        double list_s = time_seconds([&] {
+            for (size_t r = 0; r < c_repeats; r++) {
+                for (const auto& table : tables) {
+                    n_moves += generate_moves(table, prev_move).size();
+                }
+            }
+        });
+        double vector_s = time_seconds([&] {
+            for (size_t r = 0; r < c_repeats; r++) {
+                for (const auto& table : tables) {
+                    n_moves += generate_moves_vector(table, prev_move).size();
+                }
+            }
+        });
+        uint64_t hashes = 0;
+        size_t n_children = 0;
+        double copy_s = time_seconds([&] {
+            for (const auto& table : tables) {
+                for (const auto& move : generate_moves(table)) {
+                    Table child = table;
+                    apply_move(child, move);
+                    hashes ^= child.hash();
+                    n_children++;
+                }
+            }
+        });
+        double undo_s = time_seconds([&] {
+            for (Table table : tables) {
+                for (const auto& move : generate_moves(table)) {
+                    UndoRecord undo = apply_move(table, move);
+                    hashes ^= table.hash();
+                    undo_move(table, undo);
+                }
+            }
+        });
+        do_not_optimise(n_moves);
+        do_not_optimise(hashes);
+        size_t n_generated = tables.size() * c_repeats;
+        fmt::print("depth {}: {} nodes, {} edges\n", depth, graph.size(),
+                   graph.n_edges());
+        fmt::print("  BFS expansion     {:>8.3f} Mnodes/s\n",
+                   mops(graph.size(), bfs_s));
+        fmt::print("  MoveList          {:>8.3f} Mstates/s\n",
+                   mops(n_generated, list_s));
+        fmt::print("  std::vector       {:>8.3f} Mstates/s\n",
+                   mops(n_generated, vector_s));
+        fmt::print("  copy + apply      {:>8.3f} Mchildren/s\n",
+                   mops(n_children, copy_s));
+        fmt::print("  apply + undo      {:>8.3f} Mchildren/s\n",
+                   mops(n_children, undo_s));
+    }
+    return 0;
+}
@@ -0,0 +1,173 @@
+// Load-tests the query server of `rose --query`: the BFS graph of a deal
+// is written to graph.bin and mapped, and client threads each keep one
+// connection open and send random queries of every kind back to back.
+// Reports the latency percentiles of each kind of query as the clients
+// see them, including the round trip through the loopback interface.
+//
+// Usage: bench_queries [bfs_depth...]   (e.g. 12 16)
+
+#include <arpa/inet.h>
+#include <fmt/format.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <filesystem>  // NOLINT(build/c++17)
+#include <numeric>
+#include <optional>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+#include "bench_common.hpp"
+#include "graph.hpp"
+#include "graph_file.hpp"
+#include "http_server.hpp"
+#include "query.hpp"
+#include "serialise.hpp"
+#include "table.hpp"
+
+constexpr uint32_t c_deck_seed = 2;
+constexpr size_t c_n_clients = 4;
+constexpr size_t c_queries_per_client = 5000;
+
+constexpr std::array<std::string_view, 4> c_kinds = {
+    "/node", "/neighbourhood", "/path", "/children"};
+
+// One keep-alive connection that sends a request and waits for the whole
+// response before sending the next.
+class QueryClient {
+   public:
+    explicit QueryClient(uint16_t port)
+        : m_fd(::socket(AF_INET, SOCK_STREAM, 0)) {
+        sockaddr_in address{};
+        address.sin_family = AF_INET;
+        address.sin_port = htons(port);
+        address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        if (::connect(m_fd, reinterpret_cast<sockaddr*>(&address),
+                      sizeof(address)) != 0) {
+            throw std::runtime_error("Cannot connect to the query server");
+        }
+        int no_delay = 1;
+        ::setsockopt(m_fd, IPPROTO_TCP, TCP_NODELAY, &no_delay,
+                     sizeof(no_delay));
+    }
+    ~QueryClient() { ::close(m_fd); }
+    QueryClient(const QueryClient&) = delete;
+    auto operator=(const QueryClient&) -> QueryClient& = delete;
+
+    // Returns the size of the response body.
+    auto get(const std::string& target) -> size_t {
+        std::string request = "GET " + target + " HTTP/1.1\r\n\r\n";
+        if (::send(m_fd, request.data(), request.size(), MSG_NOSIGNAL) !=
+            static_cast<ssize_t>(request.size())) {
+            throw std::runtime_error("Cannot send a query");
+        }
+        size_t head_end;
+        while ((head_end = m_buffer.find("\r\n\r\n")) == std::string::npos) {
+            receive();
+        }
+        constexpr std::string_view c_length = "Content-Length: ";
+        size_t length_at = m_buffer.find(c_length) + c_length.size();
+        size_t body_size = std::stoul(m_buffer.substr(length_at));
+        size_t end = head_end + 4 + body_size;
+        while (m_buffer.size() < end) {
+            receive();
+        }
+        m_buffer.erase(0, end);
+        return body_size;
+    }
+
+   private:
+    int m_fd;
+    std::string m_buffer;
+
+    auto receive() -> void {
+        std::array<char, 65536> chunk;
+        ssize_t n = ::recv(m_fd, chunk.data(), chunk.size(), 0);
+        if (n <= 0) {
+            throw std::runtime_error("The query server closed the connection");
+        }
+        m_buffer.append(chunk.data(), static_cast<size_t>(n));
+    }
+};
+
+auto percentile(std::vector<double>& samples, double p) -> double {
+    size_t rank = static_cast<size_t>(p * static_cast<double>(samples.size()));
+    rank = std::min(rank, samples.size() - 1);
+    std::ranges::nth_element(samples, samples.begin() + rank);
+    return samples[rank];
+}
+
+auto main(int argc, char** argv) -> int {
+    auto depths = parse_sizes(argc, argv, {12, 16});
+    auto path = std::filesystem::temp_directory_path() / "bench_queries.bin";
+    for (size_t depth : depths) {
+        {
+            std::optional<std::mt19937> rng = std::mt19937(c_deck_seed);
+            Graph graph{Table(random_deck(rng))};
+            graph.generate_bfs(depth);
+            write_graph_to_binary_file(graph, path, depth);
+        }
+        GraphFile file(path);
+        GraphQueries queries(file);
+        HttpServer server(0, [&](const HttpRequest& request,
+                                 HttpConnection& connection) {
+            return connection.respond(answer_query(queries, request));
+        });
+        // Latencies in microseconds, by client and kind of query.
+        std::vector<std::array<std::vector<double>, c_kinds.size()>> latencies(
+            c_n_clients);
+        std::vector<size_t> bytes(c_n_clients, 0);
+        double seconds = time_seconds([&] {
+            std::vector<std::jthread> clients;
+            for (size_t c = 0; c < c_n_clients; c++) {
+                clients.emplace_back([&, c] {
+                    std::mt19937 rng(static_cast<uint32_t>(c));
+                    std::uniform_int_distribution<NodeId> node(
+                        0, static_cast<NodeId>(file.size() - 1));
+                    QueryClient client(server.port());
+                    for (size_t i = 0; i < c_queries_per_client; i++) {
+                        size_t kind = i % c_kinds.size();
+                        auto target =
+                            fmt::format("{}?id={}", c_kinds[kind], node(rng));
+                        auto start = std::chrono::steady_clock::now();
+                        bytes[c] += client.get(target);
+                        auto end = std::chrono::steady_clock::now();
+                        latencies[c][kind].push_back(
+                            std::chrono::duration<double, std::micro>(end -
+                                                                      start)
+                                .count());
+                    }
+                });
+            }
+        });
+        size_t n_queries = c_n_clients * c_queries_per_client;
+        fmt::print("depth {}: {} nodes, {} edges\n", depth, file.size(),
+                   file.n_edges());
+        size_t n_bytes = std::accumulate(bytes.begin(), bytes.end(), 0UZ);
+        fmt::print("  {} clients, {:.0f} queries/s, {:.1f} MB/s\n",
+                   c_n_clients, static_cast<double>(n_queries) / seconds,
+                   static_cast<double>(n_bytes) / seconds / 1e6);
+        for (size_t kind = 0; kind < c_kinds.size(); kind++) {
+            std::vector<double> samples;
+            for (const auto& client : latencies) {
+                samples.insert(samples.end(), client[kind].begin(),
+                               client[kind].end());
+            }
+            fmt::print(
+                "  {:<16} p50 {:>8.1f} us  p99 {:>8.1f} us  max {:>8.1f} us\n",
+                c_kinds[kind], percentile(samples, 0.5),
+                percentile(samples, 0.99), std::ranges::max(samples));
+        }
+    }
+    std::filesystem::remove(path);
+}
@@ -0,0 +1,92 @@
+// Runs the best-first and depth-first solvers on a fixed set of random deals
+// and reports how many were won, lost or ran out of budget, with the mean
+// and median expansions and time per deal.
+//
+// Usage: bench_solver [n_deals...]   (e.g. 20 100)
+
+#include <fmt/format.h>
+
+#include <algorithm>
+#include <cstddef>
+#include <functional>
+#include <optional>
+#include <random>
+#include <string_view>
+#include <vector>
+
+#include "bench_common.hpp"
+#include "solver.hpp"
+#include "table.hpp"
+
+constexpr uint32_t c_deck_seed = 2;
+constexpr size_t c_max_expansions = 200000;
+constexpr size_t c_tt_bytes = size_t{64} << 20;
+
+template <typename T>
+auto median(std::vector<T> values) -> T {
+    std::ranges::nth_element(values, values.begin() + (values.size() / 2));
+    return values[values.size() / 2];
+}
+
+using Solver = std::function<SolveResult(const Table&)>;
+
+auto bench_solver(std::string_view name, const Solver& solve, size_t n_deals)
+    -> void {
+    std::optional<std::mt19937> rng = std::mt19937(c_deck_seed);
+    size_t n_won = 0;
+    size_t n_lost = 0;
+    size_t n_moves = 0;
+    std::vector<size_t> expansions;
+    std::vector<double> seconds;
+    for (size_t i = 0; i < n_deals; i++) {
+        Table table(random_deck(rng));
+        SolveResult result;
+        seconds.push_back(time_seconds([&] {
+            result = solve(table);
+        }));
+        expansions.push_back(result.m_expanded);
+        if (result.m_status == SolveStatus::Won) {
+            n_won++;
+            n_moves += result.m_moves.size();
+        } else if (result.m_status == SolveStatus::Lost) {
+            n_lost++;
+        }
+    }
+    fmt::print("{}, {} deals: {} won, {} lost, {} out of budget\n", name,
+               n_deals, n_won, n_lost, n_deals - n_won - n_lost);
+    double total_expanded = 0.0;
+    double total_seconds = 0.0;
+    for (size_t i = 0; i < n_deals; i++) {
+        total_expanded += static_cast<double>(expansions[i]);
+        total_seconds += seconds[i];
+    }
+    auto n = static_cast<double>(n_deals);
+    fmt::print("  expansions        {:>10.0f} mean {:>10} median\n",
+               total_expanded / n, median(expansions));
+    fmt::print("  time              {:>10.3f} mean {:>10.3f} median (ms)\n",
+               total_seconds * 1e3 / n, median(seconds) * 1e3);
+    if (n_won > 0) {
+        fmt::print("  mean winning line {:>10.1f} moves\n",
+                   static_cast<double>(n_moves) /
+                       static_cast<double>(n_won));
+    }
+}
+
+auto main(int argc, char** argv) -> int {
+    auto deal_counts = parse_sizes(argc, argv, {20});
+    for (size_t n_deals : deal_counts) {
+        bench_solver(
+            "best-first",
+            [](const Table& table) {
+                return solve_best_first(table, c_max_expansions);
+            },
+            n_deals);
+        bench_solver(
+            "depth-first",
+            [](const Table& table) {
+                return solve_depth_first(table, c_tt_bytes, c_max_expansions);
+            },
+            n_deals);
+    }
+    return 0;
+}
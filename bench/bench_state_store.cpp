@@ -0,0 +1,100 @@
+// Compares the open-addressing `StateStore` against the hash-ordered
+// `std::set` that `Graph` used to deduplicate states.
+//
+// Usage: bench_state_store [n_states...]   (e.g. 1e5 1e6 1e7 1e8)
+
+#include <fmt/format.h>
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <random>
+#include <set>
+#include <vector>
+
+#include "bench_common.hpp"
+#include "state_store.hpp"
+#include "table.hpp"
+
+struct HashLess {
+    auto operator()(const Table& a, const Table& b) const -> bool {
+        return a.hash() < b.hash();
+    }
+};
+
+auto make_tables(size_t n, uint32_t seed) -> std::vector<Table> {
+    std::optional<std::mt19937> rng = std::mt19937(seed);
+    std::vector<Table> tables;
+    tables.reserve(n);
+    for (size_t i = 0; i < n; i++) {
+        tables.emplace_back(random_deck(rng));
+    }
+    return tables;
+}
+
+auto bench_state_store(const std::vector<Table>& present,
+                       const std::vector<Table>& absent) -> void {
+    StateStore store;
+    double insert_s = time_seconds([&] {
+        for (const auto& table : present) {
+            store.insert(table);
+        }
+    });
+    size_t found = 0;
+    double hit_s = time_seconds([&] {
+        for (const auto& table : present) {
+            found += static_cast<size_t>(store.contains(table));
+        }
+    });
+    double miss_s = time_seconds([&] {
+        for (const auto& table : absent) {
+            found += static_cast<size_t>(store.contains(table));
+        }
+    });
+    do_not_optimise(found);
+    size_t n = present.size();
+    fmt::print("  {:<12} insert {:>8.2f} Mops/s  hit {:>8.2f} Mops/s  "
+               "miss {:>8.2f} Mops/s\n",
+               "StateStore", mops(n, insert_s), mops(n, hit_s),
+               mops(absent.size(), miss_s));
+}
+
+auto bench_std_set(const std::vector<Table>& present,
+                   const std::vector<Table>& absent) -> void {
+    std::set<Table, HashLess> set;
+    double insert_s = time_seconds([&] {
+        for (const auto& table : present) {
+            set.insert(table);
+        }
+    });
+    size_t found = 0;
+    double hit_s = time_seconds([&] {
+        for (const auto& table : present) {
+            found += static_cast<size_t>(set.contains(table));
+        }
+    });
+    double miss_s = time_seconds([&] {
+        for (const auto& table : absent) {
+            found += static_cast<size_t>(set.contains(table));
+        }
+    });
+    do_not_optimise(found);
+    size_t n = present.size();
+    fmt::print("  {:<12} insert {:>8.2f} Mops/s  hit {:>8.2f} Mops/s  "
+               "miss {:>8.2f} Mops/s\n",
+               "std::set", mops(n, insert_s), mops(n, hit_s),
+               mops(absent.size(), miss_s));
+}
+
+auto main(int argc, char** argv) -> int {
+    auto sizes = parse_sizes(argc, argv, {100'000, 1'000'000});
+    for (size_t n : sizes) {
+        auto present = make_tables(n, 1);
+        auto absent = make_tables(std::min<size_t>(n, 1'000'000), 2);
+        fmt::print("{} states\n", n);
+        bench_state_store(present, absent);
+        bench_std_set(present, absent);
+    }
+    return 0;
+}
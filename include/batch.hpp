@@ -0,0 +1,53 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <istream>
+#include <optional>
+#include <ostream>
+#include <string_view>
+
+#include "common.hpp"
+#include "nlohmann/json.hpp"
+
+// One deck of a corpus, with its position among the decks of the corpus
+// and the seed it was shuffled from, if any.
+struct CorpusDeck {
+    size_t m_index;
+    std::optional<uint32_t> m_seed;
+    std::array<uint8_t, c_num_cards> m_deck;
+};
+
+// Parses one line of a corpus: either a seed, shuffled as `rose` shuffles
+// a random deck, or 52 whitespace-separated cards, dealt in the order of a
+// deck file. Returns nothing for blank lines and lines starting with '#'.
+// Throws `std::invalid_argument` for anything else.
+[[nodiscard]] auto parse_corpus_line(std::string_view line, size_t index)
+    -> std::optional<CorpusDeck>;
+
+// Reads decks from a corpus one line at a time, so corpora of millions of
+// decks are never held in memory.
+class CorpusReader {
+   public:
+    explicit CorpusReader(std::istream& in) : m_in(in) {}
+
+    // The next deck, or nothing at the end of the corpus.
+    auto next() -> std::optional<CorpusDeck>;
+
+   private:
+    std::istream& m_in;
+    size_t m_n_decks{0};
+    size_t m_line{0};
+};
+
+using DeckJob = std::function<nlohmann::json(const CorpusDeck&)>;
+
+// Runs `job` on every deck of `corpus` on `n_threads` threads and writes
+// each result to `out` as one line of JSON as soon as it is ready, so the
+// records are in completion order and carry the deck's index. Returns the
+// number of decks run. An exception from the corpus or a job stops every
+// thread and is rethrown.
+auto run_batch(CorpusReader& corpus, size_t n_threads, const DeckJob& job,
+               std::ostream& out) -> size_t;
@@ -0,0 +1,26 @@
+#pragma once
+
+#include <cstdint>
+#include <filesystem>  // NOLINT(build/c++17)
+
+#include "graph.hpp"
+
+// Version of the checkpoint layout, bumped whenever it changes.
+constexpr uint32_t c_checkpoint_version = 1;
+
+// Writes the graph, including its BFS frontier, so that a later run can
+// load it with `read_checkpoint` and continue the BFS with `generate_bfs`.
+// The file is written next to `path` and renamed over it once complete, so
+// an interrupted write leaves the previous checkpoint intact.
+//
+// Layout, in native byte order:
+//   "ROSECKPT", u32 version, u64 node count, u64 edge count,
+//   u32 first frontier node,
+//   per node: packed table, u32 depth, u32 edge count,
+//   per edge, grouped by source node: u32 target, u16 move.
+auto write_checkpoint(const Graph& graph, const std::filesystem::path& path)
+    -> void;
+
+// Throws `std::runtime_error` if the file cannot be read or is not a valid
+// checkpoint of this version.
+[[nodiscard]] auto read_checkpoint(const std::filesystem::path& path) -> Graph;
@@ -0,0 +1,49 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "graph.hpp"
+
+// An undirected graph whose edges are stored in both directions, in CSR
+// form, weighted by the number of edges of the `Graph` they stand for. A
+// node's mass is that of ForceAtlas2, its degree plus one, summed over the
+// nodes of the `Graph` it stands for.
+struct WeightedGraph {
+    std::vector<uint32_t> m_offsets;
+    std::vector<uint32_t> m_neighbours;
+    std::vector<float> m_weights;
+    std::vector<float> m_masses;
+
+    [[nodiscard]] auto size() const -> size_t { return m_masses.size(); }
+};
+
+// The graph with edge directions dropped, as the finest level of a
+// coarsening. Self-loops are dropped too.
+[[nodiscard]] auto weighted_graph_of(const Graph& graph) -> WeightedGraph;
+
+// Groups the nodes of `fine` into clusters of a few neighbouring nodes and
+// returns the cluster of each node. Clusters are numbered in the order of
+// their first node, so the first node of each cluster is its smallest.
+[[nodiscard]] auto cluster_nodes(const WeightedGraph& fine)
+    -> std::vector<uint32_t>;
+
+// The graph whose nodes are the clusters of `fine`, with the edges between
+// two clusters merged into one.
+[[nodiscard]] auto coarsen(const WeightedGraph& fine,
+                           const std::vector<uint32_t>& cluster,
+                           size_t n_clusters) -> WeightedGraph;
+
+// A hierarchy of ever coarser graphs. `m_levels[0]` is the graph itself,
+// and `m_clusters[k]` holds the node of `m_levels[k + 1]` that each node
+// of `m_levels[k]` is clustered into.
+struct Coarsening {
+    std::vector<WeightedGraph> m_levels;
+    std::vector<std::vector<uint32_t>> m_clusters;
+};
+
+// Coarsens the graph level by level until a level has at most `max_nodes`
+// nodes, or clustering no longer shrinks it much.
+[[nodiscard]] auto coarsen_graph(const Graph& graph, size_t max_nodes)
+    -> Coarsening;
@@ -12,6 +12,7 @@
 #include <stdexcept>
 #include <string>
 #include <utility>
+#include <vector>
 
 enum Suit : uint8_t {
     spades = 0,
@@ -20,7 +21,7 @@ enum Suit : uint8_t {
     clubs = 3,
 };
 
-inline auto suit_colours_equal(Suit suit1, Suit suit2) -> bool {
+constexpr auto suit_colours_equal(Suit suit1, Suit suit2) -> bool {
     bool is_red1 = (suit1 == Suit::hearts || suit1 == Suit::diamonds);
     bool is_red2 = (suit2 == Suit::hearts || suit2 == Suit::diamonds);
     return is_red1 == is_red2;
@@ -180,3 +181,15 @@ inline auto import_deck(const std::filesystem::path& deck_path)
             std::chrono::steady_clock::now().time_since_epoch())
             .count());
 }
+
+// Bytes a vector will have reserved once `n_more` elements are appended,
+// assuming its capacity doubles whenever it is full.
+template <typename T>
+[[nodiscard]] auto vector_bytes_after(const std::vector<T>& vec, size_t n_more)
+    -> size_t {
+    size_t capacity = vec.capacity();
+    while (vec.size() + n_more > capacity) {
+        capacity = std::max<size_t>(capacity * 2, 1);
+    }
+    return capacity * sizeof(T);
+}
@@ -0,0 +1,49 @@
+#pragma once
+
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "http_server.hpp"
+
+// Streams events to browsers as Server-Sent Events at `/events`. Every
+// event published is kept, and a client that connects is sent all of
+// them before the new ones, so a page loaded late or reloaded sees the
+// whole stream. The kept events grow with the stream, so callers bounding
+// memory count them through `memory_usage`. Each client is served by its
+// own thread, so a slow client never holds up `publish`.
+class EventServer {
+   public:
+    // Listens on 127.0.0.1:`port`, or on a free port if `port` is 0.
+    // Throws `std::runtime_error` if the port cannot be bound.
+    explicit EventServer(uint16_t port);
+
+    [[nodiscard]] auto port() const -> uint16_t { return m_server.port(); }
+
+    // Sends `data`, which must be a single line such as compact JSON, as
+    // an event of type `type` to every client.
+    auto publish(std::string_view type, std::string_view data) -> void;
+
+    // Bytes held by the events kept for clients that connect later.
+    [[nodiscard]] auto memory_usage() const -> size_t;
+
+   private:
+    mutable std::mutex m_mutex;
+    std::condition_variable_any m_published;
+    // Events as they are written to the wire, shared with the threads
+    // sending them.
+    std::vector<std::shared_ptr<const std::string>> m_events;
+    size_t m_n_event_bytes{0};
+    // Last, so that it stops the threads streaming events before the
+    // events go.
+    HttpServer m_server;
+
+    auto handle(const HttpRequest& request, HttpConnection& connection)
+        -> bool;
+    auto stream_events(HttpConnection& connection) -> void;
+};
@@ -0,0 +1,43 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>  // NOLINT(build/c++17)
+#include <optional>
+#include <vector>
+
+#include "table.hpp"
+
+struct ExternalBfsResult {
+    // Number of distinct states first reached at each depth.
+    std::vector<size_t> m_layer_sizes;
+    // Depth of the shallowest won state, if one was reached.
+    std::optional<size_t> m_win_depth;
+    // Whether the last layer was empty, so the whole state space was
+    // enumerated.
+    bool m_exhausted{false};
+    bool m_timed_out{false};
+};
+
+// Path of the file holding the states at `depth`, sorted and unique.
+[[nodiscard]] auto external_layer_path(const std::filesystem::path& work_dir,
+                                       size_t depth) -> std::filesystem::path;
+
+// Breadth-first enumeration of the states reachable from `root` that keeps
+// each depth layer on disk instead of in memory. Every layer is written to
+// `external_layer_path` as packed tables. Children of a layer are gathered
+// in a buffer of `buffer_bytes`, which is sorted and spilled to a run file
+// whenever it fills. Once the layer is expanded, the runs are merged, a
+// bounded number at a time, and states already in an earlier layer are
+// dropped by merging against a file of every state seen so far, which is
+// delayed duplicate detection. File buffers are carved out of
+// `buffer_bytes` too, so memory use stays close to it whatever the size of
+// the state space.
+//
+// Layers of an earlier run in `work_dir` are overwritten or removed, so
+// the directory holds exactly the layers of `m_layer_sizes`. On timeout,
+// the layer being built is discarded and the complete layers are kept.
+auto external_bfs(const Table& root, const std::filesystem::path& work_dir,
+                  size_t max_depth, size_t buffer_bytes,
+                  std::optional<float> timeout = std::nullopt)
+    -> ExternalBfsResult;
@@ -1,137 +1,188 @@
 #pragma once
 
+#include <atomic>
 #include <cstddef>
-#include <iterator>
-#include <memory>
-#include <queue>
-#include <set>
+#include <cstdint>
+#include <filesystem>  // NOLINT(build/c++17)
+#include <optional>
+#include <span>
 #include <stack>
+#include <string_view>
 #include <utility>
 #include <vector>
 
 #include "moves.hpp"
+#include "state_store.hpp"
 #include "table.hpp"
 
-class Edge;
+// Nodes share their ids with the states in the graph's `StateStore`.
+using NodeId = StateId;
 
-class Node {
-   public:
-    Table m_table;
-    std::vector<Edge> m_edges;
-    size_t m_depth;
-    bool m_deadend;
-
-    Node(const Table& table, size_t depth);
+struct Edge {
+    NodeId m_to;
+    Move m_move;
+};
+static_assert(sizeof(Edge) == 8);
+
+// Nodes live in a contiguous arena indexed by `NodeId`. Each node's
+// outgoing edges are a contiguous run of the graph's edge array, as in a
+// CSR layout; runs are stored per node rather than as a single offsets
+// array because nodes are not always expanded in id order.
+struct Node {
+    uint32_t m_depth;
+    uint32_t m_first_edge{0};
+    uint32_t m_n_edges{0};
+
+    [[nodiscard]] auto is_deadend() const -> bool { return m_n_edges == 0; }
 };
 
-class Edge {
-   public:
-    Move m_move;
-    std::shared_ptr<Node> m_from;
-    std::shared_ptr<Node> m_to;
+// A contiguous run of frontier nodes and the children found by expanding
+// them, filled by one worker of the parallel BFS. Children that were
+// already in the graph when the level started carry their node id; new
+// ones have `m_to == c_null_state` and their packed states and tags in
+// `m_new_states`, in the same order, so committing them neither packs nor
+// hashes them again.
+struct FrontierChunk {
+    struct Child {
+        NodeId m_from;
+        NodeId m_to;
+        Move m_move;
+    };
+
+    NodeId m_begin{0};
+    NodeId m_end{0};
+    std::vector<Child> m_children;
+    std::vector<StateKey> m_new_states;
+    bool m_expanded{false};
+};
 
-    Edge(const Move& move, const std::shared_ptr<Node>& from,
-         const std::shared_ptr<Node>& to);
+// Why a BFS stopped expanding.
+enum class BfsStop : uint8_t {
+    // Every reachable state was expanded.
+    Exhausted,
+    MaxDepth,
+    Timeout,
+    MaxMemory,
+    MaxExpansions,
+    // The interrupt flag set with `Graph::set_interrupt_flag` was raised.
+    Interrupted,
 };
 
-using DepthNodeQueue = std::queue<std::pair<size_t, std::shared_ptr<Node>>>;
-using NodeQueue = std::queue<std::shared_ptr<Node>>;
-using NodeStack = std::stack<std::shared_ptr<Node>>;
+[[nodiscard]] auto bfs_stop_to_string(BfsStop stop) -> std::string_view;
 
-class NodeComparator {
-   public:
-    using is_transparent = void;
-    auto operator()(std::shared_ptr<Node> const& a,
-                    std::shared_ptr<Node> const& b) const -> bool {
-        return a->m_table.hash() < b->m_table.hash();
-    }
-    auto operator()(std::shared_ptr<Node> const& a, Table const& b) const
-        -> bool {
-        return a->m_table.hash() < b.hash();
-    }
-    auto operator()(Table const& a, std::shared_ptr<Node> const& b) const
-        -> bool {
-        return a.hash() < b->m_table.hash();
-    }
+// Where a BFS stopped. The graph is consistent whatever the reason: nodes
+// that were added but not expanded are leaves, and the next BFS continues
+// from them.
+struct BfsReport {
+    // Depth of the deepest node in the graph.
+    size_t m_depth{0};
+    BfsStop m_stop{BfsStop::Exhausted};
+    // `Graph::memory_usage` when the BFS stopped.
+    size_t m_memory_bytes{0};
+
+    auto operator==(const BfsReport& other) const -> bool = default;
 };
 
+using NodeStack = std::stack<NodeId>;
+
 class Graph {
    private:
-    std::set<std::shared_ptr<Node>, NodeComparator> m_seen_nodes;
-    std::shared_ptr<Node> m_root;
-
-    auto generate_next_tables_bfs(DepthNodeQueue& node_queue,
-                                  const std::shared_ptr<Node>& node,
-                                  size_t current_depth) -> DepthNodeQueue&;
-    auto generate_next_tables_dfs(NodeStack& node_stack,
-                                  const std::shared_ptr<Node>& node,
+    StateStore m_seen_states;
+    std::vector<Node> m_nodes;
+    std::vector<Edge> m_edges;
+    // Edges in the runs of nodes. The rest of `m_edges` is slots of runs
+    // that `add_edge` moved, until it compacts the array.
+    size_t m_n_live_edges{0};
+    // Nodes are expanded in id order and added with nondecreasing depths,
+    // so the BFS frontier is every node from this one on.
+    NodeId m_frontier_begin{0};
+    const std::atomic<bool>* m_interrupt{nullptr};
+
+    Graph() = default;
+
+    auto find_or_add_node(const StateKey& key, size_t depth)
+        -> std::pair<NodeId, bool>;
+    auto find_or_add_node(const Table& table, size_t depth)
+        -> std::pair<NodeId, bool> {
+        return find_or_add_node(StateKey::of(table), depth);
+    }
+    auto add_edge(NodeId from, NodeId to, const Move& move) -> void;
+    auto compact_edges() -> void;
+    [[nodiscard]] auto has_edge(NodeId from, const Move& move) const -> bool;
+    auto expand_node(NodeId node) -> void;
+    auto generate_next_tables_dfs(NodeStack& node_stack, NodeId node,
                                   size_t current_depth) -> NodeStack&;
+    auto expand_chunk(FrontierChunk& chunk) const -> void;
+    auto commit_chunk(const FrontierChunk& chunk, size_t child_depth) -> void;
+    auto generate_bfs_parallel(size_t depth, std::optional<float> timeout,
+                               size_t n_threads,
+                               std::optional<size_t> max_memory,
+                               std::optional<size_t> max_expansions)
+        -> BfsReport;
+    [[nodiscard]] auto expansion_memory_exceeded(
+        std::optional<size_t> max_memory) const -> bool;
+    [[nodiscard]] auto interrupted() const -> bool {
+        return m_interrupt != nullptr &&
+               m_interrupt->load(std::memory_order_relaxed);
+    }
+    [[nodiscard]] auto finish_bfs(BfsStop stop) const -> BfsReport;
 
-   public:
-    explicit Graph(const Table& initial_table);
-    [[nodiscard]] auto get_root() const -> Node { return *m_root; }
-    auto generate_bfs(size_t depth = SIZE_MAX,
-                      std::optional<float> timeout = std::nullopt) -> size_t;
-    auto generate_bfs_on_existing(size_t depth = SIZE_MAX,
-                                  std::optional<float> timeout = std::nullopt)
-        -> size_t;
-    auto generate_dfs() -> void;
+    friend auto read_checkpoint(const std::filesystem::path& path) -> Graph;
 
-    struct Iterator {
-        Iterator(
-            std::shared_ptr<Graph> graph_ptr,
-            std::unique_ptr<NodeQueue> node_queue_ptr,
-            std::unique_ptr<std::set<std::shared_ptr<Node>, NodeComparator>>
-                seen_nodes);
-        Iterator(const Iterator& other);
-        Iterator(Iterator&& other) noexcept;
-        Iterator() = default;
-
-        auto operator=(const Iterator& other) -> Iterator&;
-        auto operator=(Iterator&& other) noexcept -> Iterator&;
-
-        using iterator_concept = std::forward_iterator_tag;
-        using iterator_category = std::forward_iterator_tag;
-        using value_type = std::shared_ptr<Node>;
-        using difference_type = std::ptrdiff_t;
-        using reference = const value_type&;
-        using pointer = const value_type*;
-
-        auto operator++() -> Iterator&;
-        auto operator++(int) -> Iterator;
-        auto operator==(const Iterator& other) const -> bool;
-        auto operator!=(const Iterator& other) const -> bool;
-        auto operator*() -> reference;
-        auto operator*() const -> const value_type&;
-        auto operator->() -> pointer;
-        auto operator->() const -> const value_type*;
-        [[nodiscard]] auto owner() const -> std::shared_ptr<Graph>;
-
-       private:
-        std::shared_ptr<Graph> m_graph_ptr;
-        std::unique_ptr<NodeQueue> m_node_queue;
-        std::unique_ptr<std::set<std::shared_ptr<Node>, NodeComparator>>
-            m_seen_nodes;
-    };
+   public:
+    static constexpr NodeId c_root = 0;
 
-    auto begin() -> Iterator {
-        auto graph_copy = std::make_shared<Graph>(*this);
-        auto node_queue = std::make_unique<NodeQueue>();
-        auto seen_nodes =
-            std::make_unique<std::set<std::shared_ptr<Node>, NodeComparator>>();
-        node_queue->emplace(graph_copy->m_root);
-        return {graph_copy, std::move(node_queue), std::move(seen_nodes)};
+    explicit Graph(const Table& initial_table);
+    [[nodiscard]] auto get_root() const -> const Node& {
+        return m_nodes[c_root];
     }
-
-    [[nodiscard]] auto begin() const -> Iterator {
-        return const_cast<Graph*>(this)->begin();
+    [[nodiscard]] auto size() const -> size_t { return m_nodes.size(); }
+    [[nodiscard]] auto n_edges() const -> size_t { return m_n_live_edges; }
+    [[nodiscard]] auto node(NodeId id) const -> const Node& {
+        return m_nodes[id];
     }
-
-    auto end() -> Iterator {
-        return {std::make_shared<Graph>(*this), nullptr, nullptr};
+    [[nodiscard]] auto table(NodeId id) const -> Table {
+        return m_seen_states[id];
+    }
+    [[nodiscard]] auto state(NodeId id) const -> const PackedTable& {
+        return m_seen_states.state(id);
     }
+    [[nodiscard]] auto edges(NodeId id) const -> std::span<const Edge> {
+        const Node& n = m_nodes[id];
+        return {m_edges.data() + n.m_first_edge, n.m_n_edges};
+    }
+
+    // Bytes reserved by the nodes, edges and state store, projected to
+    // after `n_new_nodes` and `n_new_edges` more are added.
+    [[nodiscard]] auto memory_usage(size_t n_new_nodes = 0,
+                                    size_t n_new_edges = 0) const -> size_t;
 
-    [[nodiscard]] auto end() const -> Iterator {
-        return const_cast<Graph*>(this)->end();
+    [[nodiscard]] auto frontier_begin() const -> NodeId {
+        return m_frontier_begin;
     }
+    // A flag, such as one raised by a signal handler, that stops a BFS at
+    // the next node or chunk.
+    auto set_interrupt_flag(const std::atomic<bool>* flag) -> void {
+        m_interrupt = flag;
+    }
+
+    // Expands the frontier breadth first until it is empty or the next
+    // node is at `depth`. Calling it again continues from where it
+    // stopped, including after nodes were added by `generate_dfs` or
+    // `add_path`. With `n_threads > 1`, each depth level is expanded in
+    // parallel and the new nodes are committed in frontier order, so the
+    // graph is identical to the one built serially. With `max_memory`,
+    // expansion stops before expanding one more node could take
+    // `memory_usage` past it. With `max_expansions`, expansion stops once
+    // that many nodes of the graph have been expanded.
+    auto generate_bfs(size_t depth = SIZE_MAX,
+                      std::optional<float> timeout = std::nullopt,
+                      size_t n_threads = 1,
+                      std::optional<size_t> max_memory = std::nullopt,
+                      std::optional<size_t> max_expansions = std::nullopt)
+        -> BfsReport;
+    auto generate_dfs() -> void;
+    // Adds the nodes and edges along `moves` played from the root, such as
+    // a solver's winning line.
+    auto add_path(std::span<const Move> moves) -> void;
 };
@@ -0,0 +1,163 @@
+#pragma once
+
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>  // NOLINT(build/c++17)
+#include <span>
+#include <string_view>
+#include <vector>
+
+#include "graph.hpp"
+#include "layout.hpp"
+#include "outcome.hpp"
+#include "table.hpp"
+
+// The binary counterpart of graph.json, read by the web app into typed
+// arrays and by `GraphFile` through mmap. Little-endian, with a 32-byte
+// header followed by arrays that each start at a multiple of 8 bytes:
+//
+//   char[8] "ROSEGRPH"      u32 version        u32 node count
+//   u32 edge count          u32 max depth      u32 state size (72)
+//   u32 flags                      `c_graph_file_has_*`
+//   u32 depth[nodes]
+//   u32 edge offset[nodes + 1]     node i's edges are [offset[i], offset[i+1])
+//   u32 edge target[edges]
+//   u16 edge move[edges]           `Move::bits`
+//   u8  flags[nodes]               `c_graph_file_winning`, and with
+//                                  outcomes `c_graph_file_winnable` or
+//                                  `c_graph_file_losing`
+//   u8  state[nodes][state size]   `Table::pack`
+//   f32 position[nodes][2]         x and y, only with positions
+//
+// and, only with clusters, the `m_clusters` of a `Coarsening` with L
+// levels above the nodes:
+//
+//   u32 L                          u32 cluster count[L]
+//   u32 cluster[nodes]             the level-1 cluster of each node
+//   u32 cluster[cluster count[k]]  for k < L, the level-(k + 1) cluster of
+//                                  each level-k cluster
+//
+// and, only with outcomes:
+//
+//   u32 win distance[nodes]        `NodeOutcome::m_win_distance`
+//
+// Nodes are numbered by `NodeId`, as in graph.json, so node 0 is the start.
+constexpr std::string_view c_graph_file_magic = "ROSEGRPH";
+constexpr uint32_t c_graph_file_version = 2;
+constexpr size_t c_graph_file_header_size = 32;
+constexpr uint8_t c_graph_file_winning = 1;
+constexpr uint8_t c_graph_file_winnable = 2;
+constexpr uint8_t c_graph_file_losing = 4;
+constexpr uint32_t c_graph_file_has_positions = 1;
+constexpr uint32_t c_graph_file_has_clusters = 2;
+constexpr uint32_t c_graph_file_has_outcomes = 4;
+// Readers reject files with any other flag, whose sections they could not
+// account for.
+constexpr uint32_t c_graph_file_known_flags = c_graph_file_has_positions |
+                                              c_graph_file_has_clusters |
+                                              c_graph_file_has_outcomes;
+static_assert(std::endian::native == std::endian::little);
+
+// Byte offsets of the arrays of a file with the given counts.
+struct GraphFileLayout {
+    size_t m_depths;
+    size_t m_edge_offsets;
+    size_t m_edge_targets;
+    size_t m_edge_moves;
+    size_t m_flags;
+    size_t m_states;
+    size_t m_positions;
+    size_t m_clusters;
+    size_t m_win_distances;
+    size_t m_size;
+
+    // `cluster_counts` holds the cluster count of each level, and is empty
+    // for a file without clusters.
+    [[nodiscard]] static auto of(size_t n_nodes, size_t n_edges,
+                                 bool positions = false,
+                                 std::span<const uint32_t> cluster_counts = {},
+                                 bool outcomes = false) -> GraphFileLayout;
+};
+
+// A graph file mapped read-only into memory. Nothing is copied: opening
+// only checks the header and the edge arrays. Throws `std::runtime_error`
+// if the file cannot be mapped or is not a graph file of this version.
+class GraphFile {
+   public:
+    explicit GraphFile(const std::filesystem::path& path);
+    ~GraphFile();
+    GraphFile(const GraphFile&) = delete;
+    auto operator=(const GraphFile&) -> GraphFile& = delete;
+
+    [[nodiscard]] auto size() const -> size_t { return m_depths.size(); }
+    [[nodiscard]] auto n_edges() const -> size_t {
+        return m_edge_targets.size();
+    }
+    [[nodiscard]] auto max_depth() const -> size_t { return m_max_depth; }
+    [[nodiscard]] auto depth(NodeId id) const -> uint32_t {
+        return m_depths[id];
+    }
+    [[nodiscard]] auto is_winning(NodeId id) const -> bool {
+        return (m_flags[id] & c_graph_file_winning) != 0;
+    }
+    [[nodiscard]] auto table(NodeId id) const -> Table;
+    [[nodiscard]] auto has_positions() const -> bool {
+        return !m_positions.empty();
+    }
+    [[nodiscard]] auto position(NodeId id) const -> Point {
+        return {m_positions[2 * id], m_positions[(2 * id) + 1]};
+    }
+    // Levels of clusters above the nodes, 0 without clusters.
+    [[nodiscard]] auto n_cluster_levels() const -> size_t {
+        return m_cluster_counts.size();
+    }
+    [[nodiscard]] auto n_clusters(size_t level) const -> size_t {
+        return m_cluster_counts[level - 1];
+    }
+    // The cluster in level `level + 1` of each node, for level 0, or of
+    // each cluster of `level`.
+    [[nodiscard]] auto clusters(size_t level) const
+        -> std::span<const uint32_t> {
+        return m_clusters[level];
+    }
+    [[nodiscard]] auto has_outcomes() const -> bool {
+        return !m_win_distances.empty();
+    }
+    // `Outcome::Unknown` for every node of a file without outcomes.
+    [[nodiscard]] auto outcome(NodeId id) const -> Outcome {
+        if ((m_flags[id] & c_graph_file_winnable) != 0) {
+            return Outcome::Winnable;
+        }
+        if ((m_flags[id] & c_graph_file_losing) != 0) {
+            return Outcome::Losing;
+        }
+        return Outcome::Unknown;
+    }
+    [[nodiscard]] auto win_distance(NodeId id) const -> uint32_t {
+        return m_win_distances[id];
+    }
+    [[nodiscard]] auto edge_targets(NodeId id) const
+        -> std::span<const NodeId> {
+        return m_edge_targets.subspan(
+            m_edge_offsets[id], m_edge_offsets[id + 1] - m_edge_offsets[id]);
+    }
+    [[nodiscard]] auto edge_move(NodeId id, size_t i) const -> Move {
+        return Move::from_bits(m_edge_moves[m_edge_offsets[id] + i]);
+    }
+
+   private:
+    const uint8_t* m_data{nullptr};
+    size_t m_size{0};
+    size_t m_max_depth{0};
+    std::span<const uint32_t> m_depths;
+    std::span<const uint32_t> m_edge_offsets;
+    std::span<const NodeId> m_edge_targets;
+    std::span<const uint16_t> m_edge_moves;
+    std::span<const uint8_t> m_flags;
+    std::span<const uint8_t> m_states;
+    std::span<const float> m_positions;
+    std::span<const uint32_t> m_cluster_counts;
+    std::vector<std::span<const uint32_t>> m_clusters;
+    std::span<const uint32_t> m_win_distances;
+};
@@ -0,0 +1,94 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <list>
+#include <map>
+#include <mutex>
+#include <optional>
+#include <stop_token>
+#include <string>
+#include <string_view>
+#include <thread>
+
+struct HttpRequest {
+    std::string m_path;
+    // The parameters of the query string, which are not percent-decoded.
+    std::map<std::string, std::string, std::less<>> m_params;
+
+    [[nodiscard]] auto param(std::string_view name) const
+        -> std::optional<std::string_view>;
+};
+
+// Parses the head of a request, up to the blank line. Returns nothing for
+// anything but a well-formed GET.
+[[nodiscard]] auto parse_http_request(std::string_view head)
+    -> std::optional<HttpRequest>;
+
+struct HttpResponse {
+    int m_status{200};
+    std::string m_content_type{"application/json"};
+    std::string m_body;
+};
+
+// The open connection to a client that a handler answers on.
+class HttpConnection {
+   public:
+    HttpConnection(int fd, std::stop_token stop)
+        : m_fd(fd), m_stop(std::move(stop)) {}
+
+    // Writes `response` with its length, so the connection stays open for
+    // the client's next request. Returns false if the client is gone.
+    auto respond(const HttpResponse& response) -> bool;
+    // Writes raw bytes, for responses that stream.
+    auto send(std::string_view data) -> bool;
+    // Raised when the server is closing.
+    [[nodiscard]] auto stop_token() const -> const std::stop_token& {
+        return m_stop;
+    }
+
+   private:
+    int m_fd;
+    std::stop_token m_stop;
+};
+
+// Answers a request, returning whether the connection can take another.
+using HttpHandler =
+    std::function<bool(const HttpRequest&, HttpConnection& connection)>;
+
+// A minimal HTTP/1.1 server on the loopback interface. Each connection is
+// served by its own thread and kept open between requests, so a client
+// pays for the connection once however many requests it sends. Pages
+// served from elsewhere, such as the web app on its own port, may read
+// every response.
+class HttpServer {
+   public:
+    // Listens on 127.0.0.1:`port`, or on a free port if `port` is 0.
+    // Throws `std::runtime_error` if the port cannot be bound.
+    HttpServer(uint16_t port, HttpHandler handler);
+    // Closes every connection, waiting for the handlers to return.
+    ~HttpServer();
+    HttpServer(const HttpServer&) = delete;
+    auto operator=(const HttpServer&) -> HttpServer& = delete;
+
+    [[nodiscard]] auto port() const -> uint16_t { return m_port; }
+
+   private:
+    struct Client {
+        int m_fd;
+        std::jthread m_thread;
+        bool m_done{false};
+    };
+
+    HttpHandler m_handler;
+    int m_listen_fd{-1};
+    uint16_t m_port{0};
+    std::mutex m_mutex;
+    // Guarded by `m_mutex`.
+    std::list<Client> m_clients;
+    std::jthread m_accept_thread;
+
+    auto accept_clients(const std::stop_token& stop) -> void;
+    auto serve_client(const std::stop_token& stop, Client& client) -> void;
+};
@@ -0,0 +1,36 @@
+#pragma once
+
+#include <cstddef>
+#include <vector>
+
+#include "graph.hpp"
+
+struct Point {
+    float m_x;
+    float m_y;
+};
+static_assert(sizeof(Point) == 8);
+
+// Settings of ForceAtlas2, which match those the web app runs it with.
+struct LayoutOptions {
+    // Iterations run on each level of the hierarchy.
+    size_t m_iterations{50};
+    size_t m_n_threads{1};
+    float m_gravity{20.0F};
+    float m_scaling{1.0F};
+    // Barnes-Hut opening angle: a cell of the quadtree whose side is less
+    // than `m_theta` times its distance from a node repels it as one body.
+    float m_theta{1.2F};
+};
+
+// Lays out the graph, ignoring edge directions, with ForceAtlas2 and
+// Barnes-Hut repulsion, and returns the position of every node by
+// `NodeId`. The graph is first coarsened level by level, each level
+// merging clusters of neighbouring nodes, down to a few hundred nodes.
+// The coarsest level is laid out from a circle, then each finer level
+// starts from the positions of its clusters, so the layout of the whole
+// graph only needs to settle locally. Forces are computed on
+// `m_n_threads` threads. The result depends on the thread count only
+// through the rounding of sums.
+auto compute_layout(const Graph& graph, const LayoutOptions& options = {})
+    -> std::vector<Point>;
@@ -0,0 +1,88 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+
+#include "common.hpp"
+#include "table.hpp"
+
+// Card sets are 64-bit masks with bit `i` standing for card index `i`. Bit
+// `c_empty_bit` stands for an empty pile, so a king's tableau parents and
+// an ace's foundation predecessor include it.
+inline constexpr size_t c_empty_bit = c_num_cards;
+
+constexpr auto card_bit(uint8_t card_index) -> uint64_t {
+    return uint64_t{1} << static_cast<size_t>(card_index);
+}
+
+// Mask for the top of a pile, where `c_null_index` means the pile is empty.
+constexpr auto pile_top_bit(uint8_t top_index) -> uint64_t {
+    return top_index == c_null_index ? uint64_t{1} << c_empty_bit
+                                     : card_bit(top_index);
+}
+
+// Row `i` holds the cards that card `i` can be placed on in the tableau:
+// one rank higher and of the opposite colour, or an empty column for kings.
+constexpr auto make_tableau_parents() -> std::array<uint64_t, c_num_cards> {
+    std::array<uint64_t, c_num_cards> parents{};
+    for (size_t card = 0; card < c_num_cards; card++) {
+        size_t rank = card / c_num_suits;
+        auto suit = static_cast<Suit>(card % c_num_suits);
+        if (rank == c_num_cards_in_suit - 1) {
+            parents[card] = uint64_t{1} << c_empty_bit;
+            continue;
+        }
+        for (size_t parent_suit = 0; parent_suit < c_num_suits; parent_suit++) {
+            if (!suit_colours_equal(suit, static_cast<Suit>(parent_suit))) {
+                parents[card] |= uint64_t{1}
+                                 << (((rank + 1) * c_num_suits) + parent_suit);
+            }
+        }
+    }
+    return parents;
+}
+
+// Row `i` holds the foundation top that card `i` can follow: the card one
+// rank lower of the same suit, or an empty foundation for aces.
+constexpr auto make_foundation_predecessors()
+    -> std::array<uint64_t, c_num_cards> {
+    std::array<uint64_t, c_num_cards> predecessors{};
+    for (size_t card = 0; card < c_num_cards; card++) {
+        predecessors[card] = card < c_num_suits
+                                 ? uint64_t{1} << c_empty_bit
+                                 : uint64_t{1} << (card - c_num_suits);
+    }
+    return predecessors;
+}
+
+inline constexpr auto c_tableau_parents = make_tableau_parents();
+inline constexpr auto c_foundation_predecessors =
+    make_foundation_predecessors();
+
+// Top card of each tableau column as a card mask, padded to eight lanes so
+// that all columns can be tested with two 256-bit operations.
+using TableauTops = std::array<uint64_t, 8>;
+
+template <typename TableT>
+[[nodiscard]] auto tableau_tops(const TableT& table) -> TableauTops {
+    TableauTops tops{};
+    for (size_t col = 0; col < c_tableau_columns; col++) {
+        tops[col] = pile_top_bit(table.visible_top(col));
+    }
+    return tops;
+}
+
+// Bitmask of the columns that `card_index` can be placed on.
+[[nodiscard]] auto tableau_targets(const TableauTops& tops, uint8_t card_index)
+    -> uint8_t;
+[[nodiscard]] auto tableau_targets_scalar(const TableauTops& tops,
+                                          uint8_t card_index) -> uint8_t;
+[[nodiscard]] auto tableau_targets_avx2(const TableauTops& tops,
+                                        uint8_t card_index) -> uint8_t;
+
+// Whether the AVX2 kernel can run on this CPU, and which kernel
+// `tableau_targets` dispatches to.
+[[nodiscard]] auto has_avx2() -> bool;
+[[nodiscard]] auto tableau_targets_kernel() -> std::string_view;
@@ -1,9 +1,15 @@
 #pragma once
 
+#include <algorithm>
+#include <array>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <optional>
 #include <string>
-#include <vector>
 
 #include "nlohmann/json.hpp"
+#include "stack_table.hpp"
 #include "table.hpp"
 
 enum class MoveType : uint8_t {
@@ -17,46 +23,171 @@ enum class MoveType : uint8_t {
 
 [[nodiscard]] auto move_type_to_string(MoveType move_type) -> std::string;
 
-struct Move {
-    MoveType m_type;
-    union {
-        struct {
-            size_t m_to_col;
-        } wt;
-        struct {
-            size_t m_from_col;
-        } tf;
-        struct {
-            size_t m_from_col;
-            size_t m_to_col;
-            size_t m_n_cards;
-        } tt;
-        struct {
-            Suit m_from_suit;
-            size_t m_to_col;
-        } ft;
-    } mv;
+// A move packed into 16 bits:
+//   bits 0-2   MoveType
+//   bits 3-5   source column, or source suit for FoundationToTableau
+//   bits 6-8   destination column
+//   bits 9-12  number of cards moved, for TableauToTableau
+// Fields that a move type does not use are zero, so two moves are equal
+// exactly when their encodings are.
+class Move {
+   public:
+    constexpr Move() = default;
+
+    [[nodiscard]] static constexpr auto encode(MoveType type, size_t from,
+                                               size_t to, size_t n_cards)
+        -> Move {
+        assert(from < (1U << c_from_bits) && to < (1U << c_to_bits));
+        assert(n_cards < (1U << c_n_cards_bits));
+        return Move(static_cast<uint16_t>(
+            static_cast<size_t>(type) | (from << c_from_shift) |
+            (to << c_to_shift) | (n_cards << c_n_cards_shift)));
+    }
+    [[nodiscard]] static constexpr auto from_bits(uint16_t bits) -> Move {
+        return Move(bits);
+    }
+
+    [[nodiscard]] constexpr auto bits() const -> uint16_t { return m_bits; }
+    [[nodiscard]] constexpr auto type() const -> MoveType {
+        return static_cast<MoveType>(field(0, c_type_bits));
+    }
+    [[nodiscard]] constexpr auto from_col() const -> size_t {
+        return field(c_from_shift, c_from_bits);
+    }
+    [[nodiscard]] constexpr auto from_suit() const -> Suit {
+        return static_cast<Suit>(field(c_from_shift, c_from_bits));
+    }
+    [[nodiscard]] constexpr auto to_col() const -> size_t {
+        return field(c_to_shift, c_to_bits);
+    }
+    [[nodiscard]] constexpr auto n_cards() const -> size_t {
+        return field(c_n_cards_shift, c_n_cards_bits);
+    }
 
     [[nodiscard]] auto to_string() const -> std::string;
     [[nodiscard]] auto to_json() const -> nlohmann::json;
     [[nodiscard]] auto is_opposite(const Move& other) const -> bool;
-    [[nodiscard]] auto operator==(const Move& other) const -> bool;
-
-    static auto create_stock_to_waste() -> Move;
-    static auto create_waste_to_foundation() -> Move;
-    static auto create_waste_to_tableau(size_t to_col) -> Move;
-    static auto create_tableau_to_foundation(size_t from_col) -> Move;
-    static auto create_tableau_to_tableau(size_t from_col, size_t to_col,
-                                          size_t n_cards) -> Move;
-    static auto create_foundation_to_tableau(Suit from_suit, size_t to_col)
-        -> Move;
+    [[nodiscard]] constexpr auto operator==(const Move& other) const
+        -> bool = default;
+
+    static constexpr auto create_stock_to_waste() -> Move {
+        return encode(MoveType::StockToWaste, 0, 0, 0);
+    }
+    static constexpr auto create_waste_to_foundation() -> Move {
+        return encode(MoveType::WasteToFoundation, 0, 0, 0);
+    }
+    static constexpr auto create_waste_to_tableau(size_t to_col) -> Move {
+        return encode(MoveType::WasteToTableau, 0, to_col, 0);
+    }
+    static constexpr auto create_tableau_to_foundation(size_t from_col)
+        -> Move {
+        return encode(MoveType::TableauToFoundation, from_col, 0, 0);
+    }
+    static constexpr auto create_tableau_to_tableau(size_t from_col,
+                                                    size_t to_col,
+                                                    size_t n_cards) -> Move {
+        return encode(MoveType::TableauToTableau, from_col, to_col, n_cards);
+    }
+    static constexpr auto create_foundation_to_tableau(Suit from_suit,
+                                                       size_t to_col)
+        -> Move {
+        return encode(MoveType::FoundationToTableau,
+                      static_cast<size_t>(from_suit), to_col, 0);
+    }
+
+   private:
+    static constexpr size_t c_type_bits = 3;
+    static constexpr size_t c_from_shift = c_type_bits;
+    static constexpr size_t c_from_bits = 3;
+    static constexpr size_t c_to_shift = c_from_shift + c_from_bits;
+    static constexpr size_t c_to_bits = 3;
+    static constexpr size_t c_n_cards_shift = c_to_shift + c_to_bits;
+    static constexpr size_t c_n_cards_bits = 4;
+
+    uint16_t m_bits{0};
+
+    explicit constexpr Move(uint16_t bits) : m_bits(bits) {}
+
+    [[nodiscard]] constexpr auto field(size_t shift, size_t n_bits) const
+        -> size_t {
+        return (static_cast<size_t>(m_bits) >> shift) & ((1U << n_bits) - 1);
+    }
 };
 
-auto generate_moves(const Table& table,
-                    std::optional<Move> prev_move = std::nullopt)
-    -> std::vector<Move>;
+static_assert(sizeof(Move) == sizeof(uint16_t));
+static_assert(Move::create_tableau_to_tableau(6, 5, 13).n_cards() == 13);
+static_assert(Move::create_foundation_to_tableau(Suit::clubs, 6).from_suit() ==
+              Suit::clubs);
+
+// Upper bound on the number of legal moves in any table: one stock to
+// waste and one waste to foundation move, at most seven waste to tableau
+// and seven tableau to foundation moves, and at most 26 tableau to tableau
+// moves (two candidate cards per non-empty destination column, and at
+// most twelve placements of kings on empty columns).
+inline constexpr size_t c_max_moves = 64;
+
+// Fixed-capacity list of moves stored inline, so move generation never
+// allocates.
+class MoveList {
+   public:
+    auto push_back(const Move& move) -> void {
+        assert(m_size < c_max_moves);
+        m_moves[m_size++] = move;
+    }
+    auto clear() -> void { m_size = 0; }
+    // Removes every move matching `pred`, preserving the order of the rest.
+    template <typename Pred>
+    auto erase_if(Pred pred) -> void {
+        m_size = static_cast<uint8_t>(std::remove_if(begin(), end(), pred) -
+                                      begin());
+    }
 
-auto apply_move(Table& table, const Move& move) -> Table&;
+    [[nodiscard]] auto size() const -> size_t { return m_size; }
+    [[nodiscard]] auto empty() const -> bool { return m_size == 0; }
+    [[nodiscard]] auto operator[](size_t i) const -> const Move& {
+        assert(i < m_size);
+        return m_moves[i];
+    }
+    [[nodiscard]] auto back() const -> const Move& {
+        assert(m_size > 0);
+        return m_moves[m_size - 1];
+    }
+    [[nodiscard]] auto begin() -> Move* { return m_moves.data(); }
+    [[nodiscard]] auto end() -> Move* { return m_moves.data() + m_size; }
+    [[nodiscard]] auto begin() const -> const Move* { return m_moves.data(); }
+    [[nodiscard]] auto end() const -> const Move* {
+        return m_moves.data() + m_size;
+    }
+
+   private:
+    std::array<Move, c_max_moves> m_moves;
+    uint8_t m_size{0};
+};
+
+// What `apply_move` changed beyond the move itself, so that `undo_move`
+// can restore the table exactly and a search can run on a single mutable
+// table instead of copying it for every child.
+struct UndoRecord {
+    Move m_move;
+    // Foundation a waste or tableau card was played to.
+    Suit m_suit{Suit::spades};
+    // The move turned cards over: the waste back onto an empty stock, or
+    // the top hidden card of the column a tableau card left.
+    bool m_turned_over{false};
+};
+static_assert(sizeof(UndoRecord) == 4);
+
+// Move generation and application are templates over the table layout,
+// instantiated for `Table` and `StackTable` in moves.cpp.
+template <typename TableT>
+auto generate_moves(const TableT& table,
+                    std::optional<Move> prev_move = std::nullopt) -> MoveList;
+
+template <typename TableT>
+auto apply_move(TableT& table, const Move& move) -> UndoRecord;
+
+auto undo_move(Table& table, const UndoRecord& undo) -> Table&;
+auto undo_move(StackTable& table, const UndoRecord& undo) -> StackTable&;
 
 auto stock_to_waste(Table& table) -> Table&;
 auto waste_to_foundation(Table& table) -> Table&;
@@ -67,4 +198,14 @@ auto tableau_to_tableau(Table& table, size_t from_col, size_t to_col,
 auto foundation_to_tableau(Table& table, Suit from_suit, size_t to_col)
     -> Table&;
 
+auto stock_to_waste(StackTable& table) -> StackTable&;
+auto waste_to_foundation(StackTable& table) -> StackTable&;
+auto waste_to_tableau(StackTable& table, size_t to_col) -> StackTable&;
+auto tableau_to_foundation(StackTable& table, size_t from_col)
+    -> StackTable&;
+auto tableau_to_tableau(StackTable& table, size_t from_col, size_t to_col,
+                        size_t n_cards) -> StackTable&;
+auto foundation_to_tableau(StackTable& table, Suit from_suit, size_t to_col)
+    -> StackTable&;
+
 auto compare_moves(const Move& a, const Move& b) -> bool;
@@ -0,0 +1,44 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+#include <vector>
+
+#include "graph.hpp"
+
+enum class Outcome : uint8_t {
+    // A win may or may not be reachable: every line from the node that
+    // does not reach a win leads to a node the BFS did not expand.
+    Unknown,
+    // A won node can be reached from the node.
+    Winnable,
+    // No won node can be reached from the node, as every node that can be
+    // reached was expanded.
+    Losing,
+};
+
+[[nodiscard]] auto outcome_to_string(Outcome outcome) -> std::string_view;
+
+constexpr uint32_t c_no_win_distance = UINT32_MAX;
+
+struct NodeOutcome {
+    // The fewest moves from the node to a won node, or
+    // `c_no_win_distance` unless the node is winnable.
+    uint32_t m_win_distance{c_no_win_distance};
+    Outcome m_outcome{Outcome::Unknown};
+
+    auto operator==(const NodeOutcome& other) const -> bool = default;
+};
+static_assert(sizeof(NodeOutcome) == 8);
+
+// Labels every node by working back from its ends, over the edges into
+// each node. A breadth-first search from the won nodes finds the winnable
+// nodes and their distance to a win; one from the nodes the BFS did not
+// expand, through nodes that are not winnable, finds the unknown ones.
+// Every other node only reaches expanded nodes that are not won, such as
+// dead ends and cycles of moves, and is losing. Each level of the
+// searches is spread over `n_threads` threads, and the labels do not
+// depend on the thread count.
+[[nodiscard]] auto label_outcomes(const Graph& graph, size_t n_threads = 1)
+    -> std::vector<NodeOutcome>;
@@ -0,0 +1,20 @@
+#pragma once
+
+#include <cstddef>
+#include <thread>
+#include <vector>
+
+// Calls `body(begin, end, chunk)` on `n_chunks` contiguous ranges that
+// split [0, n), each on its own thread.
+template <typename Body>
+auto parallel_chunks(size_t n, size_t n_chunks, Body&& body) -> void {
+    auto range = [&](size_t chunk) {
+        body(chunk * n / n_chunks, (chunk + 1) * n / n_chunks, chunk);
+    };
+    std::vector<std::jthread> workers;
+    workers.reserve(n_chunks - 1);
+    for (size_t chunk = 1; chunk < n_chunks; chunk++) {
+        workers.emplace_back(range, chunk);
+    }
+    range(0);
+}
@@ -0,0 +1,62 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "graph_file.hpp"
+#include "http_server.hpp"
+#include "nlohmann/json.hpp"
+
+// Answers questions about the neighbourhood of single nodes of a mapped
+// graph file, so that a viewer only fetches the part of the graph it
+// shows. Opening builds the edges into each node and a shortest path
+// tree from the start, in time linear in the size of the graph; every
+// query after that only touches the nodes it returns. Queries are const
+// and may run on several threads at once.
+class GraphQueries {
+   public:
+    explicit GraphQueries(const GraphFile& file);
+
+    [[nodiscard]] auto file() const -> const GraphFile& { return m_file; }
+
+    // {"id", "depth", "winning", "table"}: the node and its table as text.
+    // Nodes here and in `neighbourhood` also have the "outcome" and, if
+    // winnable, "win_distance" of graph.json when the file has outcomes.
+    [[nodiscard]] auto node(NodeId id) const -> nlohmann::json;
+    // {"max_depth", "nodes", "edges", "truncated"}: the nodes within `hops`
+    // edges of `id`, whichever way the edges point, nearest first and at
+    // most `max_nodes` of them, and every edge between them. Nodes are
+    // {"id", "depth", "winning"} and edges {"source", "target", "label"},
+    // labelled with their move type as in graph.json.
+    [[nodiscard]] auto neighbourhood(NodeId id, size_t hops,
+                                     size_t max_nodes) const
+        -> nlohmann::json;
+    // {"nodes", "moves"}: a shortest path from the start to `id`, or null
+    // if `id` cannot be reached from the start.
+    [[nodiscard]] auto path_to(NodeId id) const -> nlohmann::json;
+    // {"children"}: the nodes `id` has edges to, as {"id", "move",
+    // "value"}, best first by the `move_value` of their move.
+    [[nodiscard]] auto children(NodeId id) const -> nlohmann::json;
+
+   private:
+    const GraphFile& m_file;
+    // The edges into each node in CSR form, by source.
+    std::vector<uint32_t> m_in_offsets;
+    std::vector<NodeId> m_in_sources;
+    // The node before each node on a shortest path from the start, and the
+    // index of the edge it takes among that node's edges.
+    std::vector<NodeId> m_parents;
+    std::vector<uint8_t> m_parent_edges;
+};
+
+// Routes a request to the query its path names, reading the node from the
+// "id" parameter:
+//   /node?id=X
+//   /neighbourhood?id=X[&hops=K][&limit=N]
+//   /path?id=X
+//   /children?id=X
+// A bad or missing parameter is a 400 and an unknown node or path a 404,
+// with the reason as {"error"}.
+auto answer_query(const GraphQueries& queries, const HttpRequest& request)
+    -> HttpResponse;
@@ -1,8 +1,12 @@
 #pragma once
 
 #include "moves.hpp"
+#include "stack_table.hpp"
 #include "table.hpp"
 
-auto move_value(const Move& move, const Table& table) -> size_t;
+// Instantiated for `Table` and `StackTable` in ranking.cpp.
+template <typename TableT>
+auto move_value(const Move& move, const TableT& table) -> size_t;
 
-auto compare_moves(const Move& a, const Move& b, const Table& table) -> bool;
+template <typename TableT>
+auto compare_moves(const Move& a, const Move& b, const TableT& table) -> bool;
@@ -1,13 +1,78 @@
 #pragma once
 
+#include <cstdint>
+#include <span>
 #include <string>
+#include <vector>
 
 #include "graph.hpp"
+#include "layout.hpp"
+#include "outcome.hpp"
 
-auto graph_to_json(const Graph& graph, size_t max_depth) -> nlohmann::json;
+// Whitespace of streamed JSON: `Pretty` matches `nlohmann::json::dump(2)`
+// and `Compact` matches `dump()`.
+enum class JsonStyle : uint8_t { Pretty, Compact };
 
-auto graph_to_string(const Graph& graph, size_t max_depth) -> std::string;
+// How node tables are exported: `Rendered` as the text of
+// `Table::to_string` under "table", or `Packed` as the base64 of
+// `Table::pack` under "state", which the web app renders on click.
+enum class TableEncoding : uint8_t { Rendered, Packed };
 
+struct JsonOptions {
+    JsonStyle m_style{JsonStyle::Pretty};
+    TableEncoding m_tables{TableEncoding::Rendered};
+    // Node positions by `NodeId`, from `compute_layout`, exported as "x"
+    // and "y" rounded to two decimals. Empty for no positions.
+    std::span<const Point> m_positions{};
+    // The `m_clusters` of a `Coarsening`, exported as "clusters", an array
+    // of the cluster of each node, then of each cluster of each level in
+    // the next. Empty for no clusters.
+    std::span<const std::vector<uint32_t>> m_clusters{};
+    // Node outcomes by `NodeId`, from `label_outcomes`, exported as
+    // "outcome" and, for winnable nodes, "win_distance", and shown in the
+    // node colours. Empty for no outcomes.
+    std::span<const NodeOutcome> m_outcomes{};
+};
+
+// Nodes keep their `NodeId` as their "id", so export is one pass over the
+// node and edge arrays in id order. The style of `options` is left to
+// `dump`.
+auto graph_to_json(const Graph& graph, size_t max_depth,
+                   JsonOptions options = {}) -> nlohmann::json;
+
+// The same document as `graph_to_json`, written straight to a string
+// without building the JSON tree.
+auto graph_to_string(const Graph& graph, size_t max_depth,
+                     JsonOptions options = {}) -> std::string;
+
+// The part of a growing graph sent in one go: the nodes from
+// `m_first_node` on, and the edges from the nodes in
+// [`m_first_source`, `m_end_source`). A BFS only adds edges to the node it
+// expands, so the edges of the nodes before the frontier are final.
+struct GraphBatch {
+    NodeId m_first_node;
+    NodeId m_first_source;
+    NodeId m_end_source;
+};
+
+// The "edges" and "nodes" of `graph_to_json` restricted to `batch`, so
+// that the batches of a BFS together make up the whole document.
+auto graph_batch_to_string(const Graph& graph, const GraphBatch& batch,
+                           size_t max_depth, JsonOptions options = {})
+    -> std::string;
+
+// Streams the document of `graph_to_json` to `outpath` through a fixed
+// buffer, so memory use does not grow with the size of the output. Throws
+// `std::runtime_error` if the file cannot be written.
 auto write_graph_to_file(const Graph& graph,
-                         const std::filesystem::path& outpath, size_t max_depth)
-    -> void;
+                         const std::filesystem::path& outpath, size_t max_depth,
+                         JsonOptions options = {}) -> void;
+
+// Writes the graph in the binary format of graph_file.hpp, with node
+// positions, clusters and outcomes if `positions`, `clusters` and
+// `outcomes` are not empty.
+auto write_graph_to_binary_file(
+    const Graph& graph, const std::filesystem::path& outpath, size_t max_depth,
+    std::span<const Point> positions = {},
+    std::span<const std::vector<uint32_t>> clusters = {},
+    std::span<const NodeOutcome> outcomes = {}) -> void;
@@ -0,0 +1,57 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <string_view>
+#include <vector>
+
+#include "moves.hpp"
+#include "table.hpp"
+
+enum class SolveStatus : uint8_t {
+    Won,
+    // Every state reachable by the moves the solver considers was searched
+    // without finding a win.
+    Lost,
+    // The expansion budget or the timeout ran out first.
+    OutOfBudget,
+};
+
+[[nodiscard]] auto solve_status_to_string(SolveStatus status)
+    -> std::string_view;
+
+struct SolveResult {
+    SolveStatus m_status{SolveStatus::OutOfBudget};
+    // Moves from the initial table to the win, when one was found.
+    std::vector<Move> m_moves;
+    size_t m_expanded{0};
+    size_t m_generated{0};
+};
+
+// Admissible lower bound on the number of moves left to win: every card
+// not yet on a foundation has to be moved there at least once.
+[[nodiscard]] auto moves_to_win_lower_bound(const Table& table) -> size_t;
+
+// Weighted A* over distinct tables. States are ordered by moves so far plus
+// a weighted estimate of the moves left, `moves_to_win_lower_bound` plus
+// the hidden cards still to turn over, then by fewest hidden cards, then by
+// the `move_value` of the move that reached them. The weight trades the
+// optimality of the winning line for far fewer expansions. Safe foundation
+// moves are forced, runs of stock draws are collapsed into the waste move
+// they lead to, and tableau moves that only shuffle cards are pruned.
+[[nodiscard]] auto solve_best_first(const Table& table,
+                                    size_t max_expansions = SIZE_MAX,
+                                    std::optional<float> timeout = std::nullopt)
+    -> SolveResult;
+
+// Exhaustive iterative depth-first search that applies and undoes moves on
+// a single table. Every move from `generate_moves` is tried, best first by
+// `compare_moves`, backtracking from dead ends, and revisits are pruned
+// through a `TranspositionTable` of `tt_bytes` bytes. Memory stays within
+// the table plus one frame per move on the current line, so it can prove
+// a deal lost where the best-first search would run out of memory, but the
+// winning line it finds is far from the shortest.
+[[nodiscard]] auto solve_depth_first(
+    const Table& table, size_t tt_bytes, size_t max_expansions = SIZE_MAX,
+    std::optional<float> timeout = std::nullopt) -> SolveResult;
@@ -0,0 +1,124 @@
+#pragma once
+
+#include <array>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <ranges>
+#include <span>
+
+#include "common.hpp"
+#include "table.hpp"
+
+// Game state with every pile stored as a fixed-size array and its card
+// counts cached, as an alternative to the linked layout of `Table`. Counts,
+// pile tops and the n-th card of a visible run are all O(1), at the cost of
+// a larger state that does not pack into `c_table_state_size` bytes.
+//
+// Move generation, move application and ranking are templates over the
+// table layout (see moves.hpp and ranking.hpp), so a search can choose
+// either layout at compile time.
+class StackTable {
+   public:
+    // Six hidden cards under a full King-to-Ace run.
+    static constexpr size_t c_max_column_cards =
+        c_tableau_columns - 1 + c_num_cards_in_suit;
+    // Cards left after dealing the tableau.
+    static constexpr size_t c_max_talon_cards =
+        c_num_cards - (c_tableau_columns * (c_tableau_columns + 1) / 2);
+
+    StackTable() = default;
+    explicit StackTable(const Table& table);
+    [[nodiscard]] auto to_table() const -> Table;
+
+    [[nodiscard]] auto n_cards_in_stock() const -> size_t {
+        return m_n_talon - m_n_waste;
+    }
+    [[nodiscard]] auto n_cards_in_waste() const -> size_t { return m_n_waste; }
+    [[nodiscard]] auto n_cards_in_visible_tableau_column(size_t col_idx) const
+        -> size_t {
+        return m_n_cards[col_idx] - m_n_hidden[col_idx];
+    }
+    [[nodiscard]] auto n_cards_in_hidden_tableau_column(size_t col_idx) const
+        -> size_t {
+        return m_n_hidden[col_idx];
+    }
+    [[nodiscard]] auto n_cards_in_tableau_column(size_t col_idx) const
+        -> size_t {
+        return m_n_cards[col_idx];
+    }
+    [[nodiscard]] auto n_cards_in_foundation(size_t suit) const -> size_t {
+        return m_foundation_counts[suit];
+    }
+
+    [[nodiscard]] auto stock_top() const -> uint8_t {
+        return m_n_waste < m_n_talon ? m_talon[m_n_waste] : c_null_index;
+    }
+    [[nodiscard]] auto waste_top() const -> uint8_t {
+        return m_n_waste > 0 ? m_talon[m_n_waste - 1] : c_null_index;
+    }
+    [[nodiscard]] auto foundation_top(size_t suit) const -> uint8_t {
+        size_t count = m_foundation_counts[suit];
+        return count > 0 ? static_cast<uint8_t>(card_to_index(
+                               static_cast<Suit>(suit), count - 1))
+                         : c_null_index;
+    }
+    [[nodiscard]] auto visible_top(size_t col_idx) const -> uint8_t {
+        return n_cards_in_visible_tableau_column(col_idx) > 0
+                   ? m_columns[col_idx][m_n_cards[col_idx] - 1]
+                   : c_null_index;
+    }
+    [[nodiscard]] auto hidden_top(size_t col_idx) const -> uint8_t {
+        return m_n_hidden[col_idx] > 0
+                   ? m_columns[col_idx][m_n_hidden[col_idx] - 1]
+                   : c_null_index;
+    }
+    // Visible cards of a column from the top down.
+    [[nodiscard]] auto visible_run(size_t col_idx) const {
+        return std::span(m_columns[col_idx])
+                   .subspan(m_n_hidden[col_idx],
+                            n_cards_in_visible_tableau_column(col_idx)) |
+               std::views::reverse;
+    }
+
+    [[nodiscard]] auto can_be_placed_on_foundation(uint8_t card_index) const
+        -> bool;
+    [[nodiscard]] auto can_be_placed_on_tableau(size_t to_col,
+                                                uint8_t card_index) const
+        -> bool;
+    [[nodiscard]] auto is_complete() const -> bool;
+
+    auto draw_from_stock() -> void;
+    auto reset_stock_from_waste() -> void;
+    auto pop_waste() -> uint8_t;
+    auto push_foundation(uint8_t card_index) -> void;
+    auto pop_foundation(Suit suit) -> uint8_t;
+    auto push_visible(size_t col_idx, uint8_t card_index) -> void;
+    auto pop_visible(size_t col_idx) -> uint8_t;
+    // Moves the top `n_cards` visible cards of `from_col` onto `to_col`.
+    auto move_run(size_t from_col, size_t to_col, size_t n_cards) -> void;
+    // Turns the top hidden card of a column with no visible cards face up.
+    auto reveal_hidden(size_t col_idx) -> void;
+    // Inverses of the primitives above, for undoing moves in place.
+    auto return_to_stock() -> void;
+    auto restore_waste_from_stock() -> void;
+    auto push_waste(uint8_t card_index) -> void;
+    auto hide_visible(size_t col_idx) -> void;
+
+    // Compares the cards in play only; slots above each pile's count may
+    // hold stale cards.
+    [[nodiscard]] auto operator==(const StackTable& other) const -> bool;
+
+   private:
+    std::array<std::array<uint8_t, c_max_column_cards>, c_tableau_columns>
+        m_columns{};
+    // Hidden cards sit at the bottom of each column, below the visible run.
+    std::array<uint8_t, c_tableau_columns> m_n_hidden{};
+    std::array<uint8_t, c_tableau_columns> m_n_cards{};
+    // Waste from bottom to top, followed by the stock in drawing order, so
+    // drawing a card and turning the waste back over are both O(1).
+    std::array<uint8_t, c_max_talon_cards> m_talon{};
+    uint8_t m_n_waste{0};
+    uint8_t m_n_talon{0};
+    std::array<uint8_t, c_num_suits> m_foundation_counts{};
+};
@@ -0,0 +1,108 @@
+#pragma once
+
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <utility>
+#include <vector>
+
+#include "table.hpp"
+
+using StateId = uint32_t;
+inline constexpr StateId c_null_state = UINT32_MAX;
+
+// A table as the store keeps it: packed, with the low 32 bits of its hash
+// as a tag.
+struct StateKey {
+    PackedTable m_state;
+    uint32_t m_tag;
+
+    [[nodiscard]] static auto of(const Table& table) -> StateKey {
+        assert(table.hash() == table.full_hash());
+        return {.m_state = table.pack(),
+                .m_tag = static_cast<uint32_t>(table.hash())};
+    }
+};
+
+// Open-addressing hash set of tables. States are stored packed and
+// contiguously in insertion order, so each distinct table gets a dense
+// `StateId`. The index is a flat array of 8-byte slots probed with Robin
+// Hood linear probing; a slot holds the low 32 bits of the table hash as a
+// tag and the state id. Tags only filter candidates: a matching tag is
+// always confirmed by a full comparison of the states, so hash collisions
+// never merge distinct states. The tags are all the store keeps of the
+// hashes, and growing the index moves them rather than hashing the states
+// again. Const members may be called from several threads while nothing
+// inserts.
+class StateStore {
+   public:
+    explicit StateStore(size_t initial_capacity = c_min_capacity);
+
+    [[nodiscard]] auto find(const StateKey& key) const
+        -> std::optional<StateId>;
+    [[nodiscard]] auto find(const Table& table) const
+        -> std::optional<StateId> {
+        return find(StateKey::of(table));
+    }
+    [[nodiscard]] auto contains(const Table& table) const -> bool {
+        return find(table).has_value();
+    }
+    // Returns the id of the state and whether it was newly inserted.
+    auto insert(const StateKey& key) -> std::pair<StateId, bool>;
+    auto insert(const Table& table) -> std::pair<StateId, bool> {
+        return insert(StateKey::of(table));
+    }
+    auto reserve(size_t n_states) -> void;
+    // Bytes reserved for states and slots once `n_inserts` more states have
+    // been inserted.
+    [[nodiscard]] auto memory_usage(size_t n_inserts = 0) const -> size_t;
+    auto clear() -> void;
+
+    // The table of a state, unpacked, and so with its hash recomputed.
+    [[nodiscard]] auto operator[](StateId id) const -> Table {
+        return Table::unpack(m_states[id]);
+    }
+    [[nodiscard]] auto state(StateId id) const -> const PackedTable& {
+        return m_states[id];
+    }
+    [[nodiscard]] auto size() const -> size_t { return m_states.size(); }
+    [[nodiscard]] auto empty() const -> bool { return m_states.empty(); }
+    [[nodiscard]] auto slot_count() const -> size_t { return m_slots.size(); }
+
+   private:
+    struct Slot {
+        uint32_t m_tag;
+        StateId m_id;
+    };
+
+    static constexpr size_t c_min_capacity = 1024;
+    // Grow once the index is 7/8 full; Robin Hood probing keeps probe
+    // sequences short even at high load.
+    static constexpr size_t c_max_load_num = 7;
+    static constexpr size_t c_max_load_den = 8;
+
+    std::vector<PackedTable> m_states;
+    std::vector<Slot> m_slots;
+    size_t m_mask{0};
+
+    // Where a probe for a key stopped: at the slot of its state if it was
+    // found, and otherwise at the slot where it would be placed.
+    struct Probe {
+        size_t m_pos;
+        size_t m_dist;
+        StateId m_id;
+    };
+
+    [[nodiscard]] auto probe_distance(size_t pos, uint32_t tag) const
+        -> size_t {
+        return (pos - (static_cast<size_t>(tag) & m_mask)) & m_mask;
+    }
+    [[nodiscard]] auto probe(const StateKey& key) const -> Probe;
+    auto place(Slot slot) -> void {
+        place(slot, static_cast<size_t>(slot.m_tag) & m_mask, 0);
+    }
+    // Places `slot`, `dist` slots from its home at `pos`.
+    auto place(Slot slot, size_t pos, size_t dist) -> void;
+    auto rehash(size_t n_slots) -> void;
+};
@@ -1,11 +1,72 @@
 #pragma once
 
 #include <cassert>
+#include <cstddef>
+#include <cstdint>
 #include <string>
 #include <vector>
 
 #include "common.hpp"
+#include "zobrist.hpp"
 
+// The cards of a pile linked through a table's deck, from the top down.
+class LinkedPile {
+   public:
+    class Iterator {
+       public:
+        using value_type = uint8_t;
+        using difference_type = std::ptrdiff_t;
+
+        Iterator() = default;
+        Iterator(const uint8_t* links, uint8_t card)
+            : m_links(links), m_card(card) {}
+        auto operator*() const -> uint8_t { return m_card; }
+        auto operator++() -> Iterator& {
+            m_card = m_links[static_cast<size_t>(m_card)];
+            return *this;
+        }
+        auto operator++(int) -> Iterator {
+            Iterator tmp = *this;
+            ++(*this);
+            return tmp;
+        }
+        auto operator==(const Iterator& other) const -> bool {
+            return m_card == other.m_card;
+        }
+
+       private:
+        const uint8_t* m_links{nullptr};
+        uint8_t m_card{c_null_index};
+    };
+
+    LinkedPile(const uint8_t* links, uint8_t top)
+        : m_links(links), m_top(top) {}
+    [[nodiscard]] auto begin() const -> Iterator { return {m_links, m_top}; }
+    [[nodiscard]] auto end() const -> Iterator {
+        return {m_links, c_null_index};
+    }
+
+   private:
+    const uint8_t* m_links;
+    uint8_t m_top;
+};
+
+// The state of a `Table` as bytes, in field order. Packed tables compare
+// lexicographically, so they can be sorted and merged on disk.
+using PackedTable = std::array<uint8_t, c_table_state_size>;
+
+// Game state with every pile stored as a linked list threaded through
+// `m_deck`: each pile records its top card, and `m_deck[card]` holds the
+// card beneath `card`. The whole state packs into `c_table_state_size`
+// bytes, which is what graph nodes store; a table is the working copy of a
+// state, which also carries its hash.
+//
+// The hash is a Zobrist key kept up to date by the setters below, which
+// every mutator and move goes through, so a move only updates the keys of
+// the links it changes. Code that writes the public fields directly must
+// call `rehash()` before the table is hashed. The move functions check the
+// key against `full_hash()` in debug builds, as does `StateKey::of` before
+// a state is stored under it.
 class [[gnu::packed]] Table {
    public:
     uint8_t m_stock_index{c_null_index};
@@ -22,6 +83,7 @@ class [[gnu::packed]] Table {
         m_tableau_visible_indices.fill(c_null_index);
         m_tableau_hidden_indices.fill(c_null_index);
         m_deck.fill(c_null_index);
+        rehash();
     }
     explicit Table(const std::array<uint8_t, c_num_cards>& deck);
 
@@ -34,6 +96,21 @@ class [[gnu::packed]] Table {
     [[nodiscard]] auto n_cards_in_tableau_column(size_t col_idx) const
         -> size_t;
     [[nodiscard]] auto max_cards_in_tableau_column() const -> size_t;
+
+    [[nodiscard]] auto stock_top() const -> uint8_t { return m_stock_index; }
+    [[nodiscard]] auto waste_top() const -> uint8_t { return m_waste_index; }
+    [[nodiscard]] auto foundation_top(size_t suit) const -> uint8_t {
+        return m_foundation_indices[suit];
+    }
+    [[nodiscard]] auto visible_top(size_t col_idx) const -> uint8_t {
+        return m_tableau_visible_indices[col_idx];
+    }
+    [[nodiscard]] auto hidden_top(size_t col_idx) const -> uint8_t {
+        return m_tableau_hidden_indices[col_idx];
+    }
+    [[nodiscard]] auto visible_run(size_t col_idx) const -> LinkedPile {
+        return {m_deck.data(), m_tableau_visible_indices[col_idx]};
+    }
     [[nodiscard]] auto to_string() const -> std::string;
     [[nodiscard]] auto tableau_to_string() const -> std::string;
     [[nodiscard]] auto header_to_string() const -> std::string;
@@ -45,6 +122,10 @@ class [[gnu::packed]] Table {
     auto move_from_hidden_to_visible(size_t col_idx) -> void;
     auto move_from_stock_to_waste() -> void;
     auto reset_stock_from_waste() -> void;
+    // Inverses of the three moves above, for undoing moves in place.
+    auto move_from_visible_to_hidden(size_t col_idx) -> void;
+    auto move_from_waste_to_stock() -> void;
+    auto restore_waste_from_stock() -> void;
 
     [[nodiscard]] auto can_be_placed_on_foundation(uint8_t card_index) const
         -> bool;
@@ -55,7 +136,38 @@ class [[gnu::packed]] Table {
 
     [[nodiscard]] auto is_complete() const -> bool;
 
-    [[nodiscard]] auto hash() const -> std::size_t;
+    [[nodiscard]] auto hash() const -> std::size_t {
+        return static_cast<std::size_t>(m_hash);
+    }
+    [[nodiscard]] auto full_hash() const -> uint64_t;
+    auto rehash() -> void { m_hash = full_hash(); }
+
+    auto set_stock(uint8_t card_index) -> void {
+        set_link(c_stock_offset, m_stock_index, card_index);
+    }
+    auto set_waste(uint8_t card_index) -> void {
+        set_link(c_waste_offset, m_waste_index, card_index);
+    }
+    auto set_foundation(size_t suit, uint8_t card_index) -> void {
+        set_link(c_foundation_offset + suit, m_foundation_indices[suit],
+                 card_index);
+    }
+    auto set_visible(size_t col_idx, uint8_t card_index) -> void {
+        set_link(c_visible_offset + col_idx,
+                 m_tableau_visible_indices[col_idx], card_index);
+    }
+    auto set_hidden(size_t col_idx, uint8_t card_index) -> void {
+        set_link(c_hidden_offset + col_idx, m_tableau_hidden_indices[col_idx],
+                 card_index);
+    }
+    // Sets the card below `card_index` in whichever pile it belongs to.
+    auto set_next(uint8_t card_index, uint8_t next_index) -> void {
+        set_link(c_deck_offset + static_cast<size_t>(card_index),
+                 m_deck[static_cast<size_t>(card_index)], next_index);
+    }
+
+    [[nodiscard]] auto pack() const -> PackedTable;
+    [[nodiscard]] static auto unpack(const PackedTable& packed) -> Table;
 
     [[nodiscard]] auto operator==(Table const& other) const -> bool {
         return m_stock_index == other.m_stock_index &&
@@ -67,6 +179,29 @@ class [[gnu::packed]] Table {
     }
 
    private:
+    uint64_t m_hash{0};
+
+    // A table whose fields are all about to be written, so not hashed yet.
+    struct Unhashed {};
+    explicit Table(Unhashed) {}
+
+    // Position of each field within the packed state, used to index the
+    // Zobrist keys.
+    static constexpr size_t c_stock_offset = 0;
+    static constexpr size_t c_waste_offset = 1;
+    static constexpr size_t c_foundation_offset = 2;
+    static constexpr size_t c_visible_offset =
+        c_foundation_offset + c_num_suits;
+    static constexpr size_t c_hidden_offset =
+        c_visible_offset + c_tableau_columns;
+    static constexpr size_t c_deck_offset = c_hidden_offset + c_tableau_columns;
+    static_assert(c_deck_offset + c_num_cards == c_table_state_size);
+
+    auto set_link(size_t offset, uint8_t& link, uint8_t value) -> void {
+        m_hash ^= zobrist_key(offset, link) ^ zobrist_key(offset, value);
+        link = value;
+    }
+
     [[nodiscard]] auto tableau_to_2d() const
         -> std::vector<std::vector<uint8_t>>;
 };
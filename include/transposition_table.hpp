@@ -0,0 +1,63 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Fixed-size set of table hashes for a depth-first search, so revisits can
+// be pruned within a memory cap. Entries live in buckets of four, one cache
+// line each, indexed by the hash. States on the current search path are
+// pinned and never replaced; once a state is released, its entry records
+// how many expansions its subtree took, and a full bucket replaces the
+// entry that was cheapest to search.
+//
+// Only hashes are stored, so two distinct tables with equal 64-bit hashes
+// are treated as the same state.
+class TranspositionTable {
+   public:
+    // Throws `std::invalid_argument` if `n_bytes` is less than one bucket.
+    explicit TranspositionTable(size_t n_bytes);
+
+    [[nodiscard]] auto contains(uint64_t hash) const -> bool;
+    // Stores `hash` pinned. Returns false, storing nothing, if every entry
+    // in its bucket is pinned.
+    auto insert_pinned(uint64_t hash) -> bool;
+    // Unpins `hash`, recording `work` expansions spent below it.
+    auto release(uint64_t hash, size_t work) -> void;
+    auto clear() -> void;
+
+    [[nodiscard]] auto size() const -> size_t { return m_size; }
+    [[nodiscard]] auto capacity() const -> size_t {
+        return m_buckets.size() * c_bucket_entries;
+    }
+    [[nodiscard]] auto n_replaced() const -> size_t { return m_n_replaced; }
+
+   private:
+    struct Entry {
+        // Zero marks an empty entry.
+        uint64_t m_key;
+        uint32_t m_work;
+        uint32_t m_pinned;
+    };
+
+    static constexpr size_t c_bucket_entries = 4;
+    struct alignas(64) Bucket {
+        std::array<Entry, c_bucket_entries> m_entries;
+    };
+
+    std::vector<Bucket> m_buckets;
+    size_t m_mask{0};
+    size_t m_size{0};
+    size_t m_n_replaced{0};
+
+    [[nodiscard]] static auto key_of(uint64_t hash) -> uint64_t {
+        return hash == 0 ? 1 : hash;
+    }
+    [[nodiscard]] auto bucket_of(uint64_t key) -> Bucket& {
+        return m_buckets[static_cast<size_t>(key) & m_mask];
+    }
+    [[nodiscard]] auto bucket_of(uint64_t key) const -> const Bucket& {
+        return m_buckets[static_cast<size_t>(key) & m_mask];
+    }
+};
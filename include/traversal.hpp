@@ -0,0 +1,112 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "graph.hpp"
+
+// Breadth- and depth-first traversals that visit each node reachable from
+// a start node once, up to a maximum number of edges away from it. The
+// graph is read in place, and the visited bitmap and work list are reused
+// by every traversal, so once they have grown to the size of the graph, or
+// of its edges for a DFS, a traversal allocates nothing.
+class GraphTraversal {
+   public:
+    explicit GraphTraversal(const Graph& graph) : m_graph(graph) {}
+
+    // Calls `visit(node, distance)` for the nodes within `max_distance`
+    // edges of `start`, nearest first, following each node's edges in
+    // order. Returns the number of nodes visited.
+    template <typename Visit>
+    auto bfs(NodeId start, Visit&& visit, size_t max_distance = SIZE_MAX)
+        -> size_t {
+        reset(start);
+        mark(start);
+        // The work list is the queue; visited entries stay behind `next`.
+        for (size_t next = 0; next < m_work.size(); next++) {
+            auto [node, distance] = m_work[next];
+            visit(node, size_t{distance});
+            if (distance < max_distance) {
+                push_unvisited_children(node, distance + 1);
+            }
+        }
+        return m_work.size();
+    }
+
+    // As `bfs`, but visiting depth first, children in edge order, so nodes
+    // come in the preorder of a recursive DFS. A node's distance is that
+    // of the path that first reached it, which may be longer than the
+    // shortest one.
+    template <typename Visit>
+    auto dfs(NodeId start, Visit&& visit, size_t max_distance = SIZE_MAX)
+        -> size_t {
+        reset(start);
+        size_t n_visited = 0;
+        while (!m_work.empty()) {
+            auto [node, distance] = m_work.back();
+            m_work.pop_back();
+            // A node is pushed by every parent visited before it, and
+            // visited from the last of them, which is the first in
+            // preorder.
+            if (!mark(node)) {
+                continue;
+            }
+            visit(node, size_t{distance});
+            n_visited++;
+            if (distance < max_distance) {
+                size_t first_child = m_work.size();
+                for (const Edge& edge : m_graph.edges(node)) {
+                    if (!visited(edge.m_to)) {
+                        m_work.push_back(Entry{
+                            .m_node = edge.m_to,
+                            .m_distance = distance + 1});
+                    }
+                }
+                std::reverse(m_work.begin() + first_child, m_work.end());
+            }
+        }
+        return n_visited;
+    }
+
+    // Whether the last traversal reached `node`.
+    [[nodiscard]] auto visited(NodeId node) const -> bool {
+        return (m_visited[node / 64] >> (node % 64) & 1) != 0;
+    }
+
+   private:
+    struct Entry {
+        NodeId m_node;
+        uint32_t m_distance;
+    };
+
+    const Graph& m_graph;
+    std::vector<uint64_t> m_visited;
+    std::vector<Entry> m_work;
+
+    auto reset(NodeId start) -> void {
+        m_visited.assign((m_graph.size() + 63) / 64, 0);
+        m_work.clear();
+        m_work.push_back(Entry{.m_node = start, .m_distance = 0});
+    }
+
+    // Marks `node` visited, returning whether it was not already.
+    auto mark(NodeId node) -> bool {
+        uint64_t bit = uint64_t{1} << (node % 64);
+        uint64_t& word = m_visited[node / 64];
+        bool unvisited = (word & bit) == 0;
+        word |= bit;
+        return unvisited;
+    }
+
+    auto push_unvisited_children(NodeId node, size_t distance) -> void {
+        for (const Edge& edge : m_graph.edges(node)) {
+            if (mark(edge.m_to)) {
+                m_work.push_back(
+                    Entry{.m_node = edge.m_to,
+                          .m_distance = static_cast<uint32_t>(distance)});
+            }
+        }
+    }
+};
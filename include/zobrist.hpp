@@ -0,0 +1,42 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+#include "common.hpp"
+
+// Number of bytes in the packed state of a `Table`: stock and waste heads,
+// foundation tops, visible and hidden tableau heads, and one link per card.
+inline constexpr size_t c_table_state_size =
+    2 + c_num_suits + (2 * c_tableau_columns) + c_num_cards;
+// Every state byte holds a card index or `c_null_index`.
+inline constexpr size_t c_link_values = c_num_cards + 1;
+
+using ZobristKeys =
+    std::array<std::array<uint64_t, c_link_values>, c_table_state_size>;
+
+constexpr auto splitmix64(uint64_t& state) -> uint64_t {
+    uint64_t z = (state += 0x9E3779B97F4A7C15ULL);
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+    return z ^ (z >> 31);
+}
+
+constexpr auto make_zobrist_keys() -> ZobristKeys {
+    ZobristKeys keys{};
+    uint64_t state = 0x5EED0F5011741BEULL;
+    for (auto& position : keys) {
+        for (auto& key : position) {
+            key = splitmix64(state);
+        }
+    }
+    return keys;
+}
+
+inline constexpr ZobristKeys c_zobrist_keys = make_zobrist_keys();
+
+// Key for the state byte at `offset` holding `value`.
+constexpr auto zobrist_key(size_t offset, uint8_t value) -> uint64_t {
+    return c_zobrist_keys[offset][static_cast<size_t>(value)];
+}
@@ -0,0 +1,143 @@
+#include "batch.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <cassert>
+#include <charconv>
+#include <cstddef>
+#include <cstdint>
+#include <exception>
+#include <mutex>
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+#include "common.hpp"
+
+auto parse_seed(std::string_view token) -> std::optional<uint32_t> {
+    uint32_t seed = 0;
+    auto [end, error] =
+        std::from_chars(token.data(), token.data() + token.size(), seed);
+    if (error != std::errc{} || end != token.data() + token.size()) {
+        return std::nullopt;
+    }
+    return seed;
+}
+
+auto split_whitespace(std::string_view line) -> std::vector<std::string_view> {
+    std::vector<std::string_view> tokens;
+    size_t pos = 0;
+    while (true) {
+        pos = line.find_first_not_of(" \t\r", pos);
+        if (pos == std::string_view::npos) {
+            return tokens;
+        }
+        size_t end = std::min(line.find_first_of(" \t\r", pos), line.size());
+        tokens.push_back(line.substr(pos, end - pos));
+        pos = end;
+    }
+}
+
+auto parse_corpus_line(std::string_view line, size_t index)
+    -> std::optional<CorpusDeck> {
+    auto tokens = split_whitespace(line);
+    if (tokens.empty() || tokens.front().starts_with('#')) {
+        return std::nullopt;
+    }
+    CorpusDeck deck{.m_index = index, .m_seed = std::nullopt, .m_deck = {}};
+    if (tokens.size() == 1) {
+        deck.m_seed = parse_seed(tokens.front());
+        if (!deck.m_seed) {
+            throw std::invalid_argument("Invalid seed: " +
+                                        std::string(tokens.front()));
+        }
+        std::optional<std::mt19937> rng = std::mt19937(*deck.m_seed);
+        deck.m_deck = random_deck(rng);
+        return deck;
+    }
+    if (tokens.size() != c_num_cards) {
+        throw std::invalid_argument(
+            "Deck line has " + std::to_string(tokens.size()) + " cards");
+    }
+    uint64_t seen = 0;
+    for (size_t i = 0; i < c_num_cards; i++) {
+        uint8_t card = card_of_string(std::string(tokens[i]));
+        if ((seen & (uint64_t{1} << card)) != 0) {
+            throw std::invalid_argument("Deck line repeats " +
+                                        std::string(tokens[i]));
+        }
+        seen |= uint64_t{1} << card;
+        deck.m_deck[i] = card;
+    }
+    return deck;
+}
+
+auto CorpusReader::next() -> std::optional<CorpusDeck> {
+    std::string line;
+    while (std::getline(m_in, line)) {
+        m_line++;
+        try {
+            if (auto deck = parse_corpus_line(line, m_n_decks)) {
+                m_n_decks++;
+                return deck;
+            }
+        } catch (const std::invalid_argument& e) {
+            throw std::invalid_argument("Corpus line " +
+                                        std::to_string(m_line) + ": " +
+                                        e.what());
+        }
+    }
+    return std::nullopt;
+}
+
+auto run_batch(CorpusReader& corpus, size_t n_threads, const DeckJob& job,
+               std::ostream& out) -> size_t {
+    assert(n_threads > 0);
+    std::mutex corpus_mutex;
+    std::mutex out_mutex;
+    std::atomic<bool> failed{false};
+    std::exception_ptr error;
+    size_t n_decks = 0;
+    auto worker = [&]() {
+        try {
+            while (!failed.load(std::memory_order_relaxed)) {
+                std::optional<CorpusDeck> deck;
+                {
+                    std::scoped_lock lock(corpus_mutex);
+                    deck = corpus.next();
+                    if (!deck) {
+                        return;
+                    }
+                    n_decks++;
+                }
+                nlohmann::json record = job(*deck);
+                record["deck"] = deck->m_index;
+                if (deck->m_seed) {
+                    record["seed"] = *deck->m_seed;
+                }
+                std::string line = record.dump() + "\n";
+                std::scoped_lock lock(out_mutex);
+                out << line << std::flush;
+            }
+        } catch (...) {
+            std::scoped_lock lock(out_mutex);
+            if (!failed.exchange(true)) {
+                error = std::current_exception();
+            }
+        }
+    };
+    {
+        std::vector<std::jthread> workers;
+        workers.reserve(n_threads);
+        for (size_t i = 0; i < n_threads; i++) {
+            workers.emplace_back(worker);
+        }
+    }
+    if (error) {
+        std::rethrow_exception(error);
+    }
+    return n_decks;
+}
@@ -0,0 +1,130 @@
+#include "checkpoint.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>  // NOLINT(build/c++17)
+#include <fstream>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <type_traits>
+
+#include "moves.hpp"
+#include "table.hpp"
+
+constexpr std::string_view c_checkpoint_magic = "ROSECKPT";
+
+template <typename T>
+auto write_value(std::ofstream& out, const T& value) -> void {
+    static_assert(std::is_trivially_copyable_v<T>);
+    out.write(reinterpret_cast<const char*>(&value), sizeof(T));
+}
+
+template <typename T>
+auto read_value(std::ifstream& in, const std::filesystem::path& path) -> T {
+    static_assert(std::is_trivially_copyable_v<T>);
+    T value;
+    if (!in.read(reinterpret_cast<char*>(&value), sizeof(T))) {
+        throw std::runtime_error("Truncated checkpoint " + path.string());
+    }
+    return value;
+}
+
+auto write_checkpoint(const Graph& graph, const std::filesystem::path& path)
+    -> void {
+    auto tmp_path = path;
+    tmp_path += ".tmp";
+    std::ofstream out(tmp_path, std::ios::binary | std::ios::trunc);
+    if (!out.is_open()) {
+        throw std::runtime_error("Cannot open " + tmp_path.string());
+    }
+    out.write(c_checkpoint_magic.data(),
+              static_cast<std::streamsize>(c_checkpoint_magic.size()));
+    write_value(out, c_checkpoint_version);
+    write_value(out, static_cast<uint64_t>(graph.size()));
+    write_value(out, static_cast<uint64_t>(graph.n_edges()));
+    write_value(out, graph.frontier_begin());
+    for (NodeId id = 0; id < graph.size(); id++) {
+        write_value(out, graph.state(id));
+        write_value(out, graph.node(id).m_depth);
+        write_value(out, graph.node(id).m_n_edges);
+    }
+    // Runs are written back to back, dropping any gaps left by runs that
+    // were moved to the end of the edge array.
+    for (NodeId id = 0; id < graph.size(); id++) {
+        for (const Edge& edge : graph.edges(id)) {
+            write_value(out, edge.m_to);
+            write_value(out, edge.m_move.bits());
+        }
+    }
+    out.close();
+    if (out.fail()) {
+        throw std::runtime_error("Failed to write " + tmp_path.string());
+    }
+    std::filesystem::rename(tmp_path, path);
+}
+
+auto read_checkpoint(const std::filesystem::path& path) -> Graph {
+    std::ifstream in(path, std::ios::binary);
+    if (!in.is_open()) {
+        throw std::runtime_error("Cannot open " + path.string());
+    }
+    std::string magic(c_checkpoint_magic.size(), '\0');
+    in.read(magic.data(), static_cast<std::streamsize>(magic.size()));
+    if (!in || magic != c_checkpoint_magic) {
+        throw std::runtime_error(path.string() + " is not a checkpoint");
+    }
+    auto version = read_value<uint32_t>(in, path);
+    if (version != c_checkpoint_version) {
+        throw std::runtime_error("Unsupported checkpoint version " +
+                                 std::to_string(version));
+    }
+    auto n_nodes = read_value<uint64_t>(in, path);
+    auto n_edges = read_value<uint64_t>(in, path);
+    auto frontier_begin = read_value<NodeId>(in, path);
+    if (n_nodes == 0 || n_nodes > UINT32_MAX || n_edges > UINT32_MAX ||
+        frontier_begin > n_nodes) {
+        throw std::runtime_error("Corrupt checkpoint header in " +
+                                 path.string());
+    }
+    Graph graph;
+    graph.m_seen_states.reserve(n_nodes);
+    graph.m_nodes.reserve(n_nodes);
+    graph.m_edges.reserve(n_edges);
+    uint64_t first_edge = 0;
+    for (NodeId id = 0; id < n_nodes; id++) {
+        auto table = Table::unpack(read_value<PackedTable>(in, path));
+        auto depth = read_value<uint32_t>(in, path);
+        auto node_edges = read_value<uint32_t>(in, path);
+        auto [state, inserted] = graph.m_seen_states.insert(table);
+        if (!inserted || state != id ||
+            (id > 0 && depth < graph.m_nodes.back().m_depth)) {
+            throw std::runtime_error("Corrupt node " + std::to_string(id) +
+                                     " in " + path.string());
+        }
+        graph.m_nodes.push_back(
+            Node{.m_depth = depth,
+                 .m_first_edge = static_cast<uint32_t>(first_edge),
+                 .m_n_edges = node_edges});
+        first_edge += node_edges;
+    }
+    if (first_edge != n_edges) {
+        throw std::runtime_error("Corrupt edge count in " + path.string());
+    }
+    for (uint64_t i = 0; i < n_edges; i++) {
+        auto to = read_value<NodeId>(in, path);
+        auto move = Move::from_bits(read_value<uint16_t>(in, path));
+        if (to >= n_nodes || move.type() > MoveType::FoundationToTableau) {
+            throw std::runtime_error("Corrupt edge " + std::to_string(i) +
+                                     " in " + path.string());
+        }
+        graph.m_edges.push_back(Edge{.m_to = to, .m_move = move});
+    }
+    if (in.peek() != std::ifstream::traits_type::eof()) {
+        throw std::runtime_error("Trailing data in checkpoint " +
+                                 path.string());
+    }
+    graph.m_n_live_edges = n_edges;
+    graph.m_frontier_begin = frontier_begin;
+    return graph;
+}
@@ -0,0 +1,168 @@
+#include "coarsen.hpp"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+#define COARSEN_MAX_CLUSTER_NODES 4
+// Coarsening stops once a level no longer shrinks the graph by this much.
+#define COARSEN_MIN_SHRINK 0.9
+
+constexpr uint32_t c_no_node = UINT32_MAX;
+
+auto weighted_graph_of(const Graph& graph) -> WeightedGraph {
+    WeightedGraph level;
+    level.m_offsets.assign(graph.size() + 1, 0);
+    for (NodeId from = 0; from < graph.size(); from++) {
+        for (const auto& edge : graph.edges(from)) {
+            if (edge.m_to != from) {
+                level.m_offsets[from + 1]++;
+                level.m_offsets[edge.m_to + 1]++;
+            }
+        }
+    }
+    level.m_masses.resize(graph.size());
+    for (NodeId node = 0; node < graph.size(); node++) {
+        level.m_masses[node] =
+            static_cast<float>(level.m_offsets[node + 1]) + 1.0F;
+        level.m_offsets[node + 1] += level.m_offsets[node];
+    }
+    level.m_neighbours.resize(level.m_offsets.back());
+    level.m_weights.assign(level.m_offsets.back(), 1.0F);
+    std::vector<uint32_t> next(level.m_offsets.begin(),
+                               level.m_offsets.end() - 1);
+    for (NodeId from = 0; from < graph.size(); from++) {
+        for (const auto& edge : graph.edges(from)) {
+            if (edge.m_to != from) {
+                level.m_neighbours[next[from]++] = edge.m_to;
+                level.m_neighbours[next[edge.m_to]++] = from;
+            }
+        }
+    }
+    return level;
+}
+
+// A node joins the cluster of the neighbour it is most strongly tied to
+// relative to that cluster's mass. When that cluster is full, it joins a
+// sibling cluster of the full one, so that the many leaves around a hub
+// are grouped with each other.
+auto cluster_nodes(const WeightedGraph& fine) -> std::vector<uint32_t> {
+    std::vector<uint32_t> cluster(fine.size(), c_no_node);
+    std::vector<uint32_t> cluster_size;
+    std::vector<float> cluster_mass;
+    std::vector<uint32_t> sibling;
+    auto add_to = [&](uint32_t node, uint32_t c) {
+        if (c == cluster_size.size()) {
+            cluster_size.push_back(0);
+            cluster_mass.push_back(0.0F);
+            sibling.push_back(c_no_node);
+        }
+        cluster[node] = c;
+        cluster_size[c]++;
+        cluster_mass[c] += fine.m_masses[node];
+    };
+    for (uint32_t node = 0; node < fine.size(); node++) {
+        if (cluster[node] != c_no_node) {
+            continue;
+        }
+        uint32_t best = c_no_node;
+        float best_score = 0.0F;
+        for (uint32_t e = fine.m_offsets[node]; e < fine.m_offsets[node + 1];
+             e++) {
+            uint32_t other = fine.m_neighbours[e];
+            float mass = cluster[other] == c_no_node
+                             ? fine.m_masses[other]
+                             : cluster_mass[cluster[other]];
+            float score = fine.m_weights[e] / mass;
+            if (score > best_score) {
+                best = other;
+                best_score = score;
+            }
+        }
+        auto next_cluster = static_cast<uint32_t>(cluster_size.size());
+        if (best == c_no_node) {
+            add_to(node, next_cluster);
+        } else if (cluster[best] == c_no_node) {
+            add_to(node, next_cluster);
+            add_to(best, next_cluster);
+        } else if (cluster_size[cluster[best]] < COARSEN_MAX_CLUSTER_NODES) {
+            add_to(node, cluster[best]);
+        } else {
+            uint32_t& open = sibling[cluster[best]];
+            if (open == c_no_node ||
+                cluster_size[open] >= COARSEN_MAX_CLUSTER_NODES) {
+                open = next_cluster;
+            }
+            add_to(node, open);
+        }
+    }
+    return cluster;
+}
+
+auto coarsen(const WeightedGraph& fine, const std::vector<uint32_t>& cluster,
+             size_t n_clusters) -> WeightedGraph {
+    // The nodes of each cluster, in CSR form.
+    std::vector<uint32_t> member_offsets(n_clusters + 1, 0);
+    for (uint32_t c : cluster) {
+        member_offsets[c + 1]++;
+    }
+    for (size_t c = 0; c < n_clusters; c++) {
+        member_offsets[c + 1] += member_offsets[c];
+    }
+    std::vector<uint32_t> members(fine.size());
+    std::vector<uint32_t> next(member_offsets.begin(),
+                               member_offsets.end() - 1);
+    for (uint32_t node = 0; node < fine.size(); node++) {
+        members[next[cluster[node]]++] = node;
+    }
+    WeightedGraph coarse;
+    coarse.m_offsets.reserve(n_clusters + 1);
+    coarse.m_offsets.push_back(0);
+    coarse.m_masses.assign(n_clusters, 0.0F);
+    // Where the edge from the current cluster to each cluster is, if the
+    // current cluster has one yet.
+    std::vector<size_t> slot(n_clusters, SIZE_MAX);
+    for (uint32_t c = 0; c < n_clusters; c++) {
+        size_t first_edge = coarse.m_neighbours.size();
+        for (uint32_t m = member_offsets[c]; m < member_offsets[c + 1]; m++) {
+            uint32_t node = members[m];
+            coarse.m_masses[c] += fine.m_masses[node];
+            for (uint32_t e = fine.m_offsets[node];
+                 e < fine.m_offsets[node + 1]; e++) {
+                uint32_t other = cluster[fine.m_neighbours[e]];
+                if (other == c) {
+                    continue;
+                }
+                if (slot[other] != SIZE_MAX && slot[other] >= first_edge) {
+                    coarse.m_weights[slot[other]] += fine.m_weights[e];
+                } else {
+                    slot[other] = coarse.m_neighbours.size();
+                    coarse.m_neighbours.push_back(other);
+                    coarse.m_weights.push_back(fine.m_weights[e]);
+                }
+            }
+        }
+        coarse.m_offsets.push_back(
+            static_cast<uint32_t>(coarse.m_neighbours.size()));
+    }
+    return coarse;
+}
+
+auto coarsen_graph(const Graph& graph, size_t max_nodes) -> Coarsening {
+    Coarsening coarsening;
+    coarsening.m_levels.push_back(weighted_graph_of(graph));
+    while (coarsening.m_levels.back().size() > max_nodes) {
+        const WeightedGraph& fine = coarsening.m_levels.back();
+        auto cluster = cluster_nodes(fine);
+        size_t n_clusters = *std::ranges::max_element(cluster) + 1;
+        if (static_cast<double>(n_clusters) >
+            COARSEN_MIN_SHRINK * static_cast<double>(fine.size())) {
+            break;
+        }
+        coarsening.m_levels.push_back(coarsen(fine, cluster, n_clusters));
+        coarsening.m_clusters.push_back(std::move(cluster));
+    }
+    return coarsening;
+}
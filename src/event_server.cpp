@@ -0,0 +1,92 @@
+#include "event_server.hpp"
+
+#include <fmt/format.h>
+
+#include <cassert>
+#include <chrono>
+#include <cstddef>
+#include <string>
+#include <utility>
+
+// Idle streams get a comment this often, which finds closed connections.
+#define EVENT_SERVER_KEEPALIVE_S 15
+
+constexpr std::string_view c_events_path = "/events";
+
+constexpr std::string_view c_events_response =
+    "HTTP/1.1 200 OK\r\n"
+    "Content-Type: text/event-stream\r\n"
+    "Cache-Control: no-cache\r\n"
+    "Connection: keep-alive\r\n"
+    "Access-Control-Allow-Origin: *\r\n"
+    "\r\n";
+
+constexpr std::string_view c_keepalive = ":\n\n";
+
+EventServer::EventServer(uint16_t port)
+    : m_server(port,
+               [this](const HttpRequest& request, HttpConnection& connection) {
+                   return handle(request, connection);
+               }) {}
+
+auto EventServer::publish(std::string_view type, std::string_view data)
+    -> void {
+    assert(type.find('\n') == std::string_view::npos);
+    assert(data.find('\n') == std::string_view::npos);
+    auto event = std::make_shared<const std::string>(
+        fmt::format("event: {}\ndata: {}\n\n", type, data));
+    {
+        std::scoped_lock lock(m_mutex);
+        m_n_event_bytes += event->capacity();
+        m_events.push_back(std::move(event));
+    }
+    m_published.notify_all();
+}
+
+auto EventServer::memory_usage() const -> size_t {
+    std::scoped_lock lock(m_mutex);
+    return m_n_event_bytes +
+           (m_events.capacity() * sizeof(std::shared_ptr<const std::string>));
+}
+
+auto EventServer::handle(const HttpRequest& request,
+                         HttpConnection& connection) -> bool {
+    if (request.m_path != c_events_path) {
+        return connection.respond(HttpResponse{.m_status = 404,
+                                               .m_content_type = "text/plain",
+                                               .m_body = "Not found"});
+    }
+    if (connection.send(c_events_response)) {
+        stream_events(connection);
+    }
+    return false;
+}
+
+auto EventServer::stream_events(HttpConnection& connection) -> void {
+    const auto& stop = connection.stop_token();
+    size_t n_sent = 0;
+    std::vector<std::shared_ptr<const std::string>> pending;
+    while (true) {
+        {
+            std::unique_lock lock(m_mutex);
+            m_published.wait_for(
+                lock, stop, std::chrono::seconds(EVENT_SERVER_KEEPALIVE_S),
+                [&] { return m_events.size() > n_sent; });
+            if (stop.stop_requested()) {
+                return;
+            }
+            pending.assign(
+                m_events.begin() + static_cast<std::ptrdiff_t>(n_sent),
+                m_events.end());
+            n_sent = m_events.size();
+        }
+        if (pending.empty() && !connection.send(c_keepalive)) {
+            return;
+        }
+        for (const auto& event : pending) {
+            if (!connection.send(*event)) {
+                return;
+            }
+        }
+    }
+}
@@ -0,0 +1,362 @@
+#include "external_bfs.hpp"
+
+#include <fmt/format.h>
+
+#include <algorithm>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>  // NOLINT(build/c++17)
+#include <fstream>
+#include <functional>
+#include <optional>
+#include <queue>
+#include <span>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+#include "common.hpp"
+#include "moves.hpp"
+#include "table.hpp"
+
+// Most files read at once by one merge pass.
+#define EXTERNAL_BFS_MERGE_FAN_IN 16
+#define EXTERNAL_BFS_TIMEOUT_CHECK_FREQUENCY 1024
+
+// Appends packed tables to a file through a buffer of `buffer_states`.
+class PackedTableWriter {
+   public:
+    PackedTableWriter(const std::filesystem::path& path, size_t buffer_states)
+        : m_path(path),
+          m_file(path, std::ios::binary | std::ios::trunc),
+          m_buffer_states(buffer_states) {
+        assert(buffer_states > 0);
+        if (!m_file.is_open()) {
+            throw std::runtime_error("Cannot open " + path.string());
+        }
+        m_buffer.reserve(buffer_states);
+    }
+
+    auto write(const PackedTable& packed) -> void {
+        m_buffer.push_back(packed);
+        if (m_buffer.size() == m_buffer_states) {
+            flush();
+        }
+    }
+
+    // Flushes and closes the file, returning the number of tables written.
+    auto finish() -> size_t {
+        flush();
+        m_file.close();
+        if (m_file.fail()) {
+            throw std::runtime_error("Failed to write " + m_path.string());
+        }
+        return m_n_written;
+    }
+
+   private:
+    std::filesystem::path m_path;
+    std::ofstream m_file;
+    size_t m_buffer_states;
+    std::vector<PackedTable> m_buffer;
+    size_t m_n_written{0};
+
+    auto flush() -> void {
+        m_file.write(reinterpret_cast<const char*>(m_buffer.data()),
+                     static_cast<std::streamsize>(m_buffer.size() *
+                                                  sizeof(PackedTable)));
+        if (m_file.fail()) {
+            throw std::runtime_error("Failed to write " + m_path.string());
+        }
+        m_n_written += m_buffer.size();
+        m_buffer.clear();
+    }
+};
+
+// Reads packed tables from a file in order through a buffer of
+// `buffer_states`.
+class PackedTableReader {
+   public:
+    PackedTableReader(const std::filesystem::path& path, size_t buffer_states)
+        : m_path(path), m_file(path, std::ios::binary) {
+        assert(buffer_states > 0);
+        if (!m_file.is_open()) {
+            throw std::runtime_error("Cannot open " + path.string());
+        }
+        m_buffer.resize(buffer_states);
+        refill();
+    }
+
+    [[nodiscard]] auto empty() const -> bool { return m_pos == m_size; }
+    [[nodiscard]] auto front() const -> const PackedTable& {
+        assert(!empty());
+        return m_buffer[m_pos];
+    }
+    auto pop() -> void {
+        assert(!empty());
+        if (++m_pos == m_size) {
+            refill();
+        }
+    }
+
+   private:
+    std::filesystem::path m_path;
+    std::ifstream m_file;
+    std::vector<PackedTable> m_buffer;
+    size_t m_pos{0};
+    size_t m_size{0};
+
+    auto refill() -> void {
+        m_file.read(reinterpret_cast<char*>(m_buffer.data()),
+                    static_cast<std::streamsize>(m_buffer.size() *
+                                                 sizeof(PackedTable)));
+        auto n_bytes = static_cast<size_t>(m_file.gcount());
+        if (m_file.bad() || n_bytes % sizeof(PackedTable) != 0) {
+            throw std::runtime_error("Failed to read " + m_path.string());
+        }
+        m_pos = 0;
+        m_size = n_bytes / sizeof(PackedTable);
+    }
+};
+
+// Reads sorted files as one sorted sequence without duplicates.
+class PackedTableMerger {
+   public:
+    PackedTableMerger(std::span<const std::filesystem::path> paths,
+                      size_t buffer_states) {
+        m_readers.reserve(paths.size());
+        for (const auto& path : paths) {
+            m_readers.emplace_back(path, buffer_states);
+            if (!m_readers.back().empty()) {
+                m_heads.emplace(m_readers.back().front(),
+                                m_readers.size() - 1);
+            }
+        }
+    }
+
+    auto next() -> std::optional<PackedTable> {
+        while (!m_heads.empty()) {
+            auto [packed, file] = m_heads.top();
+            m_heads.pop();
+            m_readers[file].pop();
+            if (!m_readers[file].empty()) {
+                m_heads.emplace(m_readers[file].front(), file);
+            }
+            if (m_last != packed) {
+                m_last = packed;
+                return packed;
+            }
+        }
+        return std::nullopt;
+    }
+
+   private:
+    using Head = std::pair<PackedTable, size_t>;
+    std::vector<PackedTableReader> m_readers;
+    std::priority_queue<Head, std::vector<Head>, std::greater<>> m_heads;
+    std::optional<PackedTable> m_last;
+};
+
+auto external_layer_path(const std::filesystem::path& work_dir, size_t depth)
+    -> std::filesystem::path {
+    return work_dir / fmt::format("layer-{:04}.bin", depth);
+}
+
+auto external_run_path(const std::filesystem::path& work_dir, size_t run)
+    -> std::filesystem::path {
+    return work_dir / fmt::format("run-{:04}.bin", run);
+}
+
+// Every state of the layers written so far, sorted and unique.
+auto external_seen_path(const std::filesystem::path& work_dir)
+    -> std::filesystem::path {
+    return work_dir / "seen.bin";
+}
+
+// Sorts the buffered children and writes them to a new run file.
+auto spill_run(std::vector<PackedTable>& buffer,
+               const std::filesystem::path& work_dir, size_t io_states,
+               std::vector<std::filesystem::path>& runs) -> void {
+    std::ranges::sort(buffer);
+    auto [first, last] = std::ranges::unique(buffer);
+    buffer.erase(first, last);
+    runs.push_back(external_run_path(work_dir, runs.size()));
+    PackedTableWriter writer(runs.back(), io_states);
+    for (const PackedTable& packed : buffer) {
+        writer.write(packed);
+    }
+    writer.finish();
+    buffer.clear();
+}
+
+auto remove_runs(const std::vector<std::filesystem::path>& runs) -> void {
+    for (const auto& run : runs) {
+        std::filesystem::remove(run);
+    }
+}
+
+// Expands every state of the layer at `depth` into sorted run files, and
+// sets `won` if a child is a won state. Returns nothing if the timeout ran
+// out first.
+auto expand_layer(const std::filesystem::path& work_dir, size_t depth,
+                  size_t buffer_states, size_t io_states, bool& won,
+                  std::optional<size_t> deadline)
+    -> std::optional<std::vector<std::filesystem::path>> {
+    std::vector<std::filesystem::path> runs;
+    std::vector<PackedTable> buffer;
+    buffer.reserve(buffer_states);
+    PackedTableReader layer(external_layer_path(work_dir, depth), io_states);
+    for (size_t iteration = 0; !layer.empty(); iteration++) {
+        if (deadline &&
+            iteration % EXTERNAL_BFS_TIMEOUT_CHECK_FREQUENCY == 0 &&
+            get_now() >= *deadline) {
+            remove_runs(runs);
+            return std::nullopt;
+        }
+        Table table = Table::unpack(layer.front());
+        layer.pop();
+        for (const auto& move : generate_moves(table)) {
+            Table child = table;
+            apply_move(child, move);
+            won |= child.is_complete();
+            buffer.push_back(child.pack());
+            if (buffer.size() == buffer_states) {
+                spill_run(buffer, work_dir, io_states, runs);
+            }
+        }
+    }
+    if (!buffer.empty()) {
+        spill_run(buffer, work_dir, io_states, runs);
+    }
+    return runs;
+}
+
+// Merges the runs `EXTERNAL_BFS_MERGE_FAN_IN` at a time into fewer, longer
+// runs until at most that many are left, so the number of open files stays
+// bounded however many runs a layer spilled.
+auto reduce_runs(const std::filesystem::path& work_dir,
+                 std::vector<std::filesystem::path> runs, size_t io_states)
+    -> std::vector<std::filesystem::path> {
+    // Merged runs are numbered after every run of the layer.
+    size_t next_run = runs.size();
+    while (runs.size() > EXTERNAL_BFS_MERGE_FAN_IN) {
+        std::vector<std::filesystem::path> merged;
+        for (size_t begin = 0; begin < runs.size();
+             begin += EXTERNAL_BFS_MERGE_FAN_IN) {
+            std::span<const std::filesystem::path> group(runs);
+            group = group.subspan(
+                begin, std::min<size_t>(EXTERNAL_BFS_MERGE_FAN_IN,
+                                        runs.size() - begin));
+            merged.push_back(external_run_path(work_dir, next_run++));
+            PackedTableMerger merger(group, io_states);
+            PackedTableWriter writer(merged.back(), io_states);
+            while (auto packed = merger.next()) {
+                writer.write(*packed);
+            }
+            writer.finish();
+            for (const auto& run : group) {
+                std::filesystem::remove(run);
+            }
+        }
+        runs = std::move(merged);
+    }
+    return runs;
+}
+
+// Merges the runs into the layer at `depth`, dropping states that are in
+// the seen file, and adds the new states to the seen file. Every file is
+// sorted, so each is read once, in order.
+auto merge_layer(const std::filesystem::path& work_dir, size_t depth,
+                 std::vector<std::filesystem::path> runs, size_t io_states)
+    -> size_t {
+    runs = reduce_runs(work_dir, std::move(runs), io_states);
+    auto seen_path = external_seen_path(work_dir);
+    auto next_seen_path = seen_path;
+    next_seen_path += ".next";
+    size_t layer_size = 0;
+    {
+        PackedTableMerger merger(runs, io_states);
+        PackedTableReader seen(seen_path, io_states);
+        PackedTableWriter next_seen(next_seen_path, io_states);
+        PackedTableWriter writer(external_layer_path(work_dir, depth),
+                                 io_states);
+        while (auto packed = merger.next()) {
+            while (!seen.empty() && seen.front() < *packed) {
+                next_seen.write(seen.front());
+                seen.pop();
+            }
+            if (!seen.empty() && seen.front() == *packed) {
+                continue;
+            }
+            writer.write(*packed);
+            next_seen.write(*packed);
+        }
+        for (; !seen.empty(); seen.pop()) {
+            next_seen.write(seen.front());
+        }
+        layer_size = writer.finish();
+        next_seen.finish();
+    }
+    std::filesystem::rename(next_seen_path, seen_path);
+    remove_runs(runs);
+    return layer_size;
+}
+
+auto external_bfs(const Table& root, const std::filesystem::path& work_dir,
+                  size_t max_depth, size_t buffer_bytes,
+                  std::optional<float> timeout) -> ExternalBfsResult {
+    std::optional<size_t> deadline;
+    if (timeout) {
+        deadline = get_now() + static_cast<size_t>(*timeout * 1000);
+    }
+    size_t buffer_states =
+        std::max<size_t>(buffer_bytes / sizeof(PackedTable), 1);
+    // A merge has a reader per run and one for the seen file, and writes
+    // the layer and the next seen file, in memory the child buffer no
+    // longer uses by then.
+    size_t io_states =
+        std::max<size_t>(buffer_states / (EXTERNAL_BFS_MERGE_FAN_IN + 3), 1);
+    std::filesystem::create_directories(work_dir);
+    ExternalBfsResult result;
+    Table start = root;
+    start.rehash();
+    for (const auto& path :
+         {external_layer_path(work_dir, 0), external_seen_path(work_dir)}) {
+        PackedTableWriter writer(path, io_states);
+        writer.write(start.pack());
+        writer.finish();
+    }
+    result.m_layer_sizes.push_back(1);
+    if (start.is_complete()) {
+        result.m_win_depth = 0;
+    }
+    for (size_t depth = 0; depth < max_depth; depth++) {
+        bool won = false;
+        auto runs = expand_layer(work_dir, depth, buffer_states, io_states,
+                                 won, deadline);
+        if (!runs) {
+            result.m_timed_out = true;
+            break;
+        }
+        size_t layer_size =
+            merge_layer(work_dir, depth + 1, std::move(*runs), io_states);
+        result.m_layer_sizes.push_back(layer_size);
+        // Only once the layer is written, as a timeout discards it. A won
+        // state seen in an earlier layer already set the depth.
+        if (won && !result.m_win_depth) {
+            result.m_win_depth = depth + 1;
+        }
+        if (layer_size == 0) {
+            result.m_exhausted = true;
+            break;
+        }
+    }
+    // Layers left by an earlier, deeper run would not belong to this one.
+    for (size_t depth = result.m_layer_sizes.size();
+         std::filesystem::exists(external_layer_path(work_dir, depth));
+         depth++) {
+        std::filesystem::remove(external_layer_path(work_dir, depth));
+    }
+    return result;
+}
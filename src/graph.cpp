@@ -1,276 +1,391 @@
 #include "graph.hpp"
 
 #include <algorithm>
-#include <iostream>
-#include <memory>
+#include <atomic>
+#include <cstdint>
+#include <stdexcept>
+#include <thread>
 #include <utility>
 #include <vector>
 
 #include "ranking.hpp"
 #include "table.hpp"
 
-Node::Node(const Table& table, size_t depth)
-    : m_table(table), m_depth(depth), m_deadend(true) {}
+auto bfs_stop_to_string(BfsStop stop) -> std::string_view {
+    switch (stop) {
+        case BfsStop::Exhausted:
+            return "every state expanded";
+        case BfsStop::MaxDepth:
+            return "maximum depth reached";
+        case BfsStop::Timeout:
+            return "timeout reached";
+        case BfsStop::MaxMemory:
+            return "memory budget reached";
+        case BfsStop::MaxExpansions:
+            return "expansion budget reached";
+        case BfsStop::Interrupted:
+            return "interrupted";
+    }
+    throw std::invalid_argument("Invalid BFS stop");
+}
+
+Graph::Graph(const Table& initial_table) {
+    Table root_table = initial_table;
+    // The initial table may have been built by writing its fields directly.
+    root_table.rehash();
+    find_or_add_node(root_table, 0);
+}
+
+auto Graph::find_or_add_node(const StateKey& key, size_t depth)
+    -> std::pair<NodeId, bool> {
+    auto [id, inserted] = m_seen_states.insert(key);
+    if (inserted) {
+        m_nodes.push_back(Node{.m_depth = static_cast<uint32_t>(depth)});
+    }
+    return {id, inserted};
+}
+
+// `add_edge` compacts the edge array once the slots of moved runs are more
+// than the minimum and more than one per this many live edges.
+#define GRAPH_MIN_DEAD_EDGES 64
+#define GRAPH_MAX_DEAD_EDGE_FRACTION 16
+
+auto Graph::add_edge(NodeId from, NodeId to, const Move& move) -> void {
+    if (m_edges.size() >= UINT32_MAX) {
+        throw std::length_error("Graph edge array is full");
+    }
+    Node& node = m_nodes[from];
+    if (node.m_n_edges == 0) {
+        node.m_first_edge = static_cast<uint32_t>(m_edges.size());
+    } else if (node.m_first_edge + node.m_n_edges != m_edges.size()) {
+        size_t n_dead = m_edges.size() - m_n_live_edges;
+        if (n_dead > std::max<size_t>(GRAPH_MIN_DEAD_EDGES,
+                                      m_n_live_edges /
+                                          GRAPH_MAX_DEAD_EDGE_FRACTION)) {
+            compact_edges();
+        }
+    }
+    if (node.m_first_edge + node.m_n_edges != m_edges.size()) {
+        // Another node's edges were appended after this node's run, so move
+        // the run to the end of the array to keep it contiguous.
+        size_t first_edge = node.m_first_edge;
+        node.m_first_edge = static_cast<uint32_t>(m_edges.size());
+        for (size_t i = 0; i < node.m_n_edges; i++) {
+            Edge edge = m_edges[first_edge + i];
+            m_edges.push_back(edge);
+        }
+    }
+    m_edges.push_back(Edge{.m_to = to, .m_move = move});
+    node.m_n_edges++;
+    m_n_live_edges++;
+}
 
-Edge::Edge(const Move& move, const std::shared_ptr<Node>& from,
-           const std::shared_ptr<Node>& to)
-    : m_move(move), m_from(from), m_to(to) {
-    if (from->m_deadend) {
-        from->m_deadend = false;
+// Moves every run towards the start of the edge array, keeping their
+// order, over the slots of runs that were moved. The array keeps its
+// capacity for the edges still to come.
+auto Graph::compact_edges() -> void {
+    std::vector<NodeId> nodes;
+    for (NodeId id = 0; id < m_nodes.size(); id++) {
+        if (m_nodes[id].m_n_edges > 0) {
+            nodes.push_back(id);
+        }
+    }
+    std::ranges::sort(nodes, {},
+                      [this](NodeId id) { return m_nodes[id].m_first_edge; });
+    uint32_t next_edge = 0;
+    for (NodeId id : nodes) {
+        Node& node = m_nodes[id];
+        std::copy_n(m_edges.begin() + node.m_first_edge, node.m_n_edges,
+                    m_edges.begin() + next_edge);
+        node.m_first_edge = next_edge;
+        next_edge += node.m_n_edges;
     }
+    m_edges.resize(next_edge);
 }
 
-Graph::Graph(const Table& initial_table)
-    : m_root(std::make_shared<Node>(initial_table, 0)) {}
+auto Graph::has_edge(NodeId from, const Move& move) const -> bool {
+    auto node_edges = edges(from);
+    return std::any_of(
+        node_edges.begin(), node_edges.end(),
+        [&move](const Edge& edge) { return edge.m_move == move; });
+}
 
-auto Graph::generate_next_tables_bfs(DepthNodeQueue& node_queue,
-                                     const std::shared_ptr<Node>& node,
-                                     size_t current_depth) -> DepthNodeQueue& {
-    auto possible_moves = generate_moves(node->m_table);
+auto Graph::expand_node(NodeId node) -> void {
+    // Copy, as inserting new states may reallocate the state store.
+    Table table = m_seen_states[node];
+    size_t child_depth = m_nodes[node].m_depth + 1;
+    auto possible_moves = generate_moves(table);
     for (const auto& move : possible_moves) {
-        Table new_table = node->m_table;
-        new_table = apply_move(new_table, move);
-        if (auto search = m_seen_nodes.find(new_table);
-            search != m_seen_nodes.end()) {
-            bool edge_exists = std::any_of(
-                node->m_edges.begin(), node->m_edges.end(),
-                [&move](const Edge& edge) { return edge.m_move == move; });
-            if (!edge_exists) {
-                node->m_edges.emplace_back(move, node, *search);
-            }
+        // Every new child is copied into the store anyway, and copying the
+        // packed table is cheaper than undoing the move.
+        Table new_table = table;
+        apply_move(new_table, move);
+        auto [new_node, inserted] = find_or_add_node(new_table, child_depth);
+        if (!inserted && has_edge(node, move)) {
             continue;
         }
-        auto new_node = std::make_shared<Node>(new_table, current_depth + 1);
-        m_seen_nodes.insert(new_node);
-        node->m_edges.emplace_back(move, node, new_node);
-        node_queue.emplace(current_depth + 1, new_node);
+        add_edge(node, new_node, move);
     }
-    return node_queue;
 }
 
 #define TIMEOUT_CHECK_FREQUENCY 500
+#define BFS_CHUNK_NODES 256
+
+auto Graph::memory_usage(size_t n_new_nodes, size_t n_new_edges) const
+    -> size_t {
+    return m_seen_states.memory_usage(n_new_nodes) +
+           vector_bytes_after(m_nodes, n_new_nodes) +
+           vector_bytes_after(m_edges, n_new_edges);
+}
+
+// Expanding a node adds at most `c_max_moves` nodes and edges, so the check
+// is against the memory that would be in use after the worst case
+// expansion, including any reallocation it would trigger.
+auto Graph::expansion_memory_exceeded(std::optional<size_t> max_memory) const
+    -> bool {
+    return max_memory &&
+           memory_usage(c_max_moves, c_max_moves) > *max_memory;
+}
 
-auto Graph::generate_bfs(size_t depth, std::optional<float> timeout) -> size_t {
-    if (!m_seen_nodes.contains(m_root)) {
-        m_seen_nodes.insert(m_root);
+auto Graph::finish_bfs(BfsStop stop) const -> BfsReport {
+    // Depths never decrease along the node array.
+    return BfsReport{.m_depth = m_nodes.back().m_depth,
+                     .m_stop = stop,
+                     .m_memory_bytes = memory_usage()};
+}
+
+auto Graph::generate_bfs(size_t depth, std::optional<float> timeout,
+                         size_t n_threads, std::optional<size_t> max_memory,
+                         std::optional<size_t> max_expansions) -> BfsReport {
+    if (n_threads > 1) {
+        return generate_bfs_parallel(depth, timeout, n_threads, max_memory,
+                                     max_expansions);
     }
-    DepthNodeQueue node_queue;
-    node_queue.emplace(0, m_root);
-    size_t iteration = 0;
-    size_t max_depth_found = 0;
     size_t start_time = get_now();
-    while (!node_queue.empty()) {
-        auto [current_depth, current_node] = node_queue.front();
-        node_queue.pop();
-        if (current_depth > max_depth_found) {
-            max_depth_found = current_depth;
+    for (size_t iteration = 0; m_frontier_begin < m_nodes.size();
+         iteration++) {
+        if (interrupted()) {
+            return finish_bfs(BfsStop::Interrupted);
         }
-        if (timeout && iteration % TIMEOUT_CHECK_FREQUENCY == 0) {
-            size_t elapsed = get_now() - start_time;
-            if (elapsed >= static_cast<size_t>(*timeout * 1000)) {
-                std::cout << "Timeout reached after "
-                          << static_cast<double>(elapsed) / 1000.0
-                          << " seconds\n";
-                return max_depth_found;
-            }
+        if (timeout && iteration % TIMEOUT_CHECK_FREQUENCY == 0 &&
+            get_now() - start_time >= static_cast<size_t>(*timeout * 1000)) {
+            return finish_bfs(BfsStop::Timeout);
         }
-        if (current_depth >= depth) {
-            break;
+        if (m_nodes[m_frontier_begin].m_depth >= depth) {
+            return finish_bfs(BfsStop::MaxDepth);
+        }
+        if (expansion_memory_exceeded(max_memory)) {
+            return finish_bfs(BfsStop::MaxMemory);
         }
-        node_queue =
-            generate_next_tables_bfs(node_queue, current_node, current_depth);
-        iteration++;
+        if (max_expansions && m_frontier_begin >= *max_expansions) {
+            return finish_bfs(BfsStop::MaxExpansions);
+        }
+        expand_node(m_frontier_begin);
+        m_frontier_begin++;
     }
-    return max_depth_found;
+    return finish_bfs(BfsStop::Exhausted);
 }
 
-auto Graph::generate_bfs_on_existing(size_t depth, std::optional<float> timeout)
-    -> size_t {
-    DepthNodeQueue node_queue;
-    for (const auto& node_ptr : m_seen_nodes) {
-        node_queue.emplace(node_ptr->m_depth, node_ptr);
+auto Graph::expand_chunk(FrontierChunk& chunk) const -> void {
+    for (NodeId node = chunk.m_begin; node < chunk.m_end; node++) {
+        // The store is only read while chunks are being expanded.
+        Table table = m_seen_states[node];
+        for (const auto& move : generate_moves(table)) {
+            Table new_table = table;
+            apply_move(new_table, move);
+            auto key = StateKey::of(new_table);
+            auto existing = m_seen_states.find(key);
+            chunk.m_children.push_back(FrontierChunk::Child{
+                .m_from = node,
+                .m_to = existing.value_or(c_null_state),
+                .m_move = move});
+            if (!existing) {
+                chunk.m_new_states.push_back(key);
+            }
+        }
     }
-    size_t iteration = 0;
-    size_t max_depth_found = 0;
+    chunk.m_expanded = true;
+}
+
+auto Graph::commit_chunk(const FrontierChunk& chunk, size_t child_depth)
+    -> void {
+    size_t next_new_state = 0;
+    for (const auto& child : chunk.m_children) {
+        // Children new to the level may still have been reached by an
+        // earlier chunk, so they go through the store as in the serial BFS,
+        // with the key the worker built. One probe finds them or the slot
+        // to place them in.
+        auto [to, inserted] =
+            child.m_to == c_null_state
+                ? find_or_add_node(chunk.m_new_states[next_new_state++],
+                                   child_depth)
+                : std::pair{child.m_to, false};
+        if (!inserted && has_edge(child.m_from, child.m_move)) {
+            continue;
+        }
+        add_edge(child.m_from, to, child.m_move);
+    }
+}
+
+auto Graph::generate_bfs_parallel(size_t depth, std::optional<float> timeout,
+                                  size_t n_threads,
+                                  std::optional<size_t> max_memory,
+                                  std::optional<size_t> max_expansions)
+    -> BfsReport {
     size_t start_time = get_now();
-    while (!node_queue.empty()) {
-        auto [current_depth, current_node] = node_queue.front();
-        node_queue.pop();
-        if (current_depth > max_depth_found) {
-            max_depth_found = current_depth;
+    auto timeout_reached = [&] {
+        return timeout &&
+               get_now() - start_time >= static_cast<size_t>(*timeout * 1000);
+    };
+    while (m_frontier_begin < size()) {
+        // Nodes of one depth level are a contiguous range of ids, since
+        // depths never decrease along the node array.
+        size_t current_depth = m_nodes[m_frontier_begin].m_depth;
+        if (current_depth >= depth) {
+            return finish_bfs(BfsStop::MaxDepth);
         }
-        if (timeout && iteration % TIMEOUT_CHECK_FREQUENCY == 0) {
-            size_t elapsed = get_now() - start_time;
-            if (elapsed >= static_cast<size_t>(*timeout * 1000)) {
-                std::cout << "Timeout reached after "
-                          << static_cast<double>(elapsed) / 1000.0
-                          << " seconds\n";
-                return max_depth_found;
+        // Every node before the frontier has been expanded, so the budget
+        // ends at a node id.
+        if (max_expansions && m_frontier_begin >= *max_expansions) {
+            return finish_bfs(BfsStop::MaxExpansions);
+        }
+        NodeId level_end = m_frontier_begin;
+        while (level_end < size() &&
+               m_nodes[level_end].m_depth == current_depth &&
+               (!max_expansions || level_end < *max_expansions)) {
+            level_end++;
+        }
+        std::vector<FrontierChunk> chunks;
+        for (size_t begin = m_frontier_begin; begin < level_end;
+             begin += BFS_CHUNK_NODES) {
+            size_t end = std::min<size_t>(begin + BFS_CHUNK_NODES, level_end);
+            chunks.push_back(
+                FrontierChunk{.m_begin = static_cast<NodeId>(begin),
+                              .m_end = static_cast<NodeId>(end)});
+        }
+        std::atomic<size_t> next_chunk{0};
+        // The first reason a worker stopped for, set once.
+        std::atomic<bool> stopped{false};
+        BfsStop stop = BfsStop::Exhausted;
+        auto stop_with = [&](BfsStop reason) {
+            if (!stopped.exchange(true)) {
+                stop = reason;
+            }
+        };
+        // Children and buffer bytes of the chunks expanded so far this
+        // level, none of which is in the graph until the level is
+        // committed. Chunks being expanded may overshoot the budget by
+        // their buffers, but the graph itself stays within it, as chunks
+        // that would take it over are not committed.
+        std::atomic<size_t> pending_children{0};
+        std::atomic<size_t> pending_bytes{0};
+        auto memory_exceeded = [&] {
+            return max_memory &&
+                   memory_usage(pending_children, pending_children) +
+                           pending_bytes >
+                       *max_memory;
+        };
+        auto worker = [&] {
+            for (size_t i = next_chunk++; i < chunks.size(); i = next_chunk++) {
+                if (stopped) {
+                    return;
+                }
+                if (interrupted()) {
+                    stop_with(BfsStop::Interrupted);
+                    return;
+                }
+                if (timeout_reached()) {
+                    stop_with(BfsStop::Timeout);
+                    return;
+                }
+                if (memory_exceeded()) {
+                    stop_with(BfsStop::MaxMemory);
+                    return;
+                }
+                FrontierChunk& chunk = chunks[i];
+                expand_chunk(chunk);
+                pending_children += chunk.m_children.size();
+                pending_bytes += (chunk.m_children.capacity() *
+                                  sizeof(FrontierChunk::Child)) +
+                                 (chunk.m_new_states.capacity() *
+                                  sizeof(StateKey));
+            }
+        };
+        {
+            std::vector<std::jthread> workers;
+            for (size_t t = 1; t < n_threads; t++) {
+                workers.emplace_back(worker);
             }
+            worker();
         }
-        if (current_depth >= depth) {
-            break;
+        // Commit in frontier order; after a stop, only the chunks before
+        // the first unexpanded one, and the frontier starts at that one.
+        for (auto& chunk : chunks) {
+            if (!chunk.m_expanded) {
+                break;
+            }
+            if (max_memory && memory_usage(chunk.m_new_states.size(),
+                                           chunk.m_children.size()) >
+                                  *max_memory) {
+                stop_with(BfsStop::MaxMemory);
+                break;
+            }
+            commit_chunk(chunk, current_depth + 1);
+            m_frontier_begin = chunk.m_end;
+            chunk = FrontierChunk{};
+        }
+        if (stopped) {
+            return finish_bfs(stop);
         }
-        node_queue =
-            generate_next_tables_bfs(node_queue, current_node, current_depth);
-        iteration++;
     }
-    return max_depth_found;
+    return finish_bfs(BfsStop::Exhausted);
 }
 
-auto Graph::generate_next_tables_dfs(NodeStack& node_stack,
-                                     const std::shared_ptr<Node>& node,
+auto Graph::generate_next_tables_dfs(NodeStack& node_stack, NodeId node,
                                      size_t current_depth) -> NodeStack& {
-    auto possible_moves = generate_moves(node->m_table);
+    Table table = m_seen_states[node];
+    auto possible_moves = generate_moves(table);
+    if (possible_moves.empty()) {
+        return node_stack;
+    }
     std::sort(possible_moves.begin(), possible_moves.end(),
-              [&table = node->m_table](const Move& a, const Move& b) {
+              [&table](const Move& a, const Move& b) {
                   return compare_moves(a, b, table);
               });
-    Table new_table = node->m_table;
-    new_table = apply_move(new_table, possible_moves.back());
-    if (auto search = m_seen_nodes.find(new_table);
-        search != m_seen_nodes.end()) {
-        node->m_edges.emplace_back(possible_moves.back(), node, *search);
-        return node_stack;
+    apply_move(table, possible_moves.back());
+    auto [new_node, inserted] = find_or_add_node(table, 0);
+    add_edge(node, new_node, possible_moves.back());
+    if (inserted) {
+        node_stack.push(new_node);
     }
-    auto new_node = std::make_shared<Node>(new_table, 0);
-    m_seen_nodes.insert(new_node);
-    node->m_edges.emplace_back(possible_moves.back(), node, new_node);
-    node_stack.push(new_node);
     return node_stack;
 }
 
 auto Graph::generate_dfs() -> void {
-    if (!m_seen_nodes.contains(m_root)) {
-        m_seen_nodes.insert(m_root);
-    }
     NodeStack node_stack;
-    node_stack.push(m_root);
+    node_stack.push(c_root);
     while (!node_stack.empty()) {
-        auto current_node = node_stack.top();
+        NodeId current_node = node_stack.top();
         node_stack.pop();
-        if (current_node->m_table.is_complete()) {
+        if (m_seen_states[current_node].is_complete()) {
             break;
         }
         generate_next_tables_dfs(node_stack, current_node,
-                                 current_node->m_depth);
-    }
-}
-
-Graph::Iterator::Iterator(
-    std::shared_ptr<Graph> graph_ptr, std::unique_ptr<NodeQueue> node_queue_ptr,
-    std::unique_ptr<std::set<std::shared_ptr<Node>, NodeComparator>> seen_nodes)
-    : m_graph_ptr(std::move(graph_ptr)),
-      m_node_queue(std::move(node_queue_ptr)),
-      m_seen_nodes(std::move(seen_nodes)) {}
-
-Graph::Iterator::Iterator(const Iterator& other)
-    : m_graph_ptr(other.m_graph_ptr) {
-    if (other.m_node_queue) {
-        m_node_queue = std::make_unique<NodeQueue>(*other.m_node_queue);
-    } else {
-        m_node_queue.reset();
-    }
-}
-
-Graph::Iterator::Iterator(Iterator&& other) noexcept
-    : m_graph_ptr(std::move(other.m_graph_ptr)),
-      m_node_queue(std::move(other.m_node_queue)) {}
-
-auto Graph::Iterator::operator=(const Iterator& other) -> Iterator& {
-    if (this == &other) {
-        return *this;
-    }
-    m_graph_ptr = other.m_graph_ptr;
-    if (other.m_node_queue) {
-        m_node_queue = std::make_unique<NodeQueue>(*other.m_node_queue);
-    } else {
-        m_node_queue.reset();
-    }
-    if (other.m_seen_nodes) {
-        m_seen_nodes =
-            std::make_unique<std::set<std::shared_ptr<Node>, NodeComparator>>(
-                *other.m_seen_nodes);
-    } else {
-        m_seen_nodes.reset();
-    }
-    return *this;
-}
-
-auto Graph::Iterator::operator=(Iterator&& other) noexcept -> Iterator& {
-    m_graph_ptr = std::move(other.m_graph_ptr);
-    m_node_queue = std::move(other.m_node_queue);
-    m_seen_nodes = std::move(other.m_seen_nodes);
-    return *this;
-}
-
-auto Graph::Iterator::operator++() -> Iterator& {
-    if (!m_node_queue || m_node_queue->empty()) {
-        m_node_queue.reset();
-        return *this;
-    }
-    value_type& current_node = m_node_queue->front();
-    m_seen_nodes->insert(current_node);
-    m_node_queue->pop();
-    for (const auto& edge : current_node->m_edges) {
-        m_node_queue->emplace(edge.m_to);
-    }
-    while (!m_node_queue->empty() &&
-           m_seen_nodes->contains(m_node_queue->front())) {
-        m_node_queue->pop();
-    }
-    return *this;
-}
-
-auto Graph::Iterator::operator++(int) -> Iterator {
-    Iterator tmp = *this;
-    ++(*this);
-    return tmp;
-}
-
-auto Graph::Iterator::operator==(const Iterator& other) const -> bool {
-    if (m_node_queue == other.m_node_queue) {
-        return true;
-    }
-    if ((!m_node_queue || m_node_queue->empty()) &&
-        (!other.m_node_queue || other.m_node_queue->empty())) {
-        return true;
+                                 m_nodes[current_node].m_depth);
     }
-    if (!m_node_queue || m_node_queue->empty() || !other.m_node_queue ||
-        other.m_node_queue->empty()) {
-        return false;
-    }
-    return m_node_queue->front() == other.m_node_queue->front();
-}
-
-auto Graph::Iterator::operator!=(const Iterator& other) const -> bool {
-    return !(*this == other);
 }
 
-auto Graph::Iterator::operator*() -> reference {
-    if (!m_node_queue || m_node_queue->empty()) {
-        throw std::out_of_range("Iterator cannot be dereferenced at end");
-    }
-    return m_node_queue->front();
-}
-
-auto Graph::Iterator::operator*() const -> const value_type& {
-    return const_cast<Graph::Iterator*>(this)->operator*();
-}
-
-auto Graph::Iterator::operator->() -> pointer {
-    if (!m_node_queue || m_node_queue->empty()) {
-        throw std::out_of_range("Iterator cannot be dereferenced at end");
+auto Graph::add_path(std::span<const Move> moves) -> void {
+    NodeId node = c_root;
+    Table table = m_seen_states[c_root];
+    for (const auto& move : moves) {
+        apply_move(table, move);
+        // Depth zero, as for the DFS path, so that a following BFS expands
+        // around every node of the path.
+        auto [next_node, inserted] = find_or_add_node(table, 0);
+        if (inserted || !has_edge(node, move)) {
+            add_edge(node, next_node, move);
+        }
+        node = next_node;
     }
-    return std::addressof(m_node_queue->front());
 }
-
-auto Graph::Iterator::operator->() const -> const value_type* {
-    return const_cast<Graph::Iterator*>(this)->operator->();
-}
-
-auto Graph::Iterator::owner() const -> std::shared_ptr<Graph> {
-    return m_graph_ptr;
-}
-
-static_assert(std::forward_iterator<Graph::Iterator>);
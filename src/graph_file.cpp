@@ -0,0 +1,178 @@
+#include "graph_file.hpp"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+
+auto align_to_8(size_t offset) -> size_t { return (offset + 7) & ~size_t{7}; }
+
+auto GraphFileLayout::of(size_t n_nodes, size_t n_edges, bool positions,
+                         std::span<const uint32_t> cluster_counts,
+                         bool outcomes) -> GraphFileLayout {
+    GraphFileLayout layout{};
+    layout.m_depths = c_graph_file_header_size;
+    layout.m_edge_offsets =
+        align_to_8(layout.m_depths + (n_nodes * sizeof(uint32_t)));
+    layout.m_edge_targets =
+        align_to_8(layout.m_edge_offsets + ((n_nodes + 1) * sizeof(uint32_t)));
+    layout.m_edge_moves =
+        align_to_8(layout.m_edge_targets + (n_edges * sizeof(NodeId)));
+    layout.m_flags =
+        align_to_8(layout.m_edge_moves + (n_edges * sizeof(uint16_t)));
+    layout.m_states = align_to_8(layout.m_flags + n_nodes);
+    layout.m_positions =
+        align_to_8(layout.m_states + (n_nodes * c_table_state_size));
+    layout.m_clusters = align_to_8(
+        layout.m_positions + (positions ? n_nodes * sizeof(Point) : 0));
+    size_t n_entries = 0;
+    if (!cluster_counts.empty()) {
+        // Every level but the last has its clusters' clusters.
+        n_entries = 1 + cluster_counts.size() + n_nodes;
+        for (size_t level = 0; level + 1 < cluster_counts.size(); level++) {
+            n_entries += cluster_counts[level];
+        }
+    }
+    layout.m_win_distances =
+        align_to_8(layout.m_clusters + (n_entries * sizeof(uint32_t)));
+    layout.m_size = align_to_8(layout.m_win_distances +
+                               (outcomes ? n_nodes * sizeof(uint32_t) : 0));
+    return layout;
+}
+
+template <typename T>
+auto read_header_field(const uint8_t* data, size_t offset) -> T {
+    T value;
+    std::memcpy(&value, data + offset, sizeof(T));
+    return value;
+}
+
+template <typename T>
+auto mapped_array(const uint8_t* data, size_t offset, size_t n)
+    -> std::span<const T> {
+    return {reinterpret_cast<const T*>(data + offset), n};
+}
+
+GraphFile::GraphFile(const std::filesystem::path& path) {
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+        throw std::runtime_error("Cannot open " + path.string() + ": " +
+                                 std::strerror(errno));
+    }
+    struct stat info{};
+    if (::fstat(fd, &info) != 0 ||
+        static_cast<size_t>(info.st_size) < c_graph_file_header_size) {
+        ::close(fd);
+        throw std::runtime_error(path.string() + " is not a graph file");
+    }
+    m_size = static_cast<size_t>(info.st_size);
+    void* data = ::mmap(nullptr, m_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd);
+    if (data == MAP_FAILED) {
+        throw std::runtime_error("Cannot map " + path.string() + ": " +
+                                 std::strerror(errno));
+    }
+    m_data = static_cast<const uint8_t*>(data);
+    auto fail = [&](const std::string& message) {
+        ::munmap(const_cast<uint8_t*>(m_data), m_size);
+        throw std::runtime_error(path.string() + ": " + message);
+    };
+    if (!std::equal(c_graph_file_magic.begin(), c_graph_file_magic.end(),
+                    m_data)) {
+        fail("not a graph file");
+    }
+    auto version = read_header_field<uint32_t>(m_data, 8);
+    if (version != c_graph_file_version) {
+        fail("unsupported version " + std::to_string(version));
+    }
+    auto n_nodes = read_header_field<uint32_t>(m_data, 12);
+    auto n_edges = read_header_field<uint32_t>(m_data, 16);
+    if (n_nodes == 0) {
+        // Every graph has its start node.
+        fail("no nodes");
+    }
+    m_max_depth = read_header_field<uint32_t>(m_data, 20);
+    if (read_header_field<uint32_t>(m_data, 24) != c_table_state_size) {
+        fail("unsupported state size");
+    }
+    auto flags = read_header_field<uint32_t>(m_data, 28);
+    if ((flags & ~c_graph_file_known_flags) != 0) {
+        fail("unsupported flags " + std::to_string(flags));
+    }
+    bool positions = (flags & c_graph_file_has_positions) != 0;
+    bool outcomes = (flags & c_graph_file_has_outcomes) != 0;
+    auto layout =
+        GraphFileLayout::of(n_nodes, n_edges, positions, {}, outcomes);
+    if ((flags & c_graph_file_has_clusters) != 0) {
+        // The size of the clusters depends on the level count and the
+        // cluster counts, which lead them.
+        if (m_size < layout.m_clusters + sizeof(uint32_t)) {
+            fail("size does not match its header");
+        }
+        auto n_levels = read_header_field<uint32_t>(m_data, layout.m_clusters);
+        size_t counts_end =
+            layout.m_clusters + ((1 + size_t{n_levels}) * sizeof(uint32_t));
+        if (n_levels == 0 || m_size < counts_end) {
+            fail("size does not match its header");
+        }
+        m_cluster_counts = mapped_array<uint32_t>(
+            m_data, layout.m_clusters + sizeof(uint32_t), n_levels);
+        layout = GraphFileLayout::of(n_nodes, n_edges, positions,
+                                     m_cluster_counts, outcomes);
+    }
+    if (layout.m_size != m_size) {
+        fail("size does not match its header");
+    }
+    m_depths = mapped_array<uint32_t>(m_data, layout.m_depths, n_nodes);
+    m_edge_offsets =
+        mapped_array<uint32_t>(m_data, layout.m_edge_offsets, n_nodes + 1);
+    m_edge_targets =
+        mapped_array<NodeId>(m_data, layout.m_edge_targets, n_edges);
+    m_edge_moves = mapped_array<uint16_t>(m_data, layout.m_edge_moves, n_edges);
+    m_flags = mapped_array<uint8_t>(m_data, layout.m_flags, n_nodes);
+    m_states = mapped_array<uint8_t>(m_data, layout.m_states,
+                                     n_nodes * c_table_state_size);
+    if (positions) {
+        m_positions =
+            mapped_array<float>(m_data, layout.m_positions, 2 * n_nodes);
+    }
+    size_t offset =
+        layout.m_clusters + ((1 + m_cluster_counts.size()) * sizeof(uint32_t));
+    size_t level_size = n_nodes;
+    for (uint32_t count : m_cluster_counts) {
+        auto level = mapped_array<uint32_t>(m_data, offset, level_size);
+        if (std::ranges::any_of(
+                level, [&](uint32_t cluster) { return cluster >= count; })) {
+            fail("corrupt clusters");
+        }
+        m_clusters.push_back(level);
+        offset += level_size * sizeof(uint32_t);
+        level_size = count;
+    }
+    if (outcomes) {
+        m_win_distances =
+            mapped_array<uint32_t>(m_data, layout.m_win_distances, n_nodes);
+    }
+    if (m_edge_offsets.front() != 0 || m_edge_offsets.back() != n_edges ||
+        !std::ranges::is_sorted(m_edge_offsets) ||
+        std::ranges::any_of(m_edge_targets,
+                            [&](NodeId to) { return to >= n_nodes; })) {
+        fail("corrupt edges");
+    }
+}
+
+GraphFile::~GraphFile() { ::munmap(const_cast<uint8_t*>(m_data), m_size); }
+
+auto GraphFile::table(NodeId id) const -> Table {
+    PackedTable packed;
+    std::copy_n(m_states.begin() + static_cast<std::ptrdiff_t>(
+                                       id * c_table_state_size),
+                c_table_state_size, packed.begin());
+    return Table::unpack(packed);
+}
@@ -0,0 +1,246 @@
+#include "http_server.hpp"
+
+#include <arpa/inet.h>
+#include <fmt/format.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/time.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <array>
+#include <cerrno>
+#include <cstring>
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <utility>
+
+// How often the accepting thread checks whether the server is closing.
+#define HTTP_SERVER_POLL_MS 100
+// Connections idle for this long, or whose client stops reading for this
+// long, are closed.
+#define HTTP_SERVER_IO_TIMEOUT_S 10
+#define HTTP_SERVER_MAX_HEAD_BYTES 8192
+
+constexpr std::string_view c_head_end = "\r\n\r\n";
+
+constexpr std::string_view c_bad_request_response =
+    "HTTP/1.1 400 Bad Request\r\n"
+    "Content-Length: 0\r\n"
+    "Connection: close\r\n"
+    "\r\n";
+
+auto HttpRequest::param(std::string_view name) const
+    -> std::optional<std::string_view> {
+    auto it = m_params.find(name);
+    if (it == m_params.end()) {
+        return std::nullopt;
+    }
+    return it->second;
+}
+
+auto parse_http_request(std::string_view head) -> std::optional<HttpRequest> {
+    constexpr std::string_view c_get = "GET ";
+    if (!head.starts_with(c_get)) {
+        return std::nullopt;
+    }
+    head.remove_prefix(c_get.size());
+    size_t target_end = head.find(' ');
+    if (target_end == std::string_view::npos ||
+        !head.substr(target_end + 1).starts_with("HTTP/1.")) {
+        return std::nullopt;
+    }
+    std::string_view target = head.substr(0, target_end);
+    size_t query_start = std::min(target.find('?'), target.size());
+    HttpRequest request{.m_path = std::string(target.substr(0, query_start)),
+                        .m_params = {}};
+    std::string_view query =
+        target.substr(std::min(query_start + 1, target.size()));
+    while (!query.empty()) {
+        size_t end = std::min(query.find('&'), query.size());
+        std::string_view pair = query.substr(0, end);
+        size_t equals = std::min(pair.find('='), pair.size());
+        request.m_params.insert_or_assign(
+            std::string(pair.substr(0, equals)),
+            std::string(pair.substr(std::min(equals + 1, pair.size()))));
+        query.remove_prefix(std::min(end + 1, query.size()));
+    }
+    return request;
+}
+
+auto status_reason(int status) -> std::string_view {
+    switch (status) {
+        case 200:
+            return "OK";
+        case 400:
+            return "Bad Request";
+        case 404:
+            return "Not Found";
+        default:
+            return "Internal Server Error";
+    }
+}
+
+auto HttpConnection::respond(const HttpResponse& response) -> bool {
+    return send(fmt::format(
+        "HTTP/1.1 {} {}\r\n"
+        "Content-Type: {}\r\n"
+        "Content-Length: {}\r\n"
+        "Access-Control-Allow-Origin: *\r\n"
+        "\r\n"
+        "{}",
+        response.m_status, status_reason(response.m_status),
+        response.m_content_type, response.m_body.size(), response.m_body));
+}
+
+auto HttpConnection::send(std::string_view data) -> bool {
+    while (!data.empty()) {
+        ssize_t n = ::send(m_fd, data.data(), data.size(), MSG_NOSIGNAL);
+        if (n < 0 && errno == EINTR) {
+            continue;
+        }
+        if (n <= 0) {
+            return false;
+        }
+        data.remove_prefix(static_cast<size_t>(n));
+    }
+    return true;
+}
+
+// The head of the next request on `fd`, up to the blank line. Whatever
+// the client sent after it stays in `buffer` for the next call.
+auto read_request_head(int fd, std::string& buffer)
+    -> std::optional<std::string> {
+    std::array<char, 4096> chunk;
+    size_t end;
+    while ((end = buffer.find(c_head_end)) == std::string::npos) {
+        if (buffer.size() > HTTP_SERVER_MAX_HEAD_BYTES) {
+            return std::nullopt;
+        }
+        ssize_t n = ::recv(fd, chunk.data(), chunk.size(), 0);
+        if (n < 0 && errno == EINTR) {
+            continue;
+        }
+        if (n <= 0) {
+            return std::nullopt;
+        }
+        buffer.append(chunk.data(), static_cast<size_t>(n));
+    }
+    std::string head = buffer.substr(0, end);
+    buffer.erase(0, end + c_head_end.size());
+    return head;
+}
+
+auto configure_client_socket(int fd) -> void {
+    timeval timeout{.tv_sec = HTTP_SERVER_IO_TIMEOUT_S, .tv_usec = 0};
+    ::setsockopt(fd, SOL_SOCKET, SO_SNDTIMEO, &timeout, sizeof(timeout));
+    ::setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+    // Responses are written whole, so there is nothing to gain from
+    // holding back their last segment.
+    int no_delay = 1;
+    ::setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &no_delay, sizeof(no_delay));
+}
+
+HttpServer::HttpServer(uint16_t port, HttpHandler handler)
+    : m_handler(std::move(handler)) {
+    m_listen_fd = ::socket(AF_INET, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (m_listen_fd < 0) {
+        throw std::runtime_error(std::string("Cannot create a socket: ") +
+                                 std::strerror(errno));
+    }
+    int reuse = 1;
+    ::setsockopt(m_listen_fd, SOL_SOCKET, SO_REUSEADDR, &reuse,
+                 sizeof(reuse));
+    sockaddr_in address{};
+    address.sin_family = AF_INET;
+    address.sin_port = htons(port);
+    address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    socklen_t length = sizeof(address);
+    if (::bind(m_listen_fd, reinterpret_cast<sockaddr*>(&address),
+               length) != 0 ||
+        ::listen(m_listen_fd, SOMAXCONN) != 0 ||
+        ::getsockname(m_listen_fd, reinterpret_cast<sockaddr*>(&address),
+                      &length) != 0) {
+        auto message = fmt::format("Cannot listen on port {}: {}", port,
+                                   std::strerror(errno));
+        ::close(m_listen_fd);
+        throw std::runtime_error(message);
+    }
+    m_port = ntohs(address.sin_port);
+    m_accept_thread = std::jthread(
+        [this](const std::stop_token& stop) { accept_clients(stop); });
+}
+
+HttpServer::~HttpServer() {
+    m_accept_thread.request_stop();
+    m_accept_thread.join();
+    {
+        // Shutting a socket down wakes its thread if it is blocked on it.
+        std::scoped_lock lock(m_mutex);
+        for (auto& client : m_clients) {
+            client.m_thread.request_stop();
+            ::shutdown(client.m_fd, SHUT_RDWR);
+        }
+    }
+    for (auto& client : m_clients) {
+        client.m_thread.join();
+        ::close(client.m_fd);
+    }
+    ::close(m_listen_fd);
+}
+
+auto HttpServer::accept_clients(const std::stop_token& stop) -> void {
+    while (!stop.stop_requested()) {
+        pollfd listener{.fd = m_listen_fd, .events = POLLIN, .revents = 0};
+        if (::poll(&listener, 1, HTTP_SERVER_POLL_MS) <= 0) {
+            continue;
+        }
+        int fd = ::accept4(m_listen_fd, nullptr, nullptr, SOCK_CLOEXEC);
+        if (fd < 0) {
+            continue;
+        }
+        configure_client_socket(fd);
+        std::scoped_lock lock(m_mutex);
+        // Clients own their sockets until they are joined here, so a
+        // socket is never shut down after its number was reused.
+        for (auto it = m_clients.begin(); it != m_clients.end();) {
+            if (!it->m_done) {
+                ++it;
+                continue;
+            }
+            it->m_thread.join();
+            ::close(it->m_fd);
+            it = m_clients.erase(it);
+        }
+        Client& client = m_clients.emplace_back(Client{.m_fd = fd});
+        client.m_thread =
+            std::jthread([this, &client](const std::stop_token& stop) {
+                serve_client(stop, client);
+            });
+    }
+}
+
+auto HttpServer::serve_client(const std::stop_token& stop, Client& client)
+    -> void {
+    HttpConnection connection(client.m_fd, stop);
+    std::string buffer;
+    while (!stop.stop_requested()) {
+        auto head = read_request_head(client.m_fd, buffer);
+        if (!head) {
+            break;
+        }
+        auto request = parse_http_request(*head);
+        if (!request) {
+            connection.send(c_bad_request_response);
+            break;
+        }
+        if (!m_handler(*request, connection)) {
+            break;
+        }
+    }
+    std::scoped_lock lock(m_mutex);
+    client.m_done = true;
+}
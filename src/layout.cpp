@@ -0,0 +1,349 @@
+#include "layout.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <numbers>
+#include <utility>
+#include <vector>
+
+#include "coarsen.hpp"
+#include "parallel.hpp"
+
+#define LAYOUT_COARSEST_NODES 256
+#define LAYOUT_QUADTREE_MAX_DEPTH 32
+// Nodes per thread below which forces are computed on one thread.
+#define LAYOUT_MIN_NODES_PER_THREAD 4096
+
+constexpr uint32_t c_no_node = UINT32_MAX;
+// Steps of the golden angle spread the nodes of a cluster around it.
+constexpr float c_golden_angle = 2.39996323F;
+
+// A quadtree over the nodes, in which each cell holds the total mass of
+// the nodes inside it and their centre of mass.
+class BarnesHutTree {
+   public:
+    auto build(const std::vector<Point>& positions,
+               const std::vector<float>& masses) -> void {
+        m_cells.clear();
+        m_next_body.assign(positions.size(), c_no_node);
+        float min_x = positions.front().m_x;
+        float max_x = min_x;
+        float min_y = positions.front().m_y;
+        float max_y = min_y;
+        for (const Point& p : positions) {
+            min_x = std::min(min_x, p.m_x);
+            max_x = std::max(max_x, p.m_x);
+            min_y = std::min(min_y, p.m_y);
+            max_y = std::max(max_y, p.m_y);
+        }
+        // Slightly wider than the nodes, so that they are all inside it.
+        float side = std::max({max_x - min_x, max_y - min_y, 1e-6F}) * 1.001F;
+        m_cells.push_back(Cell{.m_x = min_x, .m_y = min_y, .m_side = side});
+        for (uint32_t node = 0; node < positions.size(); node++) {
+            insert(node, positions[node], masses[node]);
+        }
+        order_bodies();
+    }
+
+    // Every node, in the order of the leaves holding them, so that nodes
+    // close to each other, which visit the same cells, are close in it.
+    [[nodiscard]] auto bodies() const -> const std::vector<uint32_t>& {
+        return m_bodies;
+    }
+
+    // The repulsion of every other node on the node at `p`, approximating
+    // each cell that is small or far enough by a body at its centre of
+    // mass. Nodes sharing the leaf of the node do not repel it.
+    [[nodiscard]] auto repulsion(Point p, float mass, float scaling,
+                                 float theta,
+                                 std::vector<uint32_t>& stack) const -> Point {
+        Point force{0.0F, 0.0F};
+        float theta_squared = theta * theta;
+        stack.clear();
+        stack.push_back(0);
+        while (!stack.empty()) {
+            const Cell& cell = m_cells[stack.back()];
+            stack.pop_back();
+            if (cell.m_mass == 0.0F) {
+                continue;
+            }
+            bool leaf = cell.m_first_child == 0;
+            float dx = p.m_x - cell.m_centre_x;
+            float dy = p.m_y - cell.m_centre_y;
+            float distance_squared = (dx * dx) + (dy * dy);
+            if (leaf || (cell.m_side * cell.m_side <
+                             theta_squared * distance_squared &&
+                         !contains(cell, p))) {
+                if (!(leaf && contains(cell, p)) && distance_squared > 0.0F) {
+                    float factor =
+                        scaling * mass * cell.m_mass / distance_squared;
+                    force.m_x += dx * factor;
+                    force.m_y += dy * factor;
+                }
+                continue;
+            }
+            for (uint32_t child = 0; child < 4; child++) {
+                stack.push_back(cell.m_first_child + child);
+            }
+        }
+        return force;
+    }
+
+   private:
+    struct Cell {
+        // Corner with the smallest coordinates.
+        float m_x;
+        float m_y;
+        float m_side;
+        float m_mass{0.0F};
+        float m_centre_x{0.0F};
+        float m_centre_y{0.0F};
+        // The four children are consecutive; 0 for a leaf.
+        uint32_t m_first_child{0};
+        // The first node in a leaf, or `c_no_node`.
+        uint32_t m_body{c_no_node};
+    };
+    std::vector<Cell> m_cells;
+    // The next node in the same leaf, which only leaves at the maximum
+    // depth have.
+    std::vector<uint32_t> m_next_body;
+    std::vector<uint32_t> m_bodies;
+    std::vector<uint32_t> m_stack;
+
+    static auto add_mass(Cell& cell, Point p, float mass) -> void {
+        float total = cell.m_mass + mass;
+        cell.m_centre_x =
+            ((cell.m_centre_x * cell.m_mass) + (p.m_x * mass)) / total;
+        cell.m_centre_y =
+            ((cell.m_centre_y * cell.m_mass) + (p.m_y * mass)) / total;
+        cell.m_mass = total;
+    }
+
+    static auto contains(const Cell& cell, Point p) -> bool {
+        return p.m_x >= cell.m_x && p.m_x < cell.m_x + cell.m_side &&
+               p.m_y >= cell.m_y && p.m_y < cell.m_y + cell.m_side;
+    }
+
+    static auto child_for(const Cell& cell, Point p) -> uint32_t {
+        float half = cell.m_side / 2.0F;
+        uint32_t quadrant = (p.m_x >= cell.m_x + half ? 1 : 0) +
+                            (p.m_y >= cell.m_y + half ? 2 : 0);
+        return cell.m_first_child + quadrant;
+    }
+
+    // Turns a leaf holding one node into a cell with four children.
+    auto split(uint32_t index) -> void {
+        auto first_child = static_cast<uint32_t>(m_cells.size());
+        Cell parent = m_cells[index];
+        float half = parent.m_side / 2.0F;
+        for (uint32_t quadrant = 0; quadrant < 4; quadrant++) {
+            m_cells.push_back(
+                Cell{.m_x = parent.m_x + ((quadrant & 1) != 0 ? half : 0.0F),
+                     .m_y = parent.m_y + ((quadrant & 2) != 0 ? half : 0.0F),
+                     .m_side = half});
+        }
+        Cell& cell = m_cells[index];
+        cell.m_first_child = first_child;
+        Cell& child = m_cells[child_for(
+            cell, Point{cell.m_centre_x, cell.m_centre_y})];
+        child.m_body = std::exchange(cell.m_body, c_no_node);
+        child.m_mass = cell.m_mass;
+        child.m_centre_x = cell.m_centre_x;
+        child.m_centre_y = cell.m_centre_y;
+    }
+
+    auto insert(uint32_t node, Point p, float mass) -> void {
+        uint32_t index = 0;
+        for (size_t depth = 0;; depth++) {
+            Cell& cell = m_cells[index];
+            if (cell.m_first_child != 0) {
+                add_mass(cell, p, mass);
+                index = child_for(cell, p);
+                continue;
+            }
+            if (cell.m_mass == 0.0F) {
+                cell.m_body = node;
+                add_mass(cell, p, mass);
+                return;
+            }
+            // Nodes too close to split apart share a leaf.
+            if (depth == LAYOUT_QUADTREE_MAX_DEPTH) {
+                m_next_body[node] = std::exchange(cell.m_body, node);
+                add_mass(cell, p, mass);
+                return;
+            }
+            split(index);
+        }
+    }
+
+    auto order_bodies() -> void {
+        m_bodies.clear();
+        m_stack.assign(1, 0);
+        while (!m_stack.empty()) {
+            const Cell& cell = m_cells[m_stack.back()];
+            m_stack.pop_back();
+            if (cell.m_first_child != 0) {
+                for (uint32_t child = 4; child-- > 0;) {
+                    m_stack.push_back(cell.m_first_child + child);
+                }
+                continue;
+            }
+            for (uint32_t body = cell.m_body; body != c_no_node;
+                 body = m_next_body[body]) {
+                m_bodies.push_back(body);
+            }
+        }
+    }
+};
+
+// Runs ForceAtlas2 on one level, with the adaptive speed of Jacomy et al.:
+// the global speed rises while nodes move steadily and falls when they
+// swing back and forth, and each node is slowed by its own swinging.
+auto run_force_atlas(const WeightedGraph& level, std::vector<Point>& positions,
+                     const LayoutOptions& options) -> void {
+    size_t n = level.size();
+    size_t n_chunks = std::clamp<size_t>(n / LAYOUT_MIN_NODES_PER_THREAD, 1,
+                                         options.m_n_threads);
+    std::vector<Point> forces(n, Point{0.0F, 0.0F});
+    std::vector<Point> old_forces(n, Point{0.0F, 0.0F});
+    std::vector<double> swinging(n_chunks);
+    std::vector<double> traction(n_chunks);
+    std::vector<std::vector<uint32_t>> stacks(n_chunks);
+    BarnesHutTree tree;
+    double speed = 1.0;
+    double speed_efficiency = 1.0;
+    for (size_t iteration = 0; iteration < options.m_iterations; iteration++) {
+        std::swap(forces, old_forces);
+        tree.build(positions, level.m_masses);
+        parallel_chunks(n, n_chunks, [&](size_t begin, size_t end,
+                                         size_t chunk) {
+            double chunk_swinging = 0.0;
+            double chunk_traction = 0.0;
+            for (size_t i = begin; i < end; i++) {
+                uint32_t node = tree.bodies()[i];
+                Point p = positions[node];
+                float mass = level.m_masses[node];
+                Point force = tree.repulsion(p, mass, options.m_scaling,
+                                             options.m_theta, stacks[chunk]);
+                for (uint32_t e = level.m_offsets[node];
+                     e < level.m_offsets[node + 1]; e++) {
+                    const Point& other = positions[level.m_neighbours[e]];
+                    force.m_x -= (p.m_x - other.m_x) * level.m_weights[e];
+                    force.m_y -= (p.m_y - other.m_y) * level.m_weights[e];
+                }
+                float distance = std::hypot(p.m_x, p.m_y);
+                if (distance > 0.0F) {
+                    float factor = options.m_gravity * mass / distance;
+                    force.m_x -= p.m_x * factor;
+                    force.m_y -= p.m_y * factor;
+                }
+                forces[node] = force;
+                const Point& old = old_forces[node];
+                chunk_swinging += mass * std::hypot(old.m_x - force.m_x,
+                                                    old.m_y - force.m_y);
+                chunk_traction += 0.5 * mass *
+                                  std::hypot(old.m_x + force.m_x,
+                                             old.m_y + force.m_y);
+            }
+            swinging[chunk] = chunk_swinging;
+            traction[chunk] = chunk_traction;
+        });
+        double total_swinging = 0.0;
+        double total_traction = 0.0;
+        for (size_t chunk = 0; chunk < n_chunks; chunk++) {
+            total_swinging += swinging[chunk];
+            total_traction += traction[chunk];
+        }
+        if (total_swinging > 0.0) {
+            auto n_d = static_cast<double>(n);
+            double optimal_jitter = 0.05 * std::sqrt(n_d);
+            double jitter = std::max(
+                std::sqrt(optimal_jitter),
+                std::min(optimal_jitter * total_traction / (n_d * n_d), 10.0));
+            constexpr double min_speed_efficiency = 0.05;
+            if (total_swinging / total_traction > 2.0) {
+                if (speed_efficiency > min_speed_efficiency) {
+                    speed_efficiency *= 0.5;
+                }
+                jitter = std::max(jitter, 1.0);
+            }
+            double target_speed =
+                jitter * speed_efficiency * total_traction / total_swinging;
+            if (total_swinging > jitter * total_traction) {
+                if (speed_efficiency > min_speed_efficiency) {
+                    speed_efficiency *= 0.7;
+                }
+            } else if (speed < 1000.0) {
+                speed_efficiency *= 1.3;
+            }
+            speed += std::min(target_speed - speed, 0.5 * speed);
+        }
+        parallel_chunks(n, n_chunks, [&](size_t begin, size_t end, size_t) {
+            for (size_t node = begin; node < end; node++) {
+                const Point& force = forces[node];
+                const Point& old = old_forces[node];
+                double node_swinging =
+                    level.m_masses[node] *
+                    std::hypot(old.m_x - force.m_x, old.m_y - force.m_y);
+                auto factor = static_cast<float>(
+                    speed / (1.0 + std::sqrt(speed * node_swinging)));
+                positions[node].m_x += force.m_x * factor;
+                positions[node].m_y += force.m_y * factor;
+            }
+        });
+    }
+}
+
+// Places each node of a level near its cluster, on a small circle whose
+// radius is a fraction of the coarse level's mean edge length, so that
+// the nodes of a cluster start apart.
+auto prolong(const WeightedGraph& coarse,
+             const std::vector<Point>& coarse_positions,
+             const std::vector<uint32_t>& cluster) -> std::vector<Point> {
+    double total_length = 0.0;
+    for (uint32_t node = 0; node < coarse.size(); node++) {
+        for (uint32_t e = coarse.m_offsets[node];
+             e < coarse.m_offsets[node + 1]; e++) {
+            const Point& a = coarse_positions[node];
+            const Point& b = coarse_positions[coarse.m_neighbours[e]];
+            total_length += std::hypot(a.m_x - b.m_x, a.m_y - b.m_y);
+        }
+    }
+    auto radius = static_cast<float>(
+        coarse.m_neighbours.empty()
+            ? 1.0
+            : 0.1 * total_length /
+                  static_cast<double>(coarse.m_neighbours.size()));
+    std::vector<Point> positions(cluster.size());
+    for (uint32_t node = 0; node < cluster.size(); node++) {
+        float angle = static_cast<float>(node) * c_golden_angle;
+        const Point& centre = coarse_positions[cluster[node]];
+        positions[node] = Point{centre.m_x + (radius * std::cos(angle)),
+                                centre.m_y + (radius * std::sin(angle))};
+    }
+    return positions;
+}
+
+auto compute_layout(const Graph& graph, const LayoutOptions& options)
+    -> std::vector<Point> {
+    if (graph.size() == 0) {
+        return {};
+    }
+    auto [levels, clusters] = coarsen_graph(graph, LAYOUT_COARSEST_NODES);
+    // The coarsest level starts on a circle, as the web app's layout does.
+    std::vector<Point> positions(levels.back().size());
+    for (size_t node = 0; node < positions.size(); node++) {
+        double angle = 2.0 * std::numbers::pi * static_cast<double>(node) /
+                       static_cast<double>(positions.size());
+        positions[node] = Point{static_cast<float>(std::cos(angle)),
+                                static_cast<float>(std::sin(angle))};
+    }
+    run_force_atlas(levels.back(), positions, options);
+    for (size_t level = levels.size() - 1; level > 0; level--) {
+        positions = prolong(levels[level], positions, clusters[level - 1]);
+        run_force_atlas(levels[level - 1], positions, options);
+    }
+    return positions;
+}
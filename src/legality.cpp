@@ -0,0 +1,77 @@
+#include "legality.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+
+#include "common.hpp"
+#include "table.hpp"
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define ROSE_HAS_X86 1
+#else
+#define ROSE_HAS_X86 0
+#endif
+
+#define TABLEAU_COLUMNS_MASK ((1U << c_tableau_columns) - 1)
+
+auto tableau_targets_scalar(const TableauTops& tops, uint8_t card_index)
+    -> uint8_t {
+    uint64_t parents = c_tableau_parents[static_cast<size_t>(card_index)];
+    unsigned targets = 0;
+    for (size_t col = 0; col < c_tableau_columns; col++) {
+        targets |= static_cast<unsigned>((tops[col] & parents) != 0) << col;
+    }
+    return static_cast<uint8_t>(targets);
+}
+
+#if ROSE_HAS_X86
+
+__attribute__((target("avx2"))) auto tableau_targets_avx2(
+    const TableauTops& tops, uint8_t card_index) -> uint8_t {
+    __m256i parents = _mm256_set1_epi64x(static_cast<int64_t>(
+        c_tableau_parents[static_cast<size_t>(card_index)]));
+    __m256i low = _mm256_loadu_si256(
+        reinterpret_cast<const __m256i*>(tops.data()));  // NOLINT
+    __m256i high = _mm256_loadu_si256(
+        reinterpret_cast<const __m256i*>(tops.data() + 4));  // NOLINT
+    __m256i zero = _mm256_setzero_si256();
+    // Lanes where the column top is not a parent of the card.
+    __m256i low_miss = _mm256_cmpeq_epi64(_mm256_and_si256(low, parents), zero);
+    __m256i high_miss =
+        _mm256_cmpeq_epi64(_mm256_and_si256(high, parents), zero);
+    auto misses = static_cast<unsigned>(
+        _mm256_movemask_pd(_mm256_castsi256_pd(low_miss)) |
+        (_mm256_movemask_pd(_mm256_castsi256_pd(high_miss)) << 4));
+    return static_cast<uint8_t>(~misses & TABLEAU_COLUMNS_MASK);
+}
+
+auto has_avx2() -> bool {
+    static const bool supported = __builtin_cpu_supports("avx2") != 0;
+    return supported;
+}
+
+#else
+
+auto tableau_targets_avx2(const TableauTops& tops, uint8_t card_index)
+    -> uint8_t {
+    return tableau_targets_scalar(tops, card_index);
+}
+
+auto has_avx2() -> bool { return false; }
+
+#endif
+
+using TableauTargetsFn = uint8_t (*)(const TableauTops&, uint8_t);
+
+static const TableauTargetsFn tableau_targets_fn =
+    has_avx2() ? tableau_targets_avx2 : tableau_targets_scalar;
+
+auto tableau_targets(const TableauTops& tops, uint8_t card_index) -> uint8_t {
+    return tableau_targets_fn(tops, card_index);
+}
+
+auto tableau_targets_kernel() -> std::string_view {
+    return has_avx2() ? "avx2" : "scalar";
+}
@@ -1,15 +1,37 @@
 #include <fmt/format.h>
 #include <unistd.h>
 
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <csignal>
 #include <cstddef>
+#include <cstdint>
+#include <exception>
 #include <filesystem>  // NOLINT(build/c++17)
+#include <fstream>
 #include <iostream>
 #include <optional>
+#include <stdexcept>
 #include <string>
+#include <thread>
+#include <utility>
 #include <vector>
 
+#include "batch.hpp"
+#include "checkpoint.hpp"
+#include "coarsen.hpp"
+#include "event_server.hpp"
+#include "external_bfs.hpp"
 #include "graph.hpp"
+#include "graph_file.hpp"
+#include "http_server.hpp"
+#include "layout.hpp"
+#include "outcome.hpp"
+#include "query.hpp"
 #include "serialise.hpp"
+#include "solver.hpp"
 #include "table.hpp"
 
 auto make_random_table() -> Table {
@@ -23,14 +45,57 @@ auto make_random_table() -> Table {
 struct CmdArgs {
     std::filesystem::path out_dir;
     std::optional<std::filesystem::path> deck_file;
+    std::optional<std::filesystem::path> batch_file;
     std::optional<size_t> max_depth;
     std::optional<float> timeout;
+    std::optional<size_t> max_memory_mb;
+    size_t n_threads{1};
     bool with_dfs{false};
+    bool solve{false};
+    bool solve_dfs{false};
+    size_t tt_mb{256};
+    size_t max_expansions{SIZE_MAX};
+    bool external_bfs{false};
+    size_t buffer_mb{256};
+    std::optional<std::filesystem::path> checkpoint;
+    float checkpoint_every{60};
+    bool resume{false};
+    bool compact_json{false};
+    bool packed_tables{false};
+    bool binary_graph{false};
+    bool layout{false};
+    size_t layout_iterations{LayoutOptions{}.m_iterations};
+    bool lod{false};
+    size_t lod_nodes{2000};
+    bool outcomes{false};
+    bool serve{false};
+    size_t serve_port{8081};
+    std::optional<std::filesystem::path> query_file;
 };
 
 #define USAGE_MSG                                            \
     "Usage: rose [--deck <deckfile>] [--max-depth <depth>] " \
-    "[--timeout <timeout>] [--with-dfs] <graph_output_directory>\n"
+    "[--timeout <timeout>] [--max-memory <mb>] "             \
+    "[--threads <n>] [--with-dfs] "                          \
+    "[--solve] [--solve-dfs] [--tt-mb <mb>] "                \
+    "[--batch <corpus>] [--max-expansions <n>] "             \
+    "[--external-bfs] [--buffer-mb <mb>] "                   \
+    "[--checkpoint <file>] [--checkpoint-every <s>] "        \
+    "[--resume] [--compact-json] [--packed-tables] "         \
+    "[--graph-format json|bin] "                             \
+    "[--layout] [--layout-iterations <n>] "                  \
+    "[--lod] [--lod-nodes <n>] [--outcomes] "                \
+    "[--serve] [--serve-port <port>] "                       \
+    "<graph_output_directory>\n"                             \
+    "       rose --query <graph.bin> [--serve-port <port>]\n"
+
+auto is_binary_graph_format(std::string_view format) -> bool {
+    if (format != "json" && format != "bin") {
+        std::cerr << "--graph-format must be json or bin\n";
+        exit(1);
+    }
+    return format == "bin";
+}
 
 auto parse_args(int argc, char** argv) -> CmdArgs {
     if (argc < 2) {
@@ -49,6 +114,23 @@ auto parse_args(int argc, char** argv) -> CmdArgs {
             args.deck_file = std::filesystem::path(argv[++i]);
         } else if (a.rfind("--deck=", 0) == 0) {
             args.deck_file = std::filesystem::path(std::string(a.substr(7)));
+        } else if (a == "--batch") {
+            if (i + 1 >= argc) {
+                std::cerr << "--batch requires a corpus file path\n";
+                exit(1);
+            }
+            args.batch_file = std::filesystem::path(argv[++i]);
+        } else if (a.rfind("--batch=", 0) == 0) {
+            args.batch_file = std::filesystem::path(std::string(a.substr(8)));
+        } else if (a == "--max-expansions") {
+            if (i + 1 >= argc) {
+                std::cerr << "--max-expansions requires a node count\n";
+                exit(1);
+            }
+            args.max_expansions = static_cast<size_t>(std::stoul(argv[++i]));
+        } else if (a.rfind("--max-expansions=", 0) == 0) {
+            args.max_expansions =
+                static_cast<size_t>(std::stoul(std::string(a.substr(17))));
         } else if (a == "--max-depth") {
             if (i + 1 >= argc) {
                 std::cerr << "--max-depth requires a depth value\n";
@@ -67,8 +149,126 @@ auto parse_args(int argc, char** argv) -> CmdArgs {
         } else if (a.rfind("--timeout=", 0) == 0) {
             args.timeout =
                 static_cast<float>(std::stof(std::string(a.substr(10))));
+        } else if (a == "--max-memory") {
+            if (i + 1 >= argc) {
+                std::cerr << "--max-memory requires a size in megabytes\n";
+                exit(1);
+            }
+            args.max_memory_mb = static_cast<size_t>(std::stoul(argv[++i]));
+        } else if (a.rfind("--max-memory=", 0) == 0) {
+            args.max_memory_mb =
+                static_cast<size_t>(std::stoul(std::string(a.substr(13))));
+        } else if (a == "--threads") {
+            if (i + 1 >= argc) {
+                std::cerr << "--threads requires a thread count\n";
+                exit(1);
+            }
+            args.n_threads = static_cast<size_t>(std::stoul(argv[++i]));
+        } else if (a.rfind("--threads=", 0) == 0) {
+            args.n_threads =
+                static_cast<size_t>(std::stoul(std::string(a.substr(10))));
         } else if (a == "--with-dfs") {
             args.with_dfs = true;
+        } else if (a == "--solve") {
+            args.solve = true;
+        } else if (a == "--external-bfs") {
+            args.external_bfs = true;
+        } else if (a == "--buffer-mb") {
+            if (i + 1 >= argc) {
+                std::cerr << "--buffer-mb requires a size in megabytes\n";
+                exit(1);
+            }
+            args.buffer_mb = static_cast<size_t>(std::stoul(argv[++i]));
+        } else if (a.rfind("--buffer-mb=", 0) == 0) {
+            args.buffer_mb =
+                static_cast<size_t>(std::stoul(std::string(a.substr(12))));
+        } else if (a == "--solve-dfs") {
+            args.solve_dfs = true;
+        } else if (a == "--tt-mb") {
+            if (i + 1 >= argc) {
+                std::cerr << "--tt-mb requires a size in megabytes\n";
+                exit(1);
+            }
+            args.tt_mb = static_cast<size_t>(std::stoul(argv[++i]));
+        } else if (a.rfind("--tt-mb=", 0) == 0) {
+            args.tt_mb =
+                static_cast<size_t>(std::stoul(std::string(a.substr(8))));
+        } else if (a == "--checkpoint") {
+            if (i + 1 >= argc) {
+                std::cerr << "--checkpoint requires a file path\n";
+                exit(1);
+            }
+            args.checkpoint = std::filesystem::path(argv[++i]);
+        } else if (a.rfind("--checkpoint=", 0) == 0) {
+            args.checkpoint = std::filesystem::path(std::string(a.substr(13)));
+        } else if (a == "--checkpoint-every") {
+            if (i + 1 >= argc) {
+                std::cerr << "--checkpoint-every requires a number of "
+                             "seconds\n";
+                exit(1);
+            }
+            args.checkpoint_every = static_cast<float>(std::stof(argv[++i]));
+        } else if (a.rfind("--checkpoint-every=", 0) == 0) {
+            args.checkpoint_every =
+                static_cast<float>(std::stof(std::string(a.substr(19))));
+        } else if (a == "--resume") {
+            args.resume = true;
+        } else if (a == "--compact-json") {
+            args.compact_json = true;
+        } else if (a == "--packed-tables") {
+            args.packed_tables = true;
+        } else if (a == "--graph-format") {
+            if (i + 1 >= argc) {
+                std::cerr << "--graph-format requires json or bin\n";
+                exit(1);
+            }
+            args.binary_graph = is_binary_graph_format(argv[++i]);
+        } else if (a.rfind("--graph-format=", 0) == 0) {
+            args.binary_graph = is_binary_graph_format(a.substr(15));
+        } else if (a == "--layout") {
+            args.layout = true;
+        } else if (a == "--layout-iterations") {
+            if (i + 1 >= argc) {
+                std::cerr << "--layout-iterations requires an iteration "
+                             "count\n";
+                exit(1);
+            }
+            args.layout_iterations = static_cast<size_t>(std::stoul(argv[++i]));
+        } else if (a.rfind("--layout-iterations=", 0) == 0) {
+            args.layout_iterations =
+                static_cast<size_t>(std::stoul(std::string(a.substr(20))));
+        } else if (a == "--lod") {
+            args.lod = true;
+        } else if (a == "--lod-nodes") {
+            if (i + 1 >= argc) {
+                std::cerr << "--lod-nodes requires a node count\n";
+                exit(1);
+            }
+            args.lod_nodes = static_cast<size_t>(std::stoul(argv[++i]));
+        } else if (a.rfind("--lod-nodes=", 0) == 0) {
+            args.lod_nodes =
+                static_cast<size_t>(std::stoul(std::string(a.substr(12))));
+        } else if (a == "--outcomes") {
+            args.outcomes = true;
+        } else if (a == "--serve") {
+            args.serve = true;
+        } else if (a == "--serve-port") {
+            if (i + 1 >= argc) {
+                std::cerr << "--serve-port requires a port number\n";
+                exit(1);
+            }
+            args.serve_port = static_cast<size_t>(std::stoul(argv[++i]));
+        } else if (a.rfind("--serve-port=", 0) == 0) {
+            args.serve_port =
+                static_cast<size_t>(std::stoul(std::string(a.substr(13))));
+        } else if (a == "--query") {
+            if (i + 1 >= argc) {
+                std::cerr << "--query requires a graph file path\n";
+                exit(1);
+            }
+            args.query_file = std::filesystem::path(argv[++i]);
+        } else if (a.rfind("--query=", 0) == 0) {
+            args.query_file = std::filesystem::path(std::string(a.substr(8)));
         } else if (a.rfind("--", 0) == 0) {
             std::cerr << "Unknown option: " << a << "\n";
             std::cerr << USAGE_MSG;
@@ -77,6 +277,80 @@ auto parse_args(int argc, char** argv) -> CmdArgs {
             positionals.emplace_back(argv[i]);
         }
     }
+    if (args.n_threads == 0) {
+        std::cerr << "--threads must be at least 1\n";
+        exit(1);
+    }
+    if (args.tt_mb == 0) {
+        std::cerr << "--tt-mb must be at least 1\n";
+        exit(1);
+    }
+    if (args.batch_file && (args.deck_file || args.with_dfs)) {
+        std::cerr << "--batch cannot be used with --deck or --with-dfs\n";
+        exit(1);
+    }
+    if (args.external_bfs &&
+        (args.batch_file || args.with_dfs || args.solve || args.solve_dfs)) {
+        std::cerr << "--external-bfs cannot be used with --batch, "
+                     "--with-dfs, --solve or --solve-dfs\n";
+        exit(1);
+    }
+    if (args.buffer_mb == 0) {
+        std::cerr << "--buffer-mb must be at least 1\n";
+        exit(1);
+    }
+    if (args.checkpoint && (args.batch_file || args.external_bfs)) {
+        std::cerr << "--checkpoint cannot be used with --batch or "
+                     "--external-bfs\n";
+        exit(1);
+    }
+    if (args.checkpoint_every <= 0) {
+        std::cerr << "--checkpoint-every must be positive\n";
+        exit(1);
+    }
+    if (args.resume && !args.checkpoint) {
+        std::cerr << "--resume requires --checkpoint\n";
+        exit(1);
+    }
+    if (args.resume &&
+        (args.deck_file || args.with_dfs || args.solve || args.solve_dfs)) {
+        std::cerr << "--resume cannot be used with --deck, --with-dfs, "
+                     "--solve or --solve-dfs\n";
+        exit(1);
+    }
+    if ((args.layout || args.lod || args.outcomes) &&
+        (args.batch_file || args.external_bfs)) {
+        std::cerr << "--layout, --lod and --outcomes cannot be used with "
+                     "--batch or --external-bfs\n";
+        exit(1);
+    }
+    if (args.lod_nodes == 0) {
+        std::cerr << "--lod-nodes must be at least 1\n";
+        exit(1);
+    }
+    if (args.serve && (args.batch_file || args.external_bfs)) {
+        std::cerr << "--serve cannot be used with --batch or "
+                     "--external-bfs\n";
+        exit(1);
+    }
+    if (args.serve_port > UINT16_MAX) {
+        std::cerr << "--serve-port must be at most 65535\n";
+        exit(1);
+    }
+    if (args.query_file &&
+        (args.batch_file || args.external_bfs || args.serve || args.resume)) {
+        std::cerr << "--query cannot be used with --batch, --external-bfs, "
+                     "--serve or --resume\n";
+        exit(1);
+    }
+    if (args.solve && args.solve_dfs) {
+        std::cerr << "--solve and --solve-dfs cannot be used together\n";
+        exit(1);
+    }
+    // Queries are answered from a graph file, with nothing to write.
+    if (args.query_file && positionals.empty()) {
+        return args;
+    }
     if (positionals.empty()) {
         std::cerr << "Missing output directory.\n";
         std::cerr
@@ -92,41 +366,476 @@ auto parse_args(int argc, char** argv) -> CmdArgs {
     return args;
 }
 
-auto make_table(std::optional<std::filesystem::path>& deck_path) -> Table {
+auto make_table(const std::optional<std::filesystem::path>& deck_path)
+    -> Table {
     if (deck_path) {
         return Table(import_deck(*deck_path));
     }
     return make_random_table();
 }
 
+// The memory budget for building one graph, shared between the decks
+// being explored at once in batch mode.
+auto graph_memory_budget(const CmdArgs& args, size_t n_graphs)
+    -> std::optional<size_t> {
+    if (!args.max_memory_mb) {
+        return std::nullopt;
+    }
+    return (*args.max_memory_mb << 20) / n_graphs;
+}
+
+auto print_bfs_report(const Graph& graph, const BfsReport& report) -> void {
+    std::cout << fmt::format(
+        "BFS stopped at depth {} ({}) with {} nodes and {} edges in {:.1f} "
+        "MiB\n",
+        report.m_depth, bfs_stop_to_string(report.m_stop), graph.size(),
+        graph.n_edges(),
+        static_cast<double>(report.m_memory_bytes) / (1024.0 * 1024.0));
+}
+
+auto print_outcomes(const std::vector<NodeOutcome>& outcomes,
+                    size_t elapsed_ms) -> void {
+    std::array<size_t, 3> counts{};
+    for (const auto& outcome : outcomes) {
+        counts[static_cast<size_t>(outcome.m_outcome)]++;
+    }
+    std::cout << fmt::format(
+        "Labelled {} nodes winnable, {} losing and {} unknown in {} "
+        "seconds\n",
+        counts[static_cast<size_t>(Outcome::Winnable)],
+        counts[static_cast<size_t>(Outcome::Losing)],
+        counts[static_cast<size_t>(Outcome::Unknown)],
+        static_cast<double>(elapsed_ms) / 1000.0);
+    const NodeOutcome& start = outcomes[Graph::c_root];
+    if (start.m_outcome == Outcome::Winnable) {
+        std::cout << fmt::format("The start is {} moves from a win\n",
+                                 start.m_win_distance);
+    }
+}
+
+auto run_solver(const CmdArgs& args, const Table& table) -> SolveResult {
+    if (args.solve_dfs) {
+        return solve_depth_first(table, args.tt_mb << 20,
+                                 args.max_expansions, args.timeout);
+    }
+    return solve_best_first(table, args.max_expansions, args.timeout);
+}
+
+auto print_solve_result(const SolveResult& result, size_t elapsed_ms)
+    -> void {
+    std::cout << fmt::format(
+        "Solver {} after expanding {} nodes in {} seconds\n",
+        solve_status_to_string(result.m_status), result.m_expanded,
+        static_cast<double>(elapsed_ms) / 1000.0);
+    if (result.m_status != SolveStatus::Won) {
+        return;
+    }
+    std::cout << fmt::format("Winning line of {} moves:\n",
+                             result.m_moves.size());
+    for (size_t i = 0; i < result.m_moves.size(); i++) {
+        std::cout << fmt::format("{:>4}. {}\n", i + 1,
+                                 result.m_moves[i].to_string());
+    }
+}
+
 constexpr size_t max_depth_default = 5;
 constexpr std::string_view graph_filename = "graph.json";
+constexpr std::string_view binary_graph_filename = "graph.bin";
+constexpr std::string_view batch_filename = "batch.jsonl";
+constexpr std::string_view layers_dirname = "layers";
+
+auto run_external_bfs_mode(const CmdArgs& args, size_t max_depth) -> int {
+    auto work_dir = args.out_dir / layers_dirname;
+    size_t start_time = get_now();
+    auto result = external_bfs(make_table(args.deck_file), work_dir,
+                               max_depth, args.buffer_mb << 20, args.timeout);
+    size_t n_states = 0;
+    for (size_t depth = 0; depth < result.m_layer_sizes.size(); depth++) {
+        std::cout << fmt::format("Depth {:>3}: {} states\n", depth,
+                                 result.m_layer_sizes[depth]);
+        n_states += result.m_layer_sizes[depth];
+    }
+    if (result.m_timed_out) {
+        std::cout << "Timeout reached, the last layer was discarded\n";
+    } else if (result.m_exhausted) {
+        std::cout << "Every reachable state was enumerated\n";
+    }
+    if (result.m_win_depth) {
+        std::cout << fmt::format("First won state at depth {}\n",
+                                 *result.m_win_depth);
+    }
+    std::cout << fmt::format("Enumerated {} states in {} seconds into {}\n",
+                             n_states,
+                             static_cast<double>(get_now() - start_time) /
+                                 1000.0,
+                             work_dir.string());
+    return 0;
+}
+
+// Solves every deck of the corpus with the chosen solver, or explores it
+// with a BFS when no solver is chosen, and writes one JSON record per deck.
+auto run_batch_mode(const CmdArgs& args, size_t max_depth) -> int {
+    std::ifstream corpus_file(*args.batch_file);
+    if (!corpus_file.is_open()) {
+        std::cerr << "Cannot open corpus " << args.batch_file->string()
+                  << "\n";
+        return 1;
+    }
+    std::ofstream out(args.out_dir / batch_filename);
+    if (!out.is_open()) {
+        std::cerr << "Cannot write to " << args.out_dir.string() << "\n";
+        return 1;
+    }
+    bool solve = args.solve || args.solve_dfs;
+    size_t n_threads = args.n_threads;
+    std::optional<size_t> max_expansions;
+    if (args.max_expansions != SIZE_MAX) {
+        max_expansions = args.max_expansions;
+    }
+    auto run_deck = [&](const CorpusDeck& deck) -> nlohmann::json {
+        Table table(deck.m_deck);
+        size_t start_time = get_now();
+        if (solve) {
+            auto result = run_solver(args, table);
+            return {{"status", solve_status_to_string(result.m_status)},
+                    {"expanded", result.m_expanded},
+                    {"generated", result.m_generated},
+                    {"moves", result.m_moves.size()},
+                    {"ms", get_now() - start_time}};
+        }
+        Graph graph(table);
+        auto report = graph.generate_bfs(max_depth, args.timeout, 1,
+                                         graph_memory_budget(args, n_threads),
+                                         max_expansions);
+        return {{"nodes", graph.size()},
+                {"depth", report.m_depth},
+                {"stop", bfs_stop_to_string(report.m_stop)},
+                {"bytes", report.m_memory_bytes},
+                {"ms", get_now() - start_time}};
+    };
+    // A deck that fails, such as one whose graph cannot be allocated, is
+    // recorded as such and the rest of the corpus still runs.
+    auto job = [&](const CorpusDeck& deck) -> nlohmann::json {
+        try {
+            return run_deck(deck);
+        } catch (const std::exception& e) {
+            return {{"error", e.what()}};
+        }
+    };
+    size_t start_time = get_now();
+    CorpusReader corpus(corpus_file);
+    try {
+        size_t n_decks = run_batch(corpus, args.n_threads, job, out);
+        std::cout << fmt::format("Ran {} decks in {} seconds, wrote {}/{}\n",
+                                 n_decks,
+                                 static_cast<double>(get_now() - start_time) /
+                                     1000.0,
+                                 args.out_dir.string(), batch_filename);
+    } catch (const std::exception& e) {
+        std::cerr << e.what() << "\n";
+        return 1;
+    }
+    return 0;
+}
+
+// Raised by SIGINT and SIGTERM so that the BFS stops at the next node and
+// the graph can be checkpointed before exiting.
+static_assert(std::atomic<bool>::is_always_lock_free);
+std::atomic<bool> stop_requested{false};
+std::atomic<int> stop_signal{0};
+
+auto handle_stop_signal(int signal) -> void {
+    stop_signal = signal;
+    stop_requested = true;
+    // A second signal terminates as usual.
+    std::signal(signal, SIG_DFL);
+}
+
+auto wait_for_stop_signal() -> void {
+    while (!stop_requested) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    }
+}
+
+// Answers the queries of `answer_query` about a graph file until
+// interrupted.
+auto run_query_mode(const CmdArgs& args) -> int {
+    size_t start_time = get_now();
+    std::optional<GraphFile> file;
+    try {
+        file.emplace(*args.query_file);
+    } catch (const std::runtime_error& e) {
+        std::cerr << e.what() << "\n";
+        return 1;
+    }
+    GraphQueries queries(*file);
+    std::cout << fmt::format(
+        "Loaded {} nodes and {} edges from {} in {} seconds\n", file->size(),
+        file->n_edges(), args.query_file->string(),
+        static_cast<double>(get_now() - start_time) / 1000.0);
+    std::signal(SIGINT, handle_stop_signal);
+    std::signal(SIGTERM, handle_stop_signal);
+    std::optional<HttpServer> server;
+    try {
+        server.emplace(static_cast<uint16_t>(args.serve_port),
+                       [&queries](const HttpRequest& request,
+                                  HttpConnection& connection) {
+                           return connection.respond(
+                               answer_query(queries, request));
+                       });
+    } catch (const std::runtime_error& e) {
+        std::cerr << e.what() << "\n";
+        return 1;
+    }
+    std::cout << fmt::format(
+        "Answering queries at http://127.0.0.1:{}/ until interrupted\n",
+        server->port());
+    wait_for_stop_signal();
+    return 0;
+}
+
+// Length of the BFS slices between two batches sent to the web app.
+#define SERVE_BATCH_SECONDS 0.1F
+
+// Sends the web app what the BFS added to the graph since the last batch,
+// as a "batch" event holding a `graph_batch_to_string` document. Nodes are
+// coloured by their depth out of the BFS's maximum depth, as the depth the
+// BFS will reach is not known yet.
+class GraphStream {
+   public:
+    GraphStream(const CmdArgs& args, size_t max_depth)
+        : m_server(static_cast<uint16_t>(args.serve_port)),
+          m_max_depth(max_depth),
+          m_options{.m_style = JsonStyle::Compact,
+                    .m_tables = args.packed_tables ? TableEncoding::Packed
+                                                   : TableEncoding::Rendered} {}
+
+    [[nodiscard]] auto port() const -> uint16_t { return m_server.port(); }
+    // Bytes of the batches kept for pages opened later.
+    [[nodiscard]] auto memory_usage() const -> size_t {
+        return m_server.memory_usage();
+    }
+
+    // Sends the new nodes and the edges of the nodes before `end_source`.
+    auto publish(const Graph& graph, NodeId end_source) -> void {
+        GraphBatch batch{.m_first_node = m_n_nodes_sent,
+                         .m_first_source = m_n_sources_sent,
+                         .m_end_source = end_source};
+        if (batch.m_first_node == graph.size() &&
+            batch.m_first_source == end_source) {
+            return;
+        }
+        m_server.publish(
+            "batch",
+            graph_batch_to_string(graph, batch, m_max_depth, m_options));
+        m_n_nodes_sent = static_cast<NodeId>(graph.size());
+        m_n_sources_sent = end_source;
+    }
+
+    // Sends the last batch, with every edge, and how the BFS stopped.
+    auto finish(const Graph& graph, const BfsReport& report) -> void {
+        publish(graph, static_cast<NodeId>(graph.size()));
+        nlohmann::json done = {{"depth", report.m_depth},
+                               {"stop", bfs_stop_to_string(report.m_stop)},
+                               {"nodes", graph.size()},
+                               {"edges", graph.n_edges()}};
+        m_server.publish("done", done.dump());
+    }
+
+   private:
+    EventServer m_server;
+    size_t m_max_depth;
+    JsonOptions m_options;
+    NodeId m_n_nodes_sent{0};
+    NodeId m_n_sources_sent{0};
+};
+
+// Runs the BFS. With a checkpoint file or a stream, the BFS runs in
+// slices, until it stops for any reason other than a slice ending. Each
+// slice is sent to the stream, and the graph is checkpointed every
+// `checkpoint_every` seconds and when the BFS stops. The batches the
+// stream keeps come out of `max_memory`, so the graph gets what they leave
+// at the start of each slice.
+auto explore(Graph& graph, const CmdArgs& args, size_t max_depth,
+             std::optional<size_t> max_memory, GraphStream* stream)
+    -> BfsReport {
+    if (!args.checkpoint && stream == nullptr) {
+        return graph.generate_bfs(max_depth, args.timeout, args.n_threads,
+                                  max_memory);
+    }
+    float slice_length =
+        stream != nullptr ? SERVE_BATCH_SECONDS : args.checkpoint_every;
+    size_t start_time = get_now();
+    size_t last_checkpoint = start_time;
+    while (true) {
+        float slice = slice_length;
+        bool last_slice = false;
+        if (args.timeout) {
+            float remaining =
+                *args.timeout -
+                static_cast<float>(get_now() - start_time) / 1000.0F;
+            if (remaining <= slice) {
+                slice = std::max(remaining, 0.0F);
+                last_slice = true;
+            }
+        }
+        std::optional<size_t> graph_memory = max_memory;
+        if (stream != nullptr && max_memory) {
+            *graph_memory -= std::min(*max_memory, stream->memory_usage());
+        }
+        auto report =
+            graph.generate_bfs(max_depth, slice, args.n_threads, graph_memory);
+        bool stopped = report.m_stop != BfsStop::Timeout || last_slice;
+        if (stream != nullptr) {
+            stream->publish(graph, graph.frontier_begin());
+        }
+        if (args.checkpoint &&
+            (stopped || static_cast<float>(get_now() - last_checkpoint) >=
+                            args.checkpoint_every * 1000.0F)) {
+            size_t checkpoint_start = get_now();
+            write_checkpoint(graph, *args.checkpoint);
+            std::cout << fmt::format(
+                "Checkpointed {} nodes, {} left to expand, to {} in {} "
+                "seconds\n",
+                graph.size(), graph.size() - graph.frontier_begin(),
+                args.checkpoint->string(),
+                static_cast<double>(get_now() - checkpoint_start) / 1000.0);
+            last_checkpoint = get_now();
+        }
+        if (stopped) {
+            return report;
+        }
+    }
+}
+
+auto load_graph(const CmdArgs& args) -> Graph {
+    if (!args.resume) {
+        return Graph(make_table(args.deck_file));
+    }
+    std::optional<Graph> graph;
+    try {
+        graph.emplace(read_checkpoint(*args.checkpoint));
+    } catch (const std::runtime_error& e) {
+        std::cerr << e.what() << "\n";
+        exit(1);
+    }
+    std::cout << fmt::format("Resumed {} nodes, {} left to expand, from {}\n",
+                             graph->size(),
+                             graph->size() - graph->frontier_begin(),
+                             args.checkpoint->string());
+    return std::move(*graph);
+}
 
 auto main(int argc, char* argv[]) -> int {
     auto parsed = parse_args(argc, argv);
+    if (parsed.query_file) {
+        return run_query_mode(parsed);
+    }
     size_t max_depth =
         parsed.max_depth.value_or(static_cast<size_t>(max_depth_default));
     std::cout << "Max depth: " << max_depth << "\n";
-    auto graph = Graph(make_table(parsed.deck_file));
+    if (parsed.batch_file) {
+        return run_batch_mode(parsed, max_depth);
+    }
+    if (parsed.external_bfs) {
+        return run_external_bfs_mode(parsed, max_depth);
+    }
     size_t start_time = get_now();
-    size_t generated_depth = 0;
-    if (parsed.with_dfs) {
+    auto graph = load_graph(parsed);
+    auto max_memory = graph_memory_budget(parsed, 1);
+    // The BFS continues from every node added before it, which expands
+    // around the solver's line or the DFS path.
+    if (parsed.solve || parsed.solve_dfs) {
+        auto result = run_solver(parsed, graph.table(Graph::c_root));
+        print_solve_result(result, get_now() - start_time);
+        graph.add_path(result.m_moves);
+    } else if (parsed.with_dfs) {
         graph.generate_dfs();
         std::cout << "Completed DFS generation\n";
-        generated_depth =
-            graph.generate_bfs_on_existing(max_depth, parsed.timeout);
-    } else {
-        generated_depth = graph.generate_bfs(max_depth, parsed.timeout);
+    }
+    std::optional<GraphStream> stream;
+    if (parsed.serve) {
+        try {
+            stream.emplace(parsed, max_depth);
+        } catch (const std::runtime_error& e) {
+            std::cerr << e.what() << "\n";
+            return 1;
+        }
+        std::cout << fmt::format(
+            "Streaming the graph at http://127.0.0.1:{}/events\n",
+            stream->port());
+        stream->publish(graph, graph.frontier_begin());
+    }
+    graph.set_interrupt_flag(&stop_requested);
+    std::signal(SIGINT, handle_stop_signal);
+    std::signal(SIGTERM, handle_stop_signal);
+    auto report = explore(graph, parsed, max_depth, max_memory,
+                          stream ? &*stream : nullptr);
+    print_bfs_report(graph, report);
+    if (report.m_stop == BfsStop::Interrupted) {
+        return 128 + stop_signal;
+    }
+    if (stream) {
+        stream->finish(graph, report);
     }
     std::cout << "Generated graph in "
               << static_cast<double>(get_now() - start_time) / 1000.0
               << " seconds\n";
+    std::vector<Point> positions;
+    if (parsed.layout) {
+        start_time = get_now();
+        positions = compute_layout(
+            graph, LayoutOptions{.m_iterations = parsed.layout_iterations,
+                                 .m_n_threads = parsed.n_threads});
+        std::cout << "Laid out graph in "
+                  << static_cast<double>(get_now() - start_time) / 1000.0
+                  << " seconds\n";
+    }
+    // Graphs small enough to show whole have no clusters.
+    std::vector<std::vector<uint32_t>> clusters;
+    if (parsed.lod) {
+        clusters = coarsen_graph(graph, parsed.lod_nodes).m_clusters;
+        std::cout << fmt::format("Clustered graph into {} levels\n",
+                                 clusters.size());
+    }
+    std::vector<NodeOutcome> outcomes;
+    if (parsed.outcomes) {
+        start_time = get_now();
+        outcomes = label_outcomes(graph, parsed.n_threads);
+        print_outcomes(outcomes, get_now() - start_time);
+    }
     start_time = get_now();
-    write_graph_to_file(graph, parsed.out_dir / graph_filename,
-                        generated_depth + 1);
+    auto filename = parsed.binary_graph ? binary_graph_filename
+                                        : graph_filename;
+    if (parsed.binary_graph) {
+        write_graph_to_binary_file(graph, parsed.out_dir / filename,
+                                   report.m_depth + 1, positions, clusters,
+                                   outcomes);
+    } else {
+        JsonOptions options{
+            .m_style = parsed.compact_json ? JsonStyle::Compact
+                                           : JsonStyle::Pretty,
+            .m_tables = parsed.packed_tables ? TableEncoding::Packed
+                                             : TableEncoding::Rendered,
+            .m_positions = positions,
+            .m_clusters = clusters,
+            .m_outcomes = outcomes};
+        write_graph_to_file(graph, parsed.out_dir / filename,
+                            report.m_depth + 1, options);
+    }
+    // The web app loads graph.bin in preference to graph.json, so a graph
+    // left over in the other format would hide this one or be stale.
+    std::filesystem::remove(parsed.out_dir / (parsed.binary_graph
+                                                  ? graph_filename
+                                                  : binary_graph_filename));
     std::cout << fmt::format("Wrote {}/{} in ", parsed.out_dir.string(),
-                             graph_filename)
+                             filename)
               << static_cast<double>(get_now() - start_time) / 1000.0
               << " seconds\n";
+    if (stream) {
+        // Pages opened later are sent the whole graph too.
+        std::cout << "Serving the graph until interrupted\n";
+        wait_for_stop_signal();
+    }
     return 0;
 }
@@ -3,12 +3,14 @@
 #include <sys/types.h>
 
 #include <algorithm>
-#include <iterator>
+#include <bit>
 #include <optional>
 #include <string>
-#include <vector>
+#include <type_traits>
 
 #include "common.hpp"
+#include "legality.hpp"
+#include "stack_table.hpp"
 #include "table.hpp"
 
 [[nodiscard]] auto move_type_to_string(MoveType move_type) -> std::string {
@@ -31,24 +33,23 @@
 }
 
 auto Move::to_string() const -> std::string {
-    std::string move_type_str = move_type_to_string(m_type);
-    switch (m_type) {
+    std::string move_type_str = move_type_to_string(type());
+    switch (type()) {
         case MoveType::StockToWaste:
         case MoveType::WasteToFoundation:
             return move_type_str;
         case MoveType::WasteToTableau:
-            return move_type_str + " " + std::to_string(mv.wt.m_to_col);
+            return move_type_str + " " + std::to_string(to_col());
         case MoveType::TableauToFoundation:
-            return move_type_str + " " + std::to_string(mv.tf.m_from_col);
+            return move_type_str + " " + std::to_string(from_col());
         case MoveType::TableauToTableau:
-            return move_type_str + " " + std::to_string(mv.tt.m_from_col) +
-                   " " + std::to_string(mv.tt.m_to_col) + " " +
-                   std::to_string(mv.tt.m_n_cards);
+            return move_type_str + " " + std::to_string(from_col()) + " " +
+                   std::to_string(to_col()) + " " + std::to_string(n_cards());
         case MoveType::FoundationToTableau:
             return move_type_str + " " +
                    std::string{
-                       c_suit_strings[static_cast<size_t>(mv.ft.m_from_suit)]} +
-                   " " + std::to_string(mv.ft.m_to_col);
+                       c_suit_strings[static_cast<size_t>(from_suit())]} +
+                   " " + std::to_string(to_col());
         default:
             throw std::invalid_argument("Invalid move type");
     }
@@ -56,25 +57,25 @@ auto Move::to_string() const -> std::string {
 
 auto Move::to_json() const -> nlohmann::json {
     nlohmann::json j;
-    j["type"] = move_type_to_string(m_type);
-    switch (m_type) {
+    j["type"] = move_type_to_string(type());
+    switch (type()) {
         case MoveType::StockToWaste:
         case MoveType::WasteToFoundation:
             break;
         case MoveType::WasteToTableau:
-            j["to_col"] = mv.wt.m_to_col;
+            j["to_col"] = to_col();
             break;
         case MoveType::TableauToFoundation:
-            j["from_col"] = mv.tf.m_from_col;
+            j["from_col"] = from_col();
             break;
         case MoveType::TableauToTableau:
-            j["from_col"] = mv.tt.m_from_col;
-            j["to_col"] = mv.tt.m_to_col;
-            j["n_cards"] = mv.tt.m_n_cards;
+            j["from_col"] = from_col();
+            j["to_col"] = to_col();
+            j["n_cards"] = n_cards();
             break;
         case MoveType::FoundationToTableau:
-            j["from_suit"] = static_cast<uint8_t>(mv.ft.m_from_suit);
-            j["to_col"] = mv.ft.m_to_col;
+            j["from_suit"] = static_cast<uint8_t>(from_suit());
+            j["to_col"] = to_col();
             break;
         default:
             throw std::invalid_argument("Invalid move type");
@@ -83,194 +84,267 @@ auto Move::to_json() const -> nlohmann::json {
 }
 
 auto Move::is_opposite(const Move& other) const -> bool {
-    switch (m_type) {
+    switch (type()) {
         case MoveType::StockToWaste:
         case MoveType::WasteToFoundation:
         case MoveType::WasteToTableau:
             return false;
         case MoveType::TableauToFoundation:
-            return other.m_type == MoveType::FoundationToTableau &&
-                   mv.tf.m_from_col == other.mv.ft.m_to_col;
+            return other.type() == MoveType::FoundationToTableau &&
+                   from_col() == other.to_col();
         case MoveType::TableauToTableau:
-            return other.m_type == MoveType::TableauToTableau &&
-                   mv.tt.m_from_col == other.mv.tt.m_to_col &&
-                   mv.tt.m_to_col == other.mv.tt.m_from_col &&
-                   mv.tt.m_n_cards == other.mv.tt.m_n_cards;
+            return other.type() == MoveType::TableauToTableau &&
+                   from_col() == other.to_col() &&
+                   to_col() == other.from_col() &&
+                   n_cards() == other.n_cards();
         case MoveType::FoundationToTableau:
-            return other.m_type == MoveType::TableauToFoundation &&
-                   mv.ft.m_to_col == other.mv.tf.m_from_col;
+            return other.type() == MoveType::TableauToFoundation &&
+                   to_col() == other.from_col();
         default:
             throw std::invalid_argument("Invalid move type");
     }
 }
 
-auto Move::operator==(const Move& other) const -> bool {
-    if (m_type != other.m_type) {
-        return false;
-    }
-    switch (m_type) {
-        case MoveType::StockToWaste:
-        case MoveType::WasteToFoundation:
-            return true;
-        case MoveType::WasteToTableau:
-            return mv.wt.m_to_col == other.mv.wt.m_to_col;
-        case MoveType::TableauToFoundation:
-            return mv.tf.m_from_col == other.mv.tf.m_from_col;
-        case MoveType::TableauToTableau:
-            return mv.tt.m_from_col == other.mv.tt.m_from_col &&
-                   mv.tt.m_to_col == other.mv.tt.m_to_col &&
-                   mv.tt.m_n_cards == other.mv.tt.m_n_cards;
-        case MoveType::FoundationToTableau:
-            return mv.ft.m_from_suit == other.mv.ft.m_from_suit &&
-                   mv.ft.m_to_col == other.mv.ft.m_to_col;
-        default:
-            throw std::invalid_argument("Invalid move type");
-    }
-}
-
-auto Move::create_stock_to_waste() -> Move {
-    return Move{.m_type = MoveType::StockToWaste, .mv = {}};
-}
-
-auto Move::create_waste_to_foundation() -> Move {
-    return Move{.m_type = MoveType::WasteToFoundation, .mv = {}};
-}
-
-auto Move::create_waste_to_tableau(size_t to_col) -> Move {
-    return Move{.m_type = MoveType::WasteToTableau, .mv = {.wt = {to_col}}};
-}
-
-auto Move::create_tableau_to_foundation(size_t from_col) -> Move {
-    return Move{.m_type = MoveType::TableauToFoundation,
-                .mv = {.tf = {from_col}}};
-}
-
-auto Move::create_tableau_to_tableau(size_t from_col, size_t to_col,
-                                     size_t n_cards) -> Move {
-    return Move{.m_type = MoveType::TableauToTableau,
-                .mv = {.tt = {.m_from_col = from_col,
-                              .m_to_col = to_col,
-                              .m_n_cards = n_cards}}};
-}
-
-auto Move::create_foundation_to_tableau(Suit from_suit, size_t to_col) -> Move {
-    return Move{.m_type = MoveType::FoundationToTableau,
-                .mv = {.ft = {.m_from_suit = from_suit, .m_to_col = to_col}}};
-}
-
-auto generate_basic_moves(const Table& table, std::vector<Move>& moves)
-    -> void {
+template <typename TableT>
+auto generate_basic_moves(const TableT& table, MoveList& moves) -> void {
     // Stock to Waste
-    if (table.m_stock_index != c_null_index ||
-        table.m_waste_index != c_null_index) {
+    if (table.stock_top() != c_null_index ||
+        table.waste_top() != c_null_index) {
         moves.push_back(Move::create_stock_to_waste());
     }
     // Waste to Foundation
-    if (table.m_waste_index != c_null_index &&
-        table.can_be_placed_on_foundation(table.m_waste_index)) {
+    if (table.waste_top() != c_null_index &&
+        table.can_be_placed_on_foundation(table.waste_top())) {
         moves.push_back(Move::create_waste_to_foundation());
     }
 }
 
-auto generate_waste_to_tableau_moves(const Table& table,
-                                     std::vector<Move>& moves) -> void {
-    if (table.m_waste_index != c_null_index) {
-        for (size_t to_col = 0; to_col < c_tableau_columns; to_col++) {
-            if (table.can_be_placed_on_tableau(to_col, table.m_waste_index)) {
-                moves.push_back(Move::create_waste_to_tableau(to_col));
-            }
-        }
+template <typename TableT>
+auto generate_waste_to_tableau_moves(const TableT& table,
+                                     const TableauTops& tops, MoveList& moves)
+    -> void {
+    if (table.waste_top() == c_null_index) {
+        return;
+    }
+    for (unsigned targets = tableau_targets(tops, table.waste_top());
+         targets != 0; targets &= targets - 1) {
+        moves.push_back(Move::create_waste_to_tableau(
+            static_cast<size_t>(std::countr_zero(targets))));
     }
 }
 
-auto generate_tableau_to_foundation_moves(const Table& table,
-                                          std::vector<Move>& moves) -> void {
+template <typename TableT>
+auto generate_tableau_to_foundation_moves(const TableT& table,
+                                          MoveList& moves) -> void {
     for (size_t from_col = 0; from_col < c_tableau_columns; from_col++) {
-        if (table.n_cards_in_visible_tableau_column(from_col) >= 1) {
-            uint8_t tableau_top = table.m_tableau_visible_indices[from_col];
-            if (table.can_be_placed_on_foundation(tableau_top)) {
-                moves.push_back(Move::create_tableau_to_foundation(from_col));
-            }
+        uint8_t tableau_top = table.visible_top(from_col);
+        if (tableau_top != c_null_index &&
+            table.can_be_placed_on_foundation(tableau_top)) {
+            moves.push_back(Move::create_tableau_to_foundation(from_col));
         }
     }
 }
 
-auto generate_tableau_to_tableau_moves(const Table& table,
-                                       std::vector<Move>& moves) -> void {
+template <typename TableT>
+auto generate_tableau_to_tableau_moves(const TableT& table,
+                                       const TableauTops& tops,
+                                       MoveList& moves) -> void {
     for (size_t from_col = 0; from_col < c_tableau_columns; from_col++) {
-        if (table.m_tableau_visible_indices[from_col] == c_null_index) {
+        uint8_t moving_card = table.visible_top(from_col);
+        if (moving_card == c_null_index) {
             continue;
         }
-        auto [_, rank] = index_to_card(
-            static_cast<size_t>(table.m_tableau_visible_indices[from_col]));
+        auto [_, rank] = index_to_card(static_cast<size_t>(moving_card));
         if (rank == 0) {
             continue;
         }
-        size_t n_visible = table.n_cards_in_visible_tableau_column(from_col);
-        for (size_t n_cards = 1; n_cards <= n_visible; n_cards++) {
-            uint8_t moving_top = table.m_tableau_visible_indices[from_col];
-            uint8_t moving_card = moving_top;
-            for (size_t i = 1; i < n_cards; i++) {
-                moving_card = table.m_deck[moving_card];
-            }
-            for (size_t to_col = 0; to_col < c_tableau_columns; to_col++) {
-                if (to_col == from_col) {
-                    continue;
-                }
-                if (table.can_be_placed_on_tableau(to_col, moving_card)) {
-                    moves.push_back(Move::create_tableau_to_tableau(
-                        from_col, to_col, n_cards));
-                }
+        // Walk down the visible run once; the n-th card is the bottom of
+        // the n-card stack that would move.
+        unsigned other_columns = ~(1U << from_col);
+        size_t n_cards = 1;
+        for (uint8_t card : table.visible_run(from_col)) {
+            for (unsigned targets = tableau_targets(tops, card) & other_columns;
+                 targets != 0; targets &= targets - 1) {
+                moves.push_back(Move::create_tableau_to_tableau(
+                    from_col, static_cast<size_t>(std::countr_zero(targets)),
+                    n_cards));
             }
+            n_cards++;
         }
     }
 }
 
-auto filter_opposite_moves(std::vector<Move>& moves,
-                           std::vector<Move>& filtered_moves,
-                           const Move& prev_move) -> void {
-    filtered_moves.reserve(8);
-    std::ranges::copy_if(
-        moves.begin(), moves.end(), std::back_inserter(filtered_moves),
-        [&prev_move](Move& m) -> bool { return !prev_move.is_opposite(m); });
-}
-
-auto generate_moves(const Table& table, std::optional<Move> prev_move)
-    -> std::vector<Move> {
-    std::vector<Move> moves;
-    moves.reserve(8);
+template <typename TableT>
+auto generate_moves(const TableT& table, std::optional<Move> prev_move)
+    -> MoveList {
+    MoveList moves;
+    TableauTops tops = tableau_tops(table);
     generate_basic_moves(table, moves);
-    generate_waste_to_tableau_moves(table, moves);
+    generate_waste_to_tableau_moves(table, tops, moves);
     generate_tableau_to_foundation_moves(table, moves);
-    generate_tableau_to_tableau_moves(table, moves);
-    if (!prev_move) {
-        return moves;
+    generate_tableau_to_tableau_moves(table, tops, moves);
+    if (prev_move) {
+        moves.erase_if(
+            [&prev_move](const Move& m) { return prev_move->is_opposite(m); });
     }
-    std::vector<Move> filtered_moves;
-    filter_opposite_moves(moves, filtered_moves, *prev_move);
-    return filtered_moves;
+    return moves;
 }
 
-auto apply_move(Table& table, const Move& move) -> Table& {
-    switch (move.m_type) {
+template <typename TableT>
+auto apply_move(TableT& table, const Move& move) -> UndoRecord {
+    UndoRecord undo{.m_move = move};
+    switch (move.type()) {
         case MoveType::StockToWaste:
-            return stock_to_waste(table);
+            undo.m_turned_over = table.stock_top() == c_null_index;
+            stock_to_waste(table);
+            break;
         case MoveType::WasteToFoundation:
-            return waste_to_foundation(table);
+            undo.m_suit =
+                index_to_card(static_cast<size_t>(table.waste_top())).first;
+            waste_to_foundation(table);
+            break;
         case MoveType::WasteToTableau:
-            return waste_to_tableau(table, move.mv.wt.m_to_col);
+            waste_to_tableau(table, move.to_col());
+            break;
+        case MoveType::TableauToFoundation: {
+            uint8_t hidden_top = table.hidden_top(move.from_col());
+            uint8_t card = table.visible_top(move.from_col());
+            undo.m_suit = index_to_card(static_cast<size_t>(card)).first;
+            tableau_to_foundation(table, move.from_col());
+            undo.m_turned_over =
+                table.hidden_top(move.from_col()) != hidden_top;
+            break;
+        }
+        case MoveType::TableauToTableau: {
+            uint8_t hidden_top = table.hidden_top(move.from_col());
+            tableau_to_tableau(table, move.from_col(), move.to_col(),
+                               move.n_cards());
+            undo.m_turned_over =
+                table.hidden_top(move.from_col()) != hidden_top;
+            break;
+        }
+        case MoveType::FoundationToTableau:
+            foundation_to_tableau(table, move.from_suit(), move.to_col());
+            break;
+        default:
+            throw std::invalid_argument("Invalid move type");
+    }
+    if constexpr (std::is_same_v<TableT, Table>) {
+        // Catch any link changed without updating the incremental hash.
+        assert(table.hash() == table.full_hash());
+    }
+    return undo;
+}
+
+template auto generate_moves(const Table& table,
+                             std::optional<Move> prev_move) -> MoveList;
+template auto generate_moves(const StackTable& table,
+                             std::optional<Move> prev_move) -> MoveList;
+template auto apply_move(Table& table, const Move& move) -> UndoRecord;
+template auto apply_move(StackTable& table, const Move& move) -> UndoRecord;
+
+auto undo_move(Table& table, const UndoRecord& undo) -> Table& {
+    const Move& move = undo.m_move;
+    auto suit = static_cast<size_t>(undo.m_suit);
+    switch (move.type()) {
+        case MoveType::StockToWaste:
+            if (undo.m_turned_over) {
+                table.restore_waste_from_stock();
+            } else {
+                table.move_from_waste_to_stock();
+            }
+            break;
+        case MoveType::WasteToFoundation: {
+            uint8_t card = table.m_foundation_indices[suit];
+            table.set_foundation(suit, table.m_deck[card]);
+            table.set_next(card, table.m_waste_index);
+            table.set_waste(card);
+            break;
+        }
+        case MoveType::WasteToTableau: {
+            uint8_t card = table.m_tableau_visible_indices[move.to_col()];
+            table.set_visible(move.to_col(), table.m_deck[card]);
+            table.set_next(card, table.m_waste_index);
+            table.set_waste(card);
+            break;
+        }
+        case MoveType::TableauToFoundation: {
+            if (undo.m_turned_over) {
+                table.move_from_visible_to_hidden(move.from_col());
+            }
+            uint8_t card = table.m_foundation_indices[suit];
+            table.set_foundation(suit, table.m_deck[card]);
+            table.set_next(card,
+                           table.m_tableau_visible_indices[move.from_col()]);
+            table.set_visible(move.from_col(), card);
+            break;
+        }
+        case MoveType::TableauToTableau: {
+            if (undo.m_turned_over) {
+                table.move_from_visible_to_hidden(move.from_col());
+            }
+            uint8_t moving_top = table.m_tableau_visible_indices[move.to_col()];
+            uint8_t moving_bottom = moving_top;
+            for (size_t i = 1; i < move.n_cards(); i++) {
+                moving_bottom = table.m_deck[moving_bottom];
+            }
+            table.set_visible(move.to_col(), table.m_deck[moving_bottom]);
+            table.set_next(moving_bottom,
+                           table.m_tableau_visible_indices[move.from_col()]);
+            table.set_visible(move.from_col(), moving_top);
+            break;
+        }
+        case MoveType::FoundationToTableau: {
+            auto from_suit = static_cast<size_t>(move.from_suit());
+            uint8_t card = table.m_tableau_visible_indices[move.to_col()];
+            table.set_visible(move.to_col(), table.m_deck[card]);
+            table.set_next(card, table.m_foundation_indices[from_suit]);
+            table.set_foundation(from_suit, card);
+            break;
+        }
+        default:
+            throw std::invalid_argument("Invalid move type");
+    }
+    assert(table.hash() == table.full_hash());
+    return table;
+}
+
+auto undo_move(StackTable& table, const UndoRecord& undo) -> StackTable& {
+    const Move& move = undo.m_move;
+    switch (move.type()) {
+        case MoveType::StockToWaste:
+            if (undo.m_turned_over) {
+                table.restore_waste_from_stock();
+            } else {
+                table.return_to_stock();
+            }
+            break;
+        case MoveType::WasteToFoundation:
+            table.push_waste(table.pop_foundation(undo.m_suit));
+            break;
+        case MoveType::WasteToTableau:
+            table.push_waste(table.pop_visible(move.to_col()));
+            break;
         case MoveType::TableauToFoundation:
-            return tableau_to_foundation(table, move.mv.tf.m_from_col);
+            if (undo.m_turned_over) {
+                table.hide_visible(move.from_col());
+            }
+            table.push_visible(move.from_col(),
+                               table.pop_foundation(undo.m_suit));
+            break;
         case MoveType::TableauToTableau:
-            return tableau_to_tableau(table, move.mv.tt.m_from_col,
-                                      move.mv.tt.m_to_col,
-                                      move.mv.tt.m_n_cards);
+            if (undo.m_turned_over) {
+                table.hide_visible(move.from_col());
+            }
+            table.move_run(move.to_col(), move.from_col(), move.n_cards());
+            break;
         case MoveType::FoundationToTableau:
-            return foundation_to_tableau(table, move.mv.ft.m_from_suit,
-                                         move.mv.ft.m_to_col);
+            table.push_foundation(table.pop_visible(move.to_col()));
+            break;
         default:
             throw std::invalid_argument("Invalid move type");
     }
+    return table;
 }
 
 auto stock_to_waste(Table& table) -> Table& {
@@ -289,10 +363,9 @@ auto waste_to_foundation(Table& table) -> Table& {
     auto [suit, _] = index_to_card(static_cast<size_t>(waste_top));
     uint8_t foundation_top =
         table.m_foundation_indices[static_cast<size_t>(suit)];
-    table.m_waste_index = table.m_deck[static_cast<size_t>(waste_top)];
-    table.m_deck[static_cast<size_t>(waste_top)] =
-        table.m_foundation_indices[foundation_top];
-    table.m_foundation_indices[static_cast<size_t>(suit)] = waste_top;
+    table.set_waste(table.m_deck[static_cast<size_t>(waste_top)]);
+    table.set_next(waste_top, foundation_top);
+    table.set_foundation(static_cast<size_t>(suit), waste_top);
     return table;
 }
 
@@ -300,7 +373,7 @@ auto waste_to_tableau(Table& table, size_t to_col) -> Table& {
     assert(table.m_waste_index != c_null_index);
     assert(table.can_be_placed_on_tableau(to_col, table.m_waste_index));
     uint8_t waste_top = table.m_waste_index;
-    table.m_waste_index = table.m_deck[static_cast<size_t>(waste_top)];
+    table.set_waste(table.m_deck[static_cast<size_t>(waste_top)]);
     table.add_to_visible_tableau_column(to_col, waste_top);
     return table;
 }
@@ -313,14 +386,12 @@ auto tableau_to_foundation(Table& table, size_t from_col) -> Table& {
     auto [suit, _] = index_to_card(static_cast<size_t>(tableau_top));
     uint8_t foundation_top =
         table.m_foundation_indices[static_cast<size_t>(suit)];
-    table.m_tableau_visible_indices[from_col] =
-        table.m_deck[static_cast<size_t>(tableau_top)];
+    table.set_visible(from_col, table.m_deck[static_cast<size_t>(tableau_top)]);
     if (table.m_tableau_visible_indices[from_col] == c_null_index) {
         table.move_from_hidden_to_visible(from_col);
     }
-    table.m_deck[static_cast<size_t>(tableau_top)] =
-        table.m_foundation_indices[foundation_top];
-    table.m_foundation_indices[static_cast<size_t>(suit)] = tableau_top;
+    table.set_next(tableau_top, foundation_top);
+    table.set_foundation(static_cast<size_t>(suit), tableau_top);
     return table;
 }
 
@@ -335,12 +406,12 @@ auto tableau_to_tableau(Table& table, size_t from_col, size_t to_col,
         moving_bottom = table.m_deck[moving_bottom];
     }
     uint8_t new_from_top = table.m_deck[moving_bottom];
-    table.m_tableau_visible_indices[from_col] = new_from_top;
+    table.set_visible(from_col, new_from_top);
     if (table.m_tableau_visible_indices[from_col] == c_null_index) {
         table.move_from_hidden_to_visible(from_col);
     }
-    table.m_deck[moving_bottom] = table.m_tableau_visible_indices[to_col];
-    table.m_tableau_visible_indices[to_col] = moving_top;
+    table.set_next(moving_bottom, table.m_tableau_visible_indices[to_col]);
+    table.set_visible(to_col, moving_top);
     return table;
 }
 
@@ -351,8 +422,58 @@ auto foundation_to_tableau(Table& table, Suit from_suit, size_t to_col)
         table.m_foundation_indices[static_cast<size_t>(from_suit)];
     assert(foundation_top != c_null_index);
     assert(table.can_be_placed_on_tableau(to_col, foundation_top));
-    table.m_foundation_indices[static_cast<size_t>(from_suit)] =
-        table.m_deck[static_cast<size_t>(foundation_top)];
+    table.set_foundation(static_cast<size_t>(from_suit),
+                         table.m_deck[static_cast<size_t>(foundation_top)]);
     table.add_to_visible_tableau_column(to_col, foundation_top);
     return table;
 }
+
+auto stock_to_waste(StackTable& table) -> StackTable& {
+    if (table.stock_top() == c_null_index) {
+        table.reset_stock_from_waste();
+        return table;
+    }
+    table.draw_from_stock();
+    return table;
+}
+
+auto waste_to_foundation(StackTable& table) -> StackTable& {
+    assert(table.waste_top() != c_null_index);
+    assert(table.can_be_placed_on_foundation(table.waste_top()));
+    table.push_foundation(table.pop_waste());
+    return table;
+}
+
+auto waste_to_tableau(StackTable& table, size_t to_col) -> StackTable& {
+    assert(table.waste_top() != c_null_index);
+    assert(table.can_be_placed_on_tableau(to_col, table.waste_top()));
+    table.push_visible(to_col, table.pop_waste());
+    return table;
+}
+
+auto tableau_to_foundation(StackTable& table, size_t from_col)
+    -> StackTable& {
+    assert(from_col < c_tableau_columns);
+    assert(table.can_be_placed_on_foundation(table.visible_top(from_col)));
+    table.push_foundation(table.pop_visible(from_col));
+    table.reveal_hidden(from_col);
+    return table;
+}
+
+auto tableau_to_tableau(StackTable& table, size_t from_col, size_t to_col,
+                        size_t n_cards) -> StackTable& {
+    assert(from_col < c_tableau_columns);
+    assert(to_col < c_tableau_columns);
+    table.move_run(from_col, to_col, n_cards);
+    table.reveal_hidden(from_col);
+    return table;
+}
+
+auto foundation_to_tableau(StackTable& table, Suit from_suit, size_t to_col)
+    -> StackTable& {
+    assert(to_col < c_tableau_columns);
+    assert(table.can_be_placed_on_tableau(
+        to_col, table.foundation_top(static_cast<size_t>(from_suit))));
+    table.push_visible(to_col, table.pop_foundation(from_suit));
+    return table;
+}
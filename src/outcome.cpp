@@ -0,0 +1,182 @@
+#include "outcome.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <numeric>
+#include <span>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+#include "parallel.hpp"
+
+// Nodes per thread below which a pass runs on one thread.
+#define OUTCOME_MIN_NODES_PER_THREAD 4096
+
+auto outcome_to_string(Outcome outcome) -> std::string_view {
+    switch (outcome) {
+        case Outcome::Unknown:
+            return "unknown";
+        case Outcome::Winnable:
+            return "winnable";
+        case Outcome::Losing:
+            return "losing";
+    }
+    throw std::invalid_argument("Invalid outcome");
+}
+
+// The edges into each node in CSR form, by source.
+struct ReverseEdges {
+    std::vector<uint32_t> m_offsets;
+    std::vector<NodeId> m_sources;
+
+    [[nodiscard]] auto sources(NodeId id) const -> std::span<const NodeId> {
+        return {m_sources.data() + m_offsets[id],
+                m_offsets[id + 1] - m_offsets[id]};
+    }
+};
+
+auto chunks_for(size_t n_nodes, size_t n_threads) -> size_t {
+    return std::clamp<size_t>(n_nodes / OUTCOME_MIN_NODES_PER_THREAD, 1,
+                              n_threads);
+}
+
+// The sources of the edges into a node are in an order that depends on
+// the threads.
+auto reverse_edges(const Graph& graph, size_t n_threads) -> ReverseEdges {
+    size_t n = graph.size();
+    size_t n_chunks = chunks_for(n, n_threads);
+    ReverseEdges reverse{.m_offsets = std::vector<uint32_t>(n + 1, 0),
+                         .m_sources = {}};
+    parallel_chunks(n, n_chunks, [&](size_t begin, size_t end, size_t) {
+        for (size_t from = begin; from < end; from++) {
+            for (const auto& edge : graph.edges(static_cast<NodeId>(from))) {
+                std::atomic_ref(reverse.m_offsets[edge.m_to + 1])
+                    .fetch_add(1, std::memory_order_relaxed);
+            }
+        }
+    });
+    std::partial_sum(reverse.m_offsets.begin(), reverse.m_offsets.end(),
+                     reverse.m_offsets.begin());
+    reverse.m_sources.resize(reverse.m_offsets.back());
+    std::vector<uint32_t> next(reverse.m_offsets.begin(),
+                               reverse.m_offsets.end() - 1);
+    parallel_chunks(n, n_chunks, [&](size_t begin, size_t end, size_t) {
+        for (size_t from = begin; from < end; from++) {
+            for (const auto& edge : graph.edges(static_cast<NodeId>(from))) {
+                uint32_t slot = std::atomic_ref(next[edge.m_to])
+                                    .fetch_add(1, std::memory_order_relaxed);
+                reverse.m_sources[slot] = static_cast<NodeId>(from);
+            }
+        }
+    });
+    return reverse;
+}
+
+// The nodes for which `matches(id)` holds, in id order.
+template <typename Matches>
+auto matching_nodes(size_t n, size_t n_threads, Matches&& matches)
+    -> std::vector<NodeId> {
+    size_t n_chunks = chunks_for(n, n_threads);
+    std::vector<std::vector<NodeId>> found(n_chunks);
+    parallel_chunks(n, n_chunks, [&](size_t begin, size_t end, size_t chunk) {
+        for (size_t id = begin; id < end; id++) {
+            if (matches(static_cast<NodeId>(id))) {
+                found[chunk].push_back(static_cast<NodeId>(id));
+            }
+        }
+    });
+    std::vector<NodeId> nodes;
+    for (const auto& chunk : found) {
+        nodes.insert(nodes.end(), chunk.begin(), chunk.end());
+    }
+    return nodes;
+}
+
+// Searches back from `level`, one level at a time. Every node with an
+// edge into a node of level k - 1 is offered to `claim(source, k)`, which
+// returns true for the nodes it takes into level k; it is called from
+// several threads at once, so a node must be taken with an atomic
+// exchange.
+template <typename Claim>
+auto search_back(const ReverseEdges& reverse, std::vector<NodeId> level,
+                 size_t n_threads, Claim&& claim) -> void {
+    for (uint32_t distance = 1; !level.empty(); distance++) {
+        size_t n_chunks = chunks_for(level.size(), n_threads);
+        std::vector<std::vector<NodeId>> found(n_chunks);
+        parallel_chunks(level.size(), n_chunks,
+                        [&](size_t begin, size_t end, size_t chunk) {
+                            for (size_t i = begin; i < end; i++) {
+                                for (NodeId source :
+                                     reverse.sources(level[i])) {
+                                    if (claim(source, distance)) {
+                                        found[chunk].push_back(source);
+                                    }
+                                }
+                            }
+                        });
+        level.clear();
+        for (const auto& chunk : found) {
+            level.insert(level.end(), chunk.begin(), chunk.end());
+        }
+    }
+}
+
+// Sets `outcome` to `to` if it is `from`, returning whether it did.
+auto claim_outcome(Outcome& outcome, Outcome from, Outcome to) -> bool {
+    return std::atomic_ref(outcome).compare_exchange_strong(
+        from, to, std::memory_order_relaxed);
+}
+
+auto label_outcomes(const Graph& graph, size_t n_threads)
+    -> std::vector<NodeOutcome> {
+    size_t n = graph.size();
+    std::vector<NodeOutcome> outcomes(n);
+    auto reverse = reverse_edges(graph, n_threads);
+
+    auto won = matching_nodes(n, n_threads, [&](NodeId id) {
+        return graph.table(id).is_complete();
+    });
+    for (NodeId id : won) {
+        outcomes[id] = NodeOutcome{.m_win_distance = 0,
+                                   .m_outcome = Outcome::Winnable};
+    }
+    // Levels of a breadth-first search are complete before the next
+    // starts, so the first level to take a node is its distance to a win.
+    search_back(reverse, std::move(won), n_threads,
+                [&](NodeId source, uint32_t distance) {
+                    NodeOutcome& outcome = outcomes[source];
+                    if (!claim_outcome(outcome.m_outcome, Outcome::Unknown,
+                                       Outcome::Winnable)) {
+                        return false;
+                    }
+                    outcome.m_win_distance = distance;
+                    return true;
+                });
+
+    // Nodes before the frontier were expanded, so their edges are every
+    // move from them and the ones that are not winnable are losing unless
+    // the search below takes them.
+    NodeId frontier = graph.frontier_begin();
+    parallel_chunks(frontier, chunks_for(frontier, n_threads),
+                    [&](size_t begin, size_t end, size_t) {
+                        for (size_t id = begin; id < end; id++) {
+                            claim_outcome(outcomes[id].m_outcome,
+                                          Outcome::Unknown, Outcome::Losing);
+                        }
+                    });
+    auto unexpanded = matching_nodes(n, n_threads, [&](NodeId id) {
+        return id >= frontier && outcomes[id].m_outcome == Outcome::Unknown;
+    });
+    // An expanded node that is not winnable is unknown if it reaches an
+    // unexpanded node. No node on the way can be winnable either, so the
+    // search only passes through nodes labelled losing.
+    search_back(reverse, std::move(unexpanded), n_threads,
+                [&](NodeId source, uint32_t) {
+                    return claim_outcome(outcomes[source].m_outcome,
+                                         Outcome::Losing, Outcome::Unknown);
+                });
+    return outcomes;
+}
@@ -0,0 +1,250 @@
+#include "query.hpp"
+
+#include <algorithm>
+#include <charconv>
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+
+#include "ranking.hpp"
+
+#define QUERY_DEFAULT_HOPS 1
+#define QUERY_DEFAULT_LIMIT 1000
+#define QUERY_MAX_LIMIT 100000
+
+constexpr NodeId c_no_parent = UINT32_MAX;
+
+GraphQueries::GraphQueries(const GraphFile& file)
+    : m_file(file),
+      m_in_offsets(file.size() + 1, 0),
+      m_in_sources(file.n_edges()),
+      m_parents(file.size(), c_no_parent),
+      m_parent_edges(file.size(), 0) {
+    for (NodeId id = 0; id < file.size(); id++) {
+        for (NodeId target : file.edge_targets(id)) {
+            m_in_offsets[target + 1]++;
+        }
+    }
+    for (size_t i = 0; i < file.size(); i++) {
+        m_in_offsets[i + 1] += m_in_offsets[i];
+    }
+    std::vector<uint32_t> next(m_in_offsets.begin(), m_in_offsets.end() - 1);
+    for (NodeId id = 0; id < file.size(); id++) {
+        for (NodeId target : file.edge_targets(id)) {
+            m_in_sources[next[target]++] = id;
+        }
+    }
+    // Node ids are not quite in breadth-first order when a solver's line
+    // or a DFS path was added first, so the tree is found by a BFS.
+    std::vector<NodeId> queue{Graph::c_root};
+    m_parents[Graph::c_root] = Graph::c_root;
+    for (size_t head = 0; head < queue.size(); head++) {
+        NodeId id = queue[head];
+        auto targets = file.edge_targets(id);
+        for (size_t i = 0; i < targets.size(); i++) {
+            if (m_parents[targets[i]] == c_no_parent) {
+                m_parents[targets[i]] = id;
+                m_parent_edges[targets[i]] = static_cast<uint8_t>(i);
+                queue.push_back(targets[i]);
+            }
+        }
+    }
+}
+
+// Adds the outcome of `id` to `node_json`, if the file has outcomes.
+auto add_outcome(nlohmann::json& node_json, const GraphFile& file, NodeId id)
+    -> void {
+    if (!file.has_outcomes()) {
+        return;
+    }
+    Outcome outcome = file.outcome(id);
+    node_json["outcome"] = outcome_to_string(outcome);
+    if (outcome == Outcome::Winnable) {
+        node_json["win_distance"] = file.win_distance(id);
+    }
+}
+
+auto GraphQueries::node(NodeId id) const -> nlohmann::json {
+    nlohmann::json out = {{"id", id},
+                          {"depth", m_file.depth(id)},
+                          {"winning", m_file.is_winning(id)},
+                          {"table", m_file.table(id).to_string()}};
+    add_outcome(out, m_file, id);
+    return out;
+}
+
+auto GraphQueries::neighbourhood(NodeId id, size_t hops,
+                                 size_t max_nodes) const -> nlohmann::json {
+    std::unordered_set<NodeId> found{id};
+    std::vector<NodeId> nodes{id};
+    bool truncated = false;
+    size_t level_begin = 0;
+    for (size_t hop = 0; hop < hops && !truncated; hop++) {
+        size_t level_end = nodes.size();
+        if (level_begin == level_end) {
+            break;
+        }
+        for (size_t i = level_begin; i < level_end && !truncated; i++) {
+            NodeId from = nodes[i];
+            auto visit = [&](NodeId neighbour) {
+                if (truncated || found.contains(neighbour)) {
+                    return;
+                }
+                if (nodes.size() == max_nodes) {
+                    truncated = true;
+                    return;
+                }
+                found.insert(neighbour);
+                nodes.push_back(neighbour);
+            };
+            for (NodeId target : m_file.edge_targets(from)) {
+                visit(target);
+            }
+            for (uint32_t e = m_in_offsets[from]; e < m_in_offsets[from + 1];
+                 e++) {
+                visit(m_in_sources[e]);
+            }
+        }
+        level_begin = level_end;
+    }
+    nlohmann::json nodes_json = nlohmann::json::array();
+    nlohmann::json edges_json = nlohmann::json::array();
+    for (NodeId from : nodes) {
+        nlohmann::json node_json = {{"id", from},
+                                    {"depth", m_file.depth(from)},
+                                    {"winning", m_file.is_winning(from)}};
+        add_outcome(node_json, m_file, from);
+        nodes_json.push_back(std::move(node_json));
+        auto targets = m_file.edge_targets(from);
+        for (size_t i = 0; i < targets.size(); i++) {
+            if (found.contains(targets[i])) {
+                MoveType type = m_file.edge_move(from, i).type();
+                edges_json.push_back({{"source", from},
+                                      {"target", targets[i]},
+                                      {"label", move_type_to_string(type)}});
+            }
+        }
+    }
+    return {{"max_depth", m_file.max_depth()},
+            {"nodes", std::move(nodes_json)},
+            {"edges", std::move(edges_json)},
+            {"truncated", truncated}};
+}
+
+auto GraphQueries::path_to(NodeId id) const -> nlohmann::json {
+    if (m_parents[id] == c_no_parent) {
+        return nullptr;
+    }
+    std::vector<NodeId> nodes{id};
+    std::vector<std::string> moves;
+    for (NodeId node = id; node != Graph::c_root; node = m_parents[node]) {
+        NodeId parent = m_parents[node];
+        nodes.push_back(parent);
+        moves.push_back(
+            m_file.edge_move(parent, m_parent_edges[node]).to_string());
+    }
+    std::ranges::reverse(nodes);
+    std::ranges::reverse(moves);
+    return {{"nodes", nodes}, {"moves", moves}};
+}
+
+auto GraphQueries::children(NodeId id) const -> nlohmann::json {
+    struct Child {
+        NodeId m_id;
+        Move m_move;
+        size_t m_value;
+    };
+    Table table = m_file.table(id);
+    auto targets = m_file.edge_targets(id);
+    std::vector<Child> children;
+    for (size_t i = 0; i < targets.size(); i++) {
+        Move move = m_file.edge_move(id, i);
+        children.push_back(Child{.m_id = targets[i],
+                                 .m_move = move,
+                                 .m_value = move_value(move, table)});
+    }
+    std::ranges::stable_sort(children, [](const Child& a, const Child& b) {
+        return a.m_value > b.m_value;
+    });
+    nlohmann::json out = nlohmann::json::array();
+    for (const auto& child : children) {
+        out.push_back({{"id", child.m_id},
+                       {"move", child.m_move.to_string()},
+                       {"value", child.m_value}});
+    }
+    return {{"children", std::move(out)}};
+}
+
+auto json_response(int status, const nlohmann::json& body) -> HttpResponse {
+    return HttpResponse{.m_status = status,
+                        .m_content_type = "application/json",
+                        .m_body = body.dump()};
+}
+
+auto error_response(int status, std::string_view reason) -> HttpResponse {
+    return json_response(status, {{"error", reason}});
+}
+
+auto parse_count(std::string_view text) -> std::optional<size_t> {
+    size_t count = 0;
+    auto [end, error] =
+        std::from_chars(text.data(), text.data() + text.size(), count);
+    if (error != std::errc{} || end != text.data() + text.size()) {
+        return std::nullopt;
+    }
+    return count;
+}
+
+// The count a request gives as `name`, `fallback` if it gives none, or
+// nothing if it is not a count.
+auto count_param(const HttpRequest& request, std::string_view name,
+                 size_t fallback) -> std::optional<size_t> {
+    auto text = request.param(name);
+    return text ? parse_count(*text) : fallback;
+}
+
+auto answer_query(const GraphQueries& queries, const HttpRequest& request)
+    -> HttpResponse {
+    const auto& path = request.m_path;
+    if (path != "/node" && path != "/neighbourhood" && path != "/path" &&
+        path != "/children") {
+        return error_response(404, "Unknown query " + path);
+    }
+    auto id_param = request.param("id");
+    if (!id_param) {
+        return error_response(400, "Missing node id");
+    }
+    auto id = parse_count(*id_param);
+    if (!id) {
+        return error_response(400, "Invalid node id");
+    }
+    if (*id >= queries.file().size()) {
+        return error_response(404, "No node " + std::to_string(*id));
+    }
+    auto node = static_cast<NodeId>(*id);
+    if (path == "/node") {
+        return json_response(200, queries.node(node));
+    }
+    if (path == "/path") {
+        auto nodes = queries.path_to(node);
+        if (nodes.is_null()) {
+            return error_response(404, "No path to node " +
+                                           std::to_string(node));
+        }
+        return json_response(200, nodes);
+    }
+    if (path == "/children") {
+        return json_response(200, queries.children(node));
+    }
+    auto hops = count_param(request, "hops", QUERY_DEFAULT_HOPS);
+    auto limit = count_param(request, "limit", QUERY_DEFAULT_LIMIT);
+    if (!hops || !limit || *limit == 0 || *limit > QUERY_MAX_LIMIT) {
+        return error_response(400, "Invalid hops or limit");
+    }
+    return json_response(200, queries.neighbourhood(node, *hops, *limit));
+}
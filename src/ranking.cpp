@@ -1,6 +1,8 @@
 #include "ranking.hpp"
 
 #include "common.hpp"
+#include "stack_table.hpp"
+#include "table.hpp"
 
 #define REVEAL_BONUS 20
 #define OPEN_COLUMN_BONUS 15
@@ -19,78 +21,92 @@ auto foundation_rank_bonus(size_t rank) -> size_t {
     return LOW_FOUNDATION_BONUS;
 }
 
-auto stock_to_waste_value(const Table& table) -> size_t {
-    if (table.m_stock_index == c_null_index && table.n_cards_in_waste() <= 1) {
+template <typename TableT>
+auto stock_to_waste_value(const TableT& table) -> size_t {
+    if (table.stock_top() == c_null_index && table.n_cards_in_waste() <= 1) {
         return 0;
     }
     return 1;
 }
 
-auto waste_to_foundation_value(const Table& table) -> size_t {
-    auto [suit, rank] = index_to_card(static_cast<size_t>(table.m_waste_index));
+template <typename TableT>
+auto waste_to_foundation_value(const TableT& table) -> size_t {
+    auto [suit, rank] = index_to_card(static_cast<size_t>(table.waste_top()));
     return foundation_rank_bonus(rank);
 }
 
-auto waste_to_tableau_value(const Table& table, size_t to_col) -> size_t {
+template <typename TableT>
+auto waste_to_tableau_value(const TableT& table, size_t to_col) -> size_t {
     return 5;
 }
 
-auto tableau_to_foundation_value(const Table& table, size_t from_col)
+template <typename TableT>
+auto tableau_to_foundation_value(const TableT& table, size_t from_col)
     -> size_t {
     size_t n_visible = table.n_cards_in_visible_tableau_column(from_col);
-    uint8_t tableau_top = table.m_tableau_visible_indices[from_col];
+    uint8_t tableau_top = table.visible_top(from_col);
     auto [suit, rank] = index_to_card(static_cast<size_t>(tableau_top));
     size_t value = foundation_rank_bonus(rank);
     if (n_visible == 1 &&
-        table.m_tableau_hidden_indices[from_col] != c_null_index) {
+        table.hidden_top(from_col) != c_null_index) {
         value +=
             REVEAL_BONUS + table.n_cards_in_hidden_tableau_column(from_col);
     }
     return value;
 }
 
-auto tableau_to_tableau_value(const Table& table, size_t from_col,
+template <typename TableT>
+auto tableau_to_tableau_value(const TableT& table, size_t from_col,
                               size_t to_col, size_t n_cards) -> size_t {
     size_t n_visible = table.n_cards_in_visible_tableau_column(from_col);
     if (n_cards == n_visible &&
-        table.m_tableau_hidden_indices[from_col] != c_null_index) {
+        table.hidden_top(from_col) != c_null_index) {
         return REVEAL_BONUS + table.n_cards_in_hidden_tableau_column(from_col);
     }
     auto [_, rank] = index_to_card(
-        static_cast<size_t>(table.m_tableau_visible_indices[from_col]));
+        static_cast<size_t>(table.visible_top(from_col)));
     if (n_cards == n_visible && rank != c_num_cards_in_suit - n_cards) {
         return OPEN_COLUMN_BONUS;
     }
     return 0;
 }
 
-auto foundation_to_tableau_value(const Table& table, Suit from_suit,
+template <typename TableT>
+auto foundation_to_tableau_value(const TableT& table, Suit from_suit,
                                  size_t to_col) -> size_t {
     return 0;
 }
 
-auto move_value(const Move& move, const Table& table) -> size_t {
-    switch (move.m_type) {
+template <typename TableT>
+auto move_value(const Move& move, const TableT& table) -> size_t {
+    switch (move.type()) {
         case MoveType::StockToWaste:
             return stock_to_waste_value(table);
         case MoveType::WasteToFoundation:
             return waste_to_foundation_value(table);
         case MoveType::WasteToTableau:
-            return waste_to_tableau_value(table, move.mv.wt.m_to_col);
+            return waste_to_tableau_value(table, move.to_col());
         case MoveType::TableauToFoundation:
-            return tableau_to_foundation_value(table, move.mv.tf.m_from_col);
+            return tableau_to_foundation_value(table, move.from_col());
         case MoveType::TableauToTableau:
-            return tableau_to_tableau_value(table, move.mv.tt.m_from_col,
-                                            move.mv.tt.m_to_col,
-                                            move.mv.tt.m_n_cards);
+            return tableau_to_tableau_value(table, move.from_col(),
+                                            move.to_col(), move.n_cards());
         case MoveType::FoundationToTableau:
-            return foundation_to_tableau_value(table, move.mv.ft.m_from_suit,
-                                               move.mv.ft.m_to_col);
+            return foundation_to_tableau_value(table, move.from_suit(),
+                                               move.to_col());
     }
     throw std::invalid_argument("Invalid move type");
 }
 
-auto compare_moves(const Move& a, const Move& b, const Table& table) -> bool {
+template <typename TableT>
+auto compare_moves(const Move& a, const Move& b, const TableT& table) -> bool {
     return static_cast<size_t>(move_value(a, table)) <
            static_cast<size_t>(move_value(b, table));
 }
+
+template auto move_value(const Move& move, const Table& table) -> size_t;
+template auto move_value(const Move& move, const StackTable& table) -> size_t;
+template auto compare_moves(const Move& a, const Move& b, const Table& table)
+    -> bool;
+template auto compare_moves(const Move& a, const Move& b,
+                            const StackTable& table) -> bool;
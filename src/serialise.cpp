@@ -1,14 +1,27 @@
 #include "serialise.hpp"
 
+#include <fcntl.h>
 #include <fmt/format.h>
 #include <sys/types.h>
+#include <unistd.h>
 
+#include <algorithm>
+#include <cassert>
+#include <cerrno>
+#include <cmath>
 #include <cstdint>
 #include <cstdio>
+#include <cstring>
+#include <functional>
+#include <optional>
+#include <stdexcept>
 #include <string>
-#include <unordered_map>
+#include <string_view>
+#include <type_traits>
+#include <utility>
 #include <vector>
 
+#include "graph_file.hpp"
 #include "moves.hpp"
 #include "nlohmann/json.hpp"
 
@@ -20,6 +33,10 @@
 #define START_COLOR 0x1446A0FF
 // #DB3069
 #define END_COLOR 0xDB3069FF
+// #1B5E20, of winnable nodes `WINNABLE_FAR_MOVES` or more moves from a
+// win. Winning a deal takes a little over a hundred moves.
+#define WINNABLE_FAR_COLOR 0x1B5E20FF
+#define WINNABLE_FAR_MOVES 150.0F
 #define COLOR_TO_R(color) ((color >> 24) & 0xFF)
 #define COLOR_TO_G(color) ((color >> 16) & 0xFF)
 #define COLOR_TO_B(color) ((color >> 8) & 0xFF)
@@ -35,6 +52,9 @@
 #define END_R COLOR_TO_R(END_COLOR)
 #define END_G COLOR_TO_G(END_COLOR)
 #define END_B COLOR_TO_B(END_COLOR)
+#define WINNABLE_FAR_R COLOR_TO_R(WINNABLE_FAR_COLOR)
+#define WINNABLE_FAR_G COLOR_TO_G(WINNABLE_FAR_COLOR)
+#define WINNABLE_FAR_B COLOR_TO_B(WINNABLE_FAR_COLOR)
 
 auto lerp(uint8_t start, uint8_t end, float t) -> uint8_t {
     auto start_f = static_cast<float>(start);
@@ -42,25 +62,43 @@ auto lerp(uint8_t start, uint8_t end, float t) -> uint8_t {
     return static_cast<uint8_t>((start_f * (1.0F - t)) + (end_f * t));
 }
 
+auto rgb_colour(uint8_t r, uint8_t g, uint8_t b) -> std::string {
+    std::array<char, 10> buffer;
+    std::snprintf(buffer.data(), buffer.size(), "#%02X%02X%02XFF", r, g, b);
+    return {buffer.data()};
+}
+
 auto value_to_colour(size_t value, size_t max_depth, bool winning)
     -> std::string {
-    uint8_t r, g, b;
     if (winning) {
-        r = WINNING_R;
-        g = WINNING_G;
-        b = WINNING_B;
-    } else {
-        float t = static_cast<float>(value) / static_cast<float>(max_depth);
-        r = lerp(START_R, END_R, t);
-        g = lerp(START_G, END_G, t);
-        b = lerp(START_B, END_B, t);
+        return rgb_colour(WINNING_R, WINNING_G, WINNING_B);
     }
-    std::array<char, 10> buffer;
-    std::snprintf(buffer.data(), buffer.size(), "#%02X%02X%02XFF", r, g, b);
-    return {buffer.data()};
+    float t = static_cast<float>(value) / static_cast<float>(max_depth);
+    return rgb_colour(lerp(START_R, END_R, t), lerp(START_G, END_G, t),
+                      lerp(START_B, END_B, t));
 }
 
-using NodeList = std::vector<std::shared_ptr<const Node>>;
+// The colour of a node by its depth, or by its outcome if outcomes were
+// labelled and it is not unknown: winnable nodes darken from the winning
+// colour with their distance to a win, and losing nodes take the dead-end
+// colour.
+auto node_colour(const Graph& graph, NodeId id, size_t max_depth,
+                 std::span<const NodeOutcome> outcomes) -> std::string {
+    Outcome outcome =
+        outcomes.empty() ? Outcome::Unknown : outcomes[id].m_outcome;
+    if (outcome == Outcome::Losing) {
+        return rgb_colour(DEADEND_R, DEADEND_G, DEADEND_B);
+    }
+    if (outcome == Outcome::Winnable) {
+        float distance = static_cast<float>(outcomes[id].m_win_distance);
+        float t = std::min(1.0F, distance / WINNABLE_FAR_MOVES);
+        return rgb_colour(lerp(WINNING_R, WINNABLE_FAR_R, t),
+                          lerp(WINNING_G, WINNABLE_FAR_G, t),
+                          lerp(WINNING_B, WINNABLE_FAR_B, t));
+    }
+    return value_to_colour(graph.node(id).m_depth, max_depth,
+                           graph.table(id).is_complete());
+}
 
 #define NODE_MIN_SIZE 1.0F
 #define NODE_MAX_SIZE 4.0F
@@ -72,61 +110,94 @@ constexpr float get_node_size(size_t max_depth, size_t node_depth) {
                             (NODE_MAX_SIZE - NODE_MIN_SIZE) / max_depth_f);
 }
 
-auto serialise_nodes(const NodeList& nodes, size_t max_depth)
-    -> nlohmann::json {
+auto node_size_string(size_t max_depth, size_t node_depth) -> std::string {
+    std::array<char, 10> buffer;
+    std::snprintf(buffer.data(), buffer.size(), "%f",
+                  get_node_size(max_depth, node_depth));
+    return {buffer.data()};
+}
+
+// The label forced onto the start node and winning nodes, if any.
+auto node_label(size_t id, bool winning) -> std::optional<std::string_view> {
+    if (id == 0) {
+        return "Start";
+    }
+    if (winning) {
+        return "Winning";
+    }
+    return std::nullopt;
+}
+
+constexpr std::string_view c_base64_alphabet =
+    "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+
+// The packed table in base64, without padding as its 72 bytes are a
+// multiple of 3.
+auto packed_table_base64(const PackedTable& packed) -> std::string {
+    static_assert(c_table_state_size % 3 == 0);
+    std::string out;
+    out.reserve(c_table_state_size / 3 * 4);
+    for (size_t i = 0; i < c_table_state_size; i += 3) {
+        uint32_t bits = (uint32_t{packed[i]} << 16) |
+                        (uint32_t{packed[i + 1]} << 8) | packed[i + 2];
+        for (int shift = 18; shift >= 0; shift -= 6) {
+            out += c_base64_alphabet[(bits >> shift) & 0x3F];
+        }
+    }
+    return out;
+}
+
+// A coordinate of a node position as exported to JSON.
+auto json_coordinate(float coordinate) -> double {
+    return std::round(static_cast<double>(coordinate) * 100.0) / 100.0;
+}
+
+auto serialise_nodes(const Graph& graph, size_t max_depth,
+                     const JsonOptions& options) -> nlohmann::json {
     nlohmann::json out = nlohmann::json::array();
-    for (size_t id = 0; id < nodes.size(); ++id) {
-        const auto& node_ptr = nodes[id];
+    for (NodeId id = 0; id < graph.size(); ++id) {
+        const Node& node = graph.node(id);
+        Table table = graph.table(id);
         nlohmann::json node_json;
         node_json["id"] = id;
-        bool winning = node_ptr->m_table.is_complete();
+        bool winning = table.is_complete();
         node_json["color"] =
-            value_to_colour(node_ptr->m_depth, max_depth, winning);
-        std::array<char, 10> buffer;
-        std::snprintf(buffer.data(), buffer.size(), "%f",
-                      get_node_size(max_depth, node_ptr->m_depth));
-        node_json["size"] = {buffer.data()};
-        if (id == 0) {
-            node_json["label"] = "Start";
-            node_json["forceLabel"] = true;
-        } else if (winning) {
-            node_json["label"] = "Winning";
+            node_colour(graph, id, max_depth, options.m_outcomes);
+        node_json["size"] = {node_size_string(max_depth, node.m_depth)};
+        if (auto label = node_label(id, winning)) {
+            node_json["label"] = *label;
             node_json["forceLabel"] = true;
         }
-        node_json["table"] = node_ptr->m_table.to_string();
+        if (options.m_tables == TableEncoding::Packed) {
+            node_json["state"] = packed_table_base64(graph.state(id));
+        } else {
+            node_json["table"] = table.to_string();
+        }
+        if (!options.m_positions.empty()) {
+            node_json["x"] = json_coordinate(options.m_positions[id].m_x);
+            node_json["y"] = json_coordinate(options.m_positions[id].m_y);
+        }
+        if (!options.m_outcomes.empty()) {
+            const NodeOutcome& outcome = options.m_outcomes[id];
+            node_json["outcome"] = outcome_to_string(outcome.m_outcome);
+            if (outcome.m_outcome == Outcome::Winnable) {
+                node_json["win_distance"] = outcome.m_win_distance;
+            }
+        }
         out.push_back(node_json);
     }
     return out;
 }
 
-auto build_ptr_to_id_map(const NodeList& nodes)
-    -> std::unordered_map<const Node*, size_t> {
-    std::unordered_map<const Node*, size_t> ptr_to_id;
-    ptr_to_id.reserve(nodes.size());
-    for (size_t i = 0; i < nodes.size(); ++i) {
-        ptr_to_id.emplace(nodes[i].get(), i);
-    }
-    return ptr_to_id;
-}
-
-auto serialise_edges(const NodeList& nodes) -> nlohmann::json {
+auto serialise_edges(const Graph& graph) -> nlohmann::json {
     nlohmann::json edges = nlohmann::json::array();
-    std::unordered_map<const Node*, size_t> ptr_to_id =
-        build_ptr_to_id_map(nodes);
-    for (size_t id = 0; id < nodes.size(); ++id) {
-        const auto& node_ptr = nodes[id];
-        for (const auto& edge : node_ptr->m_edges) {
+    for (NodeId id = 0; id < graph.size(); ++id) {
+        for (const auto& edge : graph.edges(id)) {
             nlohmann::json edge_json;
             edge_json["source"] = id;
-            const Node* to_ptr = edge.m_to.get();
-            auto it = ptr_to_id.find(to_ptr);
-            if (it == ptr_to_id.end()) {
-                // target node wasn't in the traversal (maybe beyond max depth)
-                continue;
-            }
-            edge_json["target"] = it->second;
+            edge_json["target"] = edge.m_to;
             edge_json["type"] = "arrow";
-            edge_json["label"] = move_type_to_string(edge.m_move.m_type);
+            edge_json["label"] = move_type_to_string(edge.m_move.type());
             edge_json["size"] = 1;
             edges.push_back(edge_json);
         }
@@ -134,30 +205,513 @@ auto serialise_edges(const NodeList& nodes) -> nlohmann::json {
     return edges;
 }
 
-auto graph_to_json(const Graph& graph, size_t max_depth) -> nlohmann::json {
-    NodeList nodes;
-    nodes.reserve(256);
-    auto it = graph.begin();
-    auto owner = it.owner();
-    auto end = graph.end();
-    for (; it != end; ++it) {
-        nodes.push_back(*it);
-    }
+auto graph_to_json(const Graph& graph, size_t max_depth, JsonOptions options)
+    -> nlohmann::json {
     nlohmann::json j;
-    j["nodes"] = serialise_nodes(nodes, max_depth);
-    j["edges"] = serialise_edges(nodes);
+    j["nodes"] = serialise_nodes(graph, max_depth, options);
+    j["edges"] = serialise_edges(graph);
+    if (!options.m_clusters.empty()) {
+        j["clusters"] = nlohmann::json::array();
+        for (const auto& level : options.m_clusters) {
+            j["clusters"].push_back(level);
+        }
+    }
     return j;
 }
 
-auto graph_to_string(const Graph& graph, size_t max_depth) -> std::string {
-    return graph_to_json(graph, max_depth).dump(2);
+#define JSON_WRITER_BUFFER_BYTES (1 << 20)
+#define FILE_WRITER_BUFFER_BYTES (1 << 20)
+
+// Writes JSON token by token into a buffer handed to `sink` whenever it
+// fills, laid out as `nlohmann::json::dump` lays out a document: indented
+// by two spaces when pretty, with no whitespace at all when compact.
+class JsonStreamWriter {
+   public:
+    using Sink = std::function<void(std::string_view)>;
+
+    JsonStreamWriter(JsonStyle style, Sink sink)
+        : m_pretty(style == JsonStyle::Pretty), m_sink(std::move(sink)) {
+        m_buffer.reserve(JSON_WRITER_BUFFER_BYTES);
+    }
+
+    auto begin_object() -> void { open('{'); }
+    auto end_object() -> void { close('}'); }
+    auto begin_array() -> void { open('['); }
+    auto end_array() -> void { close(']'); }
+
+    auto key(std::string_view name) -> void {
+        next_element();
+        write_string(name);
+        m_buffer += m_pretty ? ": " : ":";
+        m_after_key = true;
+    }
+
+    auto value(std::string_view text) -> void {
+        next_value();
+        write_string(text);
+        flush_if_full();
+    }
+    auto value(size_t number) -> void {
+        next_value();
+        fmt::format_to(std::back_inserter(m_buffer), "{}", number);
+        flush_if_full();
+    }
+    // Formatted as `dump` formats it: the shortest text that reads back
+    // as the same double, with ".0" after whole numbers.
+    auto value(double number) -> void {
+        next_value();
+        size_t start = m_buffer.size();
+        fmt::format_to(std::back_inserter(m_buffer), "{}", number);
+        if (m_buffer.find_first_of(".e", start) == std::string::npos) {
+            m_buffer += ".0";
+        }
+        flush_if_full();
+    }
+    auto value(bool flag) -> void {
+        next_value();
+        m_buffer += flag ? "true" : "false";
+        flush_if_full();
+    }
+
+    auto finish() -> void {
+        assert(m_empty.empty());
+        m_sink(m_buffer);
+        m_buffer.clear();
+    }
+
+   private:
+    bool m_pretty;
+    Sink m_sink;
+    std::string m_buffer;
+    // Whether each open container has no element yet.
+    std::vector<bool> m_empty;
+    bool m_after_key{false};
+
+    // Starts an element of the innermost container.
+    auto next_element() -> void {
+        if (m_empty.empty()) {
+            return;
+        }
+        if (!m_empty.back()) {
+            m_buffer += ',';
+        }
+        m_empty.back() = false;
+        if (m_pretty) {
+            m_buffer += '\n';
+            m_buffer.append(2 * m_empty.size(), ' ');
+        }
+    }
+
+    // Values inside an object follow their key.
+    auto next_value() -> void {
+        if (m_after_key) {
+            m_after_key = false;
+        } else {
+            next_element();
+        }
+    }
+
+    auto open(char bracket) -> void {
+        next_value();
+        m_buffer += bracket;
+        m_empty.push_back(true);
+    }
+
+    auto close(char bracket) -> void {
+        assert(!m_empty.empty());
+        bool empty = m_empty.back();
+        m_empty.pop_back();
+        if (m_pretty && !empty) {
+            m_buffer += '\n';
+            m_buffer.append(2 * m_empty.size(), ' ');
+        }
+        m_buffer += bracket;
+        flush_if_full();
+    }
+
+    // Escapes as `dump` does, leaving UTF-8 as is.
+    auto write_string(std::string_view text) -> void {
+        m_buffer += '"';
+        for (char c : text) {
+            switch (c) {
+                case '"':
+                    m_buffer += "\\\"";
+                    break;
+                case '\\':
+                    m_buffer += "\\\\";
+                    break;
+                case '\b':
+                    m_buffer += "\\b";
+                    break;
+                case '\f':
+                    m_buffer += "\\f";
+                    break;
+                case '\n':
+                    m_buffer += "\\n";
+                    break;
+                case '\r':
+                    m_buffer += "\\r";
+                    break;
+                case '\t':
+                    m_buffer += "\\t";
+                    break;
+                default:
+                    if (static_cast<unsigned char>(c) < 0x20) {
+                        fmt::format_to(std::back_inserter(m_buffer),
+                                       "\\u{:04x}",
+                                       static_cast<unsigned char>(c));
+                    } else {
+                        m_buffer += c;
+                    }
+            }
+        }
+        m_buffer += '"';
+    }
+
+    auto flush_if_full() -> void {
+        if (m_buffer.size() >= JSON_WRITER_BUFFER_BYTES) {
+            m_sink(m_buffer);
+            m_buffer.clear();
+        }
+    }
+};
+
+auto write_edge_json(JsonStreamWriter& out, NodeId id, const Edge& edge)
+    -> void {
+    out.begin_object();
+    out.key("label");
+    out.value(move_type_to_string(edge.m_move.type()));
+    out.key("size");
+    out.value(size_t{1});
+    out.key("source");
+    out.value(size_t{id});
+    out.key("target");
+    out.value(size_t{edge.m_to});
+    out.key("type");
+    out.value(std::string_view("arrow"));
+    out.end_object();
+}
+
+auto write_node_json(JsonStreamWriter& out, const Graph& graph, NodeId id,
+                     size_t max_depth, const JsonOptions& options) -> void {
+    const Node& node = graph.node(id);
+    Table table = graph.table(id);
+    bool winning = table.is_complete();
+    auto label = node_label(id, winning);
+    out.begin_object();
+    out.key("color");
+    out.value(node_colour(graph, id, max_depth, options.m_outcomes));
+    if (label) {
+        out.key("forceLabel");
+        out.value(true);
+    }
+    out.key("id");
+    out.value(size_t{id});
+    if (label) {
+        out.key("label");
+        out.value(*label);
+    }
+    const NodeOutcome* outcome =
+        options.m_outcomes.empty() ? nullptr : &options.m_outcomes[id];
+    if (outcome) {
+        out.key("outcome");
+        out.value(outcome_to_string(outcome->m_outcome));
+    }
+    out.key("size");
+    out.begin_array();
+    out.value(node_size_string(max_depth, node.m_depth));
+    out.end_array();
+    if (options.m_tables == TableEncoding::Packed) {
+        out.key("state");
+        out.value(packed_table_base64(graph.state(id)));
+    } else {
+        out.key("table");
+        out.value(table.to_string());
+    }
+    if (outcome && outcome->m_outcome == Outcome::Winnable) {
+        out.key("win_distance");
+        out.value(size_t{outcome->m_win_distance});
+    }
+    if (!options.m_positions.empty()) {
+        out.key("x");
+        out.value(json_coordinate(options.m_positions[id].m_x));
+        out.key("y");
+        out.value(json_coordinate(options.m_positions[id].m_y));
+    }
+    out.end_object();
+}
+
+// Keys are written in the sorted order `nlohmann::json` objects keep them
+// in, so the output matches `graph_to_json(...).dump()`.
+auto stream_graph_json(const Graph& graph, size_t max_depth,
+                       JsonOptions options, JsonStreamWriter::Sink sink)
+    -> void {
+    JsonStreamWriter out(options.m_style, std::move(sink));
+    out.begin_object();
+    if (!options.m_clusters.empty()) {
+        out.key("clusters");
+        out.begin_array();
+        for (const auto& level : options.m_clusters) {
+            out.begin_array();
+            for (uint32_t cluster : level) {
+                out.value(size_t{cluster});
+            }
+            out.end_array();
+        }
+        out.end_array();
+    }
+    out.key("edges");
+    out.begin_array();
+    for (NodeId id = 0; id < graph.size(); ++id) {
+        for (const auto& edge : graph.edges(id)) {
+            write_edge_json(out, id, edge);
+        }
+    }
+    out.end_array();
+    out.key("nodes");
+    out.begin_array();
+    for (NodeId id = 0; id < graph.size(); ++id) {
+        write_node_json(out, graph, id, max_depth, options);
+    }
+    out.end_array();
+    out.end_object();
+    out.finish();
+}
+
+auto graph_to_string(const Graph& graph, size_t max_depth,
+                     JsonOptions options) -> std::string {
+    std::string out;
+    stream_graph_json(graph, max_depth, options,
+                      [&out](std::string_view chunk) { out += chunk; });
+    return out;
+}
+
+auto graph_batch_to_string(const Graph& graph, const GraphBatch& batch,
+                           size_t max_depth, JsonOptions options)
+    -> std::string {
+    std::string text;
+    JsonStreamWriter out(options.m_style,
+                         [&text](std::string_view chunk) { text += chunk; });
+    out.begin_object();
+    out.key("edges");
+    out.begin_array();
+    for (NodeId id = batch.m_first_source; id < batch.m_end_source; ++id) {
+        for (const auto& edge : graph.edges(id)) {
+            write_edge_json(out, id, edge);
+        }
+    }
+    out.end_array();
+    out.key("nodes");
+    out.begin_array();
+    for (NodeId id = batch.m_first_node; id < graph.size(); ++id) {
+        write_node_json(out, graph, id, max_depth, options);
+    }
+    out.end_array();
+    out.end_object();
+    out.finish();
+    return text;
 }
 
+// Writes to a new file through a fixed buffer, so memory use does not grow
+// with the size of the file.
+class BufferedFileWriter {
+   public:
+    explicit BufferedFileWriter(const std::filesystem::path& path)
+        : m_path(path),
+          m_fd(::open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644)) {
+        if (m_fd < 0) {
+            throw std::runtime_error("Cannot open " + path.string() + ": " +
+                                     std::strerror(errno));
+        }
+        m_buffer.reserve(FILE_WRITER_BUFFER_BYTES);
+    }
+    ~BufferedFileWriter() {
+        if (m_fd >= 0) {
+            ::close(m_fd);
+        }
+    }
+    BufferedFileWriter(const BufferedFileWriter&) = delete;
+    auto operator=(const BufferedFileWriter&) -> BufferedFileWriter& = delete;
+
+    auto write(std::string_view bytes) -> void {
+        if (m_buffer.size() + bytes.size() > FILE_WRITER_BUFFER_BYTES) {
+            flush();
+        }
+        if (bytes.size() >= FILE_WRITER_BUFFER_BYTES) {
+            write_all(bytes);
+        } else {
+            m_buffer += bytes;
+        }
+    }
+
+    template <typename T>
+    auto write_value(const T& value) -> void {
+        static_assert(std::is_trivially_copyable_v<T>);
+        write({reinterpret_cast<const char*>(&value), sizeof(T)});
+    }
+
+    // Pads with zeros up to `offset` bytes from the start of the file.
+    auto pad_to(size_t offset) -> void {
+        assert(offset >= m_n_bytes + m_buffer.size());
+        m_buffer.append(offset - m_n_bytes - m_buffer.size(), '\0');
+    }
+
+    auto finish() -> void {
+        flush();
+        int fd = std::exchange(m_fd, -1);
+        if (::close(fd) != 0) {
+            throw std::runtime_error("Failed to write " + m_path.string());
+        }
+    }
+
+   private:
+    std::filesystem::path m_path;
+    int m_fd;
+    std::string m_buffer;
+    size_t m_n_bytes{0};
+
+    auto flush() -> void {
+        write_all(m_buffer);
+        m_buffer.clear();
+    }
+
+    auto write_all(std::string_view bytes) -> void {
+        m_n_bytes += bytes.size();
+        while (!bytes.empty()) {
+            ssize_t n_written = ::write(m_fd, bytes.data(), bytes.size());
+            if (n_written < 0 && errno == EINTR) {
+                continue;
+            }
+            if (n_written < 0) {
+                throw std::runtime_error("Failed to write " +
+                                         m_path.string() + ": " +
+                                         std::strerror(errno));
+            }
+            bytes.remove_prefix(static_cast<size_t>(n_written));
+        }
+    }
+};
+
 auto write_graph_to_file(const Graph& graph,
-                         const std::filesystem::path& outpath, size_t max_depth)
+                         const std::filesystem::path& outpath, size_t max_depth,
+                         JsonOptions options) -> void {
+    BufferedFileWriter file(outpath);
+    stream_graph_json(graph, max_depth, options,
+                      [&file](std::string_view chunk) { file.write(chunk); });
+    file.finish();
+}
+
+// The number of clusters in each level of `clusters` after the first.
+auto cluster_counts(std::span<const std::vector<uint32_t>> clusters)
+    -> std::vector<uint32_t> {
+    std::vector<uint32_t> counts;
+    for (size_t level = 1; level < clusters.size(); level++) {
+        counts.push_back(static_cast<uint32_t>(clusters[level].size()));
+    }
+    if (!clusters.empty()) {
+        counts.push_back(std::ranges::max(clusters.back()) + 1);
+    }
+    return counts;
+}
+
+// The flags byte of a node in a graph file.
+auto graph_file_node_flags(const Graph& graph, NodeId id,
+                           std::span<const NodeOutcome> outcomes) -> uint8_t {
+    uint8_t flags =
+        graph.table(id).is_complete() ? c_graph_file_winning : uint8_t{0};
+    if (!outcomes.empty()) {
+        if (outcomes[id].m_outcome == Outcome::Winnable) {
+            flags |= c_graph_file_winnable;
+        } else if (outcomes[id].m_outcome == Outcome::Losing) {
+            flags |= c_graph_file_losing;
+        }
+    }
+    return flags;
+}
+
+auto write_graph_to_binary_file(const Graph& graph,
+                                const std::filesystem::path& outpath,
+                                size_t max_depth,
+                                std::span<const Point> positions,
+                                std::span<const std::vector<uint32_t>> clusters,
+                                std::span<const NodeOutcome> outcomes)
     -> void {
-    std::ofstream file;
-    file.open(outpath);
-    file << graph_to_string(graph, max_depth);
-    file.close();
+    assert(positions.empty() || positions.size() == graph.size());
+    assert(clusters.empty() || clusters.front().size() == graph.size());
+    assert(outcomes.empty() || outcomes.size() == graph.size());
+    size_t n_edges = graph.n_edges();
+    if (n_edges > UINT32_MAX) {
+        throw std::length_error("Too many edges for a graph file");
+    }
+    auto counts = cluster_counts(clusters);
+    auto layout = GraphFileLayout::of(graph.size(), n_edges,
+                                      !positions.empty(), counts,
+                                      !outcomes.empty());
+    uint32_t flags =
+        (positions.empty() ? 0 : c_graph_file_has_positions) |
+        (clusters.empty() ? 0 : c_graph_file_has_clusters) |
+        (outcomes.empty() ? 0 : c_graph_file_has_outcomes);
+    BufferedFileWriter file(outpath);
+    file.write(c_graph_file_magic);
+    file.write_value(c_graph_file_version);
+    file.write_value(static_cast<uint32_t>(graph.size()));
+    file.write_value(static_cast<uint32_t>(n_edges));
+    file.write_value(static_cast<uint32_t>(max_depth));
+    file.write_value(static_cast<uint32_t>(c_table_state_size));
+    file.write_value(flags);
+    file.pad_to(layout.m_depths);
+    for (NodeId node = 0; node < graph.size(); node++) {
+        file.write_value(graph.node(node).m_depth);
+    }
+    file.pad_to(layout.m_edge_offsets);
+    uint32_t offset = 0;
+    for (NodeId node = 0; node < graph.size(); node++) {
+        file.write_value(offset);
+        offset += graph.node(node).m_n_edges;
+    }
+    file.write_value(offset);
+    file.pad_to(layout.m_edge_targets);
+    for (NodeId node = 0; node < graph.size(); node++) {
+        for (const auto& edge : graph.edges(node)) {
+            file.write_value(edge.m_to);
+        }
+    }
+    file.pad_to(layout.m_edge_moves);
+    for (NodeId node = 0; node < graph.size(); node++) {
+        for (const auto& edge : graph.edges(node)) {
+            file.write_value(edge.m_move.bits());
+        }
+    }
+    file.pad_to(layout.m_flags);
+    for (NodeId node = 0; node < graph.size(); node++) {
+        file.write_value(graph_file_node_flags(graph, node, outcomes));
+    }
+    file.pad_to(layout.m_states);
+    for (NodeId node = 0; node < graph.size(); node++) {
+        file.write_value(graph.state(node));
+    }
+    file.pad_to(layout.m_positions);
+    for (const Point& position : positions) {
+        file.write_value(position);
+    }
+    if (!clusters.empty()) {
+        file.pad_to(layout.m_clusters);
+        file.write_value(static_cast<uint32_t>(counts.size()));
+        for (uint32_t count : counts) {
+            file.write_value(count);
+        }
+        for (const auto& level : clusters) {
+            for (uint32_t cluster : level) {
+                file.write_value(cluster);
+            }
+        }
+    }
+    if (!outcomes.empty()) {
+        file.pad_to(layout.m_win_distances);
+        for (const NodeOutcome& outcome : outcomes) {
+            file.write_value(outcome.m_win_distance);
+        }
+    }
+    file.pad_to(layout.m_size);
+    file.finish();
 }
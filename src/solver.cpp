@@ -0,0 +1,477 @@
+#include "solver.hpp"
+
+#include <algorithm>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <queue>
+#include <stdexcept>
+#include <string_view>
+#include <unordered_set>
+#include <vector>
+
+#include "common.hpp"
+#include "legality.hpp"
+#include "moves.hpp"
+#include "ranking.hpp"
+#include "state_store.hpp"
+#include "table.hpp"
+#include "transposition_table.hpp"
+
+#define SOLVER_HEURISTIC_WEIGHT 5
+#define SOLVER_TIMEOUT_CHECK_FREQUENCY 1024
+
+auto solve_status_to_string(SolveStatus status) -> std::string_view {
+    switch (status) {
+        case SolveStatus::Won:
+            return "won";
+        case SolveStatus::Lost:
+            return "lost";
+        case SolveStatus::OutOfBudget:
+            return "budget exhausted";
+    }
+    throw std::invalid_argument("Invalid solve status");
+}
+
+auto moves_to_win_lower_bound(const Table& table) -> size_t {
+    size_t on_foundations = 0;
+    for (size_t suit = 0; suit < c_num_suits; suit++) {
+        uint8_t top = table.foundation_top(suit);
+        if (top != c_null_index) {
+            on_foundations +=
+                index_to_card(static_cast<size_t>(top)).second + 1;
+        }
+    }
+    return c_num_cards - on_foundations;
+}
+
+auto n_hidden_cards(const Table& table) -> size_t {
+    size_t n_hidden = 0;
+    for (size_t col = 0; col < c_tableau_columns; col++) {
+        n_hidden += table.n_cards_in_hidden_tableau_column(col);
+    }
+    return n_hidden;
+}
+
+// A card can go to its foundation without losing any line of play once
+// both cards that could be placed on it in the tableau are on their own
+// foundations. Aces and twos are always safe, since an ace never needs to
+// sit on a two.
+auto is_safe_to_foundation(const Table& table, uint8_t card_index) -> bool {
+    auto [suit, rank] = index_to_card(static_cast<size_t>(card_index));
+    if (rank <= 1) {
+        return true;
+    }
+    for (size_t other = 0; other < c_num_suits; other++) {
+        if (suit_colours_equal(suit, static_cast<Suit>(other))) {
+            continue;
+        }
+        uint8_t top = table.foundation_top(other);
+        if (top == c_null_index ||
+            index_to_card(static_cast<size_t>(top)).second + 1 < rank) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// The first safe foundation move, which dominates every other move.
+auto find_safe_move(const Table& table, const MoveList& moves)
+    -> std::optional<Move> {
+    for (const auto& move : moves) {
+        if (move.type() == MoveType::WasteToFoundation &&
+            is_safe_to_foundation(table, table.waste_top())) {
+            return move;
+        }
+        if (move.type() == MoveType::TableauToFoundation &&
+            is_safe_to_foundation(table, table.visible_top(move.from_col()))) {
+            return move;
+        }
+    }
+    return std::nullopt;
+}
+
+// Whether `card` could be placed on `parent` in the tableau.
+auto is_tableau_child(uint8_t card, uint8_t parent) -> bool {
+    return (c_tableau_parents[static_cast<size_t>(card)] & card_bit(parent)) !=
+           0;
+}
+
+// Whether some card in the stock or waste could be placed on `card_index`.
+auto talon_has_child_of(const Table& table, uint8_t card_index) -> bool {
+    for (uint8_t top : {table.stock_top(), table.waste_top()}) {
+        for (uint8_t card : LinkedPile(table.m_deck.data(), top)) {
+            if (is_tableau_child(card, card_index)) {
+                return true;
+            }
+        }
+    }
+    return false;
+}
+
+// Whether a foundation top, or a visible card of a column other than
+// `from_col` and `to_col`, could be moved onto `card_index`.
+auto piles_have_child_of(const Table& table, uint8_t card_index,
+                         size_t from_col, size_t to_col) -> bool {
+    for (size_t suit = 0; suit < c_num_suits; suit++) {
+        uint8_t top = table.foundation_top(suit);
+        if (top != c_null_index && is_tableau_child(top, card_index)) {
+            return true;
+        }
+    }
+    for (size_t col = 0; col < c_tableau_columns; col++) {
+        if (col == from_col || col == to_col) {
+            continue;
+        }
+        for (uint8_t card : table.visible_run(col)) {
+            if (is_tableau_child(card, card_index)) {
+                return true;
+            }
+        }
+    }
+    return false;
+}
+
+// Prunes tableau to tableau moves that cannot help. Moving a whole column
+// onto an empty one only relabels the columns. Moving part of a run is
+// kept only if the card it exposes can then go to its foundation or take a
+// card from the talon, a foundation or another column; otherwise it just
+// swaps the run between two equivalent parents. Every move that could
+// follow from the exposed card is kept, so a search that runs out of
+// moves proves the deal lost.
+auto is_useful_tableau_move(const Table& table, const Move& move) -> bool {
+    size_t from_col = move.from_col();
+    if (move.n_cards() == table.n_cards_in_visible_tableau_column(from_col)) {
+        return table.hidden_top(from_col) != c_null_index ||
+               table.visible_top(move.to_col()) != c_null_index;
+    }
+    uint8_t exposed = c_null_index;
+    size_t depth = 0;
+    for (uint8_t card : table.visible_run(from_col)) {
+        if (depth++ == move.n_cards()) {
+            exposed = card;
+            break;
+        }
+    }
+    return table.can_be_placed_on_foundation(exposed) ||
+           talon_has_child_of(table, exposed) ||
+           piles_have_child_of(table, exposed, from_col, move.to_col());
+}
+
+// How each searched state was first reached: `m_n_draws` stock to waste
+// moves followed by `m_move`.
+struct SearchNode {
+    StateId m_parent;
+    Move m_move;
+    uint8_t m_n_draws{0};
+    bool m_expanded{false};
+    uint32_t m_cost;
+};
+
+struct FrontierEntry {
+    uint32_t m_priority;
+    uint32_t m_n_hidden;
+    uint32_t m_move_value;
+    StateId m_id;
+
+    // Orders the priority queue so that the best entry is on top.
+    auto operator<(const FrontierEntry& other) const -> bool {
+        if (m_priority != other.m_priority) {
+            return m_priority > other.m_priority;
+        }
+        if (m_n_hidden != other.m_n_hidden) {
+            return m_n_hidden > other.m_n_hidden;
+        }
+        return m_move_value < other.m_move_value;
+    }
+};
+
+class BestFirstSearch {
+   public:
+    explicit BestFirstSearch(const Table& table) {
+        Table root = table;
+        root.rehash();
+        m_store.insert(root);
+        m_nodes.push_back(SearchNode{.m_parent = c_null_state,
+                                     .m_move = Move{},
+                                     .m_cost = 0});
+        m_frontier.push(make_entry(root, 0, 0, 0));
+    }
+
+    auto run(size_t max_expansions, std::optional<float> timeout)
+        -> SolveResult {
+        size_t start_time = get_now();
+        while (!m_frontier.empty()) {
+            StateId id = m_frontier.top().m_id;
+            m_frontier.pop();
+            if (m_nodes[id].m_expanded) {
+                continue;
+            }
+            // Copy, as inserting children may reallocate the store.
+            Table current = m_store[id];
+            if (current.is_complete()) {
+                m_result.m_status = SolveStatus::Won;
+                m_result.m_moves = winning_line(id);
+                return m_result;
+            }
+            if (m_result.m_expanded >= max_expansions) {
+                return m_result;
+            }
+            if (timeout &&
+                m_result.m_expanded % SOLVER_TIMEOUT_CHECK_FREQUENCY == 0 &&
+                get_now() - start_time >=
+                    static_cast<size_t>(*timeout * 1000)) {
+                return m_result;
+            }
+            m_nodes[id].m_expanded = true;
+            m_result.m_expanded++;
+            expand(id, current);
+        }
+        m_result.m_status = SolveStatus::Lost;
+        return m_result;
+    }
+
+   private:
+    StateStore m_store;
+    std::vector<SearchNode> m_nodes;
+    std::priority_queue<FrontierEntry> m_frontier;
+    SolveResult m_result;
+
+    static auto make_entry(const Table& table, StateId id, uint32_t cost,
+                           size_t move_value) -> FrontierEntry {
+        size_t n_hidden = n_hidden_cards(table);
+        return FrontierEntry{
+            .m_priority =
+                cost + static_cast<uint32_t>(
+                           SOLVER_HEURISTIC_WEIGHT *
+                           (moves_to_win_lower_bound(table) + n_hidden)),
+            .m_n_hidden = static_cast<uint32_t>(n_hidden),
+            .m_move_value = static_cast<uint32_t>(move_value),
+            .m_id = id,
+        };
+    }
+
+    // Drawing from the stock leaves the tableau and foundations alone, so
+    // rather than searching the states between draws, each card the talon
+    // can bring to the top of the waste is played directly, as a run of
+    // stock to waste moves followed by a waste move.
+    auto expand(StateId id, const Table& current) -> void {
+        uint32_t cost = m_nodes[id].m_cost;
+        MoveList moves = generate_moves(current);
+        if (auto safe_move = find_safe_move(current, moves)) {
+            add_child(id, current, *safe_move, 0, cost + 1);
+            return;
+        }
+        for (const auto& move : moves) {
+            if (move.type() == MoveType::StockToWaste ||
+                (move.type() == MoveType::TableauToTableau &&
+                 !is_useful_tableau_move(current, move))) {
+                continue;
+            }
+            add_child(id, current, move, 0, cost + 1);
+        }
+        TableauTops tops = tableau_tops(current);
+        size_t n_talon =
+            current.n_cards_in_stock() + current.n_cards_in_waste();
+        Table talon = current;
+        // One more draw than there are cards turns the waste over.
+        for (size_t n_draws = 1; n_draws <= n_talon; n_draws++) {
+            stock_to_waste(talon);
+            uint8_t waste_top = talon.waste_top();
+            if (waste_top == c_null_index) {
+                continue;
+            }
+            auto draws = static_cast<uint8_t>(n_draws);
+            uint32_t child_cost = cost + static_cast<uint32_t>(n_draws) + 1;
+            if (talon.can_be_placed_on_foundation(waste_top)) {
+                add_child(id, talon, Move::create_waste_to_foundation(), draws,
+                          child_cost);
+            }
+            for (unsigned targets = tableau_targets(tops, waste_top);
+                 targets != 0; targets &= targets - 1) {
+                add_child(id, talon,
+                          Move::create_waste_to_tableau(
+                              static_cast<size_t>(std::countr_zero(targets))),
+                          draws, child_cost);
+            }
+        }
+    }
+
+    auto add_child(StateId parent, const Table& from, const Move& move,
+                   uint8_t n_draws, uint32_t cost) -> void {
+        size_t value = move_value(move, from);
+        Table child = from;
+        apply_move(child, move);
+        auto [child_id, inserted] = m_store.insert(child);
+        SearchNode node{.m_parent = parent,
+                        .m_move = move,
+                        .m_n_draws = n_draws,
+                        .m_cost = cost};
+        if (inserted) {
+            m_result.m_generated++;
+            m_nodes.push_back(node);
+        } else if (m_nodes[child_id].m_expanded ||
+                   m_nodes[child_id].m_cost <= cost) {
+            return;
+        } else {
+            // A cheaper route to a state still waiting in the frontier; the
+            // old entry is skipped once this one is expanded.
+            m_nodes[child_id] = node;
+        }
+        m_frontier.push(make_entry(child, child_id, cost, value));
+    }
+
+    auto winning_line(StateId id) const -> std::vector<Move> {
+        std::vector<Move> moves;
+        for (; m_nodes[id].m_parent != c_null_state;
+             id = m_nodes[id].m_parent) {
+            moves.push_back(m_nodes[id].m_move);
+            moves.insert(moves.end(), m_nodes[id].m_n_draws,
+                         Move::create_stock_to_waste());
+        }
+        std::ranges::reverse(moves);
+        return moves;
+    }
+};
+
+auto solve_best_first(const Table& table, size_t max_expansions,
+                      std::optional<float> timeout) -> SolveResult {
+    return BestFirstSearch(table).run(max_expansions, timeout);
+}
+
+// One state on the current line of the depth-first search, with the moves
+// still to try from it.
+struct DepthFirstFrame {
+    MoveList m_moves;
+    size_t m_next{0};
+    // How this state was reached from the one below it on the stack.
+    UndoRecord m_undo;
+    uint64_t m_hash;
+    // Whether the transposition table holds this state; if not, it is in
+    // the search's set of unstored states on the current line.
+    bool m_stored;
+    size_t m_expanded_before;
+};
+
+class DepthFirstSearch {
+   public:
+    DepthFirstSearch(const Table& table, size_t tt_bytes)
+        : m_table(table), m_tt(tt_bytes) {
+        m_table.rehash();
+    }
+
+    auto run(size_t max_expansions, std::optional<float> timeout)
+        -> SolveResult {
+        if (m_table.is_complete()) {
+            m_result.m_status = SolveStatus::Won;
+            return m_result;
+        }
+        size_t start_time = get_now();
+        push(UndoRecord{}, std::nullopt);
+        while (!m_stack.empty()) {
+            DepthFirstFrame& frame = m_stack.back();
+            if (frame.m_next == frame.m_moves.size()) {
+                pop();
+                continue;
+            }
+            Move move = frame.m_moves[frame.m_next++];
+            UndoRecord undo = apply_move(m_table, move);
+            m_result.m_generated++;
+            if (m_table.is_complete()) {
+                m_result.m_status = SolveStatus::Won;
+                m_result.m_moves = winning_line(move);
+                return m_result;
+            }
+            if (is_visited(m_table.hash())) {
+                undo_move(m_table, undo);
+                continue;
+            }
+            if (m_result.m_expanded >= max_expansions) {
+                return m_result;
+            }
+            if (timeout &&
+                m_result.m_expanded % SOLVER_TIMEOUT_CHECK_FREQUENCY == 0 &&
+                get_now() - start_time >=
+                    static_cast<size_t>(*timeout * 1000)) {
+                return m_result;
+            }
+            push(undo, move);
+        }
+        m_result.m_status = SolveStatus::Lost;
+        return m_result;
+    }
+
+   private:
+    Table m_table;
+    TranspositionTable m_tt;
+    std::vector<DepthFirstFrame> m_stack;
+    // States on the current line that did not fit in the transposition
+    // table, which only happens once it is full of the line itself.
+    std::unordered_set<uint64_t> m_unstored;
+    SolveResult m_result;
+
+    auto push(const UndoRecord& undo, std::optional<Move> prev_move)
+        -> void {
+        m_result.m_expanded++;
+        MoveList moves = generate_moves(m_table, prev_move);
+        // `compare_moves` orders moves from worst to best.
+        std::sort(moves.begin(), moves.end(),
+                  [this](const Move& a, const Move& b) {
+                      return compare_moves(b, a, m_table);
+                  });
+        uint64_t hash = m_table.hash();
+        bool stored = m_tt.insert_pinned(hash);
+        if (!stored) {
+            m_unstored.insert(hash);
+        }
+        m_stack.push_back(DepthFirstFrame{
+            .m_moves = moves,
+            .m_undo = undo,
+            .m_hash = hash,
+            .m_stored = stored,
+            .m_expanded_before = m_result.m_expanded,
+        });
+    }
+
+    // Backtracks from a state whose moves have all been tried.
+    auto pop() -> void {
+        const DepthFirstFrame& frame = m_stack.back();
+        if (frame.m_stored) {
+            m_tt.release(frame.m_hash,
+                         m_result.m_expanded - frame.m_expanded_before);
+        } else {
+            m_unstored.erase(frame.m_hash);
+        }
+        UndoRecord undo = frame.m_undo;
+        m_stack.pop_back();
+        if (!m_stack.empty()) {
+            undo_move(m_table, undo);
+        }
+    }
+
+    // Whether the state was searched before or is on the current line.
+    // Every state already searched without a win is either in the
+    // transposition table or was evicted from it, in which case it is
+    // searched again.
+    [[nodiscard]] auto is_visited(uint64_t hash) const -> bool {
+        return m_tt.contains(hash) ||
+               (!m_unstored.empty() && m_unstored.contains(hash));
+    }
+
+    auto winning_line(const Move& last) const -> std::vector<Move> {
+        std::vector<Move> moves;
+        moves.reserve(m_stack.size());
+        for (size_t i = 1; i < m_stack.size(); i++) {
+            moves.push_back(m_stack[i].m_undo.m_move);
+        }
+        moves.push_back(last);
+        return moves;
+    }
+};
+
+auto solve_depth_first(const Table& table, size_t tt_bytes,
+                       size_t max_expansions, std::optional<float> timeout)
+    -> SolveResult {
+    return DepthFirstSearch(table, tt_bytes).run(max_expansions, timeout);
+}
@@ -0,0 +1,199 @@
+#include "stack_table.hpp"
+
+#include <algorithm>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+
+#include "common.hpp"
+#include "legality.hpp"
+#include "table.hpp"
+
+StackTable::StackTable(const Table& table) {
+    for (size_t col = 0; col < c_tableau_columns; col++) {
+        size_t n_hidden = table.n_cards_in_hidden_tableau_column(col);
+        size_t n_cards =
+            n_hidden + table.n_cards_in_visible_tableau_column(col);
+        assert(n_cards <= c_max_column_cards);
+        m_n_hidden[col] = static_cast<uint8_t>(n_hidden);
+        m_n_cards[col] = static_cast<uint8_t>(n_cards);
+        // Both linked piles run from the top down.
+        size_t pos = n_cards;
+        for (uint8_t card : table.visible_run(col)) {
+            m_columns[col][--pos] = card;
+        }
+        for (uint8_t card :
+             LinkedPile(table.m_deck.data(), table.hidden_top(col))) {
+            m_columns[col][--pos] = card;
+        }
+    }
+    m_n_waste = static_cast<uint8_t>(table.n_cards_in_waste());
+    m_n_talon = static_cast<uint8_t>(m_n_waste + table.n_cards_in_stock());
+    assert(m_n_talon <= c_max_talon_cards);
+    size_t pos = m_n_waste;
+    for (uint8_t card : LinkedPile(table.m_deck.data(), table.waste_top())) {
+        m_talon[--pos] = card;
+    }
+    pos = m_n_waste;
+    for (uint8_t card : LinkedPile(table.m_deck.data(), table.stock_top())) {
+        m_talon[pos++] = card;
+    }
+    for (size_t suit = 0; suit < c_num_suits; suit++) {
+        uint8_t top = table.foundation_top(suit);
+        m_foundation_counts[suit] =
+            top == c_null_index
+                ? 0
+                : static_cast<uint8_t>(index_to_card(top).second + 1);
+    }
+}
+
+auto StackTable::to_table() const -> Table {
+    Table table;
+    for (size_t col = 0; col < c_tableau_columns; col++) {
+        for (size_t i = 0; i < m_n_hidden[col]; i++) {
+            table.add_to_hidden_tableau_column(col, m_columns[col][i]);
+        }
+        for (size_t i = m_n_hidden[col]; i < m_n_cards[col]; i++) {
+            table.add_to_visible_tableau_column(col, m_columns[col][i]);
+        }
+    }
+    for (size_t i = 0; i < m_n_waste; i++) {
+        table.set_next(m_talon[i], table.waste_top());
+        table.set_waste(m_talon[i]);
+    }
+    for (size_t i = m_n_talon; i > m_n_waste; i--) {
+        table.set_next(m_talon[i - 1], table.stock_top());
+        table.set_stock(m_talon[i - 1]);
+    }
+    for (size_t suit = 0; suit < c_num_suits; suit++) {
+        for (size_t rank = 0; rank < m_foundation_counts[suit]; rank++) {
+            auto card = static_cast<uint8_t>(
+                card_to_index(static_cast<Suit>(suit), rank));
+            table.set_next(card, table.foundation_top(suit));
+            table.set_foundation(suit, card);
+        }
+    }
+    return table;
+}
+
+auto StackTable::can_be_placed_on_foundation(uint8_t card_index) const
+    -> bool {
+    size_t suit = static_cast<size_t>(card_index) % c_num_suits;
+    return (c_foundation_predecessors[static_cast<size_t>(card_index)] &
+            pile_top_bit(foundation_top(suit))) != 0;
+}
+
+auto StackTable::can_be_placed_on_tableau(size_t to_col,
+                                          uint8_t card_index) const -> bool {
+    assert(to_col < c_tableau_columns);
+    return (c_tableau_parents[static_cast<size_t>(card_index)] &
+            pile_top_bit(visible_top(to_col))) != 0;
+}
+
+auto StackTable::is_complete() const -> bool {
+    return std::ranges::all_of(m_foundation_counts, [](uint8_t count) {
+        return count == c_num_cards_in_suit;
+    });
+}
+
+auto StackTable::operator==(const StackTable& other) const -> bool {
+    if (m_n_hidden != other.m_n_hidden || m_n_cards != other.m_n_cards ||
+        m_n_waste != other.m_n_waste || m_n_talon != other.m_n_talon ||
+        m_foundation_counts != other.m_foundation_counts) {
+        return false;
+    }
+    for (size_t col = 0; col < c_tableau_columns; col++) {
+        if (!std::equal(m_columns[col].begin(),
+                        m_columns[col].begin() + m_n_cards[col],
+                        other.m_columns[col].begin())) {
+            return false;
+        }
+    }
+    return std::equal(m_talon.begin(), m_talon.begin() + m_n_talon,
+                      other.m_talon.begin());
+}
+
+auto StackTable::draw_from_stock() -> void {
+    assert(m_n_waste < m_n_talon);
+    m_n_waste++;
+}
+
+auto StackTable::reset_stock_from_waste() -> void { m_n_waste = 0; }
+
+auto StackTable::pop_waste() -> uint8_t {
+    assert(m_n_waste > 0);
+    uint8_t card = m_talon[m_n_waste - 1];
+    // Close the gap so the stock stays contiguous after the waste.
+    std::copy(m_talon.begin() + m_n_waste, m_talon.begin() + m_n_talon,
+              m_talon.begin() + m_n_waste - 1);
+    m_n_waste--;
+    m_n_talon--;
+    return card;
+}
+
+auto StackTable::push_foundation(uint8_t card_index) -> void {
+    size_t suit = static_cast<size_t>(card_index) % c_num_suits;
+    assert(can_be_placed_on_foundation(card_index));
+    m_foundation_counts[suit]++;
+}
+
+auto StackTable::pop_foundation(Suit suit) -> uint8_t {
+    uint8_t card = foundation_top(static_cast<size_t>(suit));
+    assert(card != c_null_index);
+    m_foundation_counts[static_cast<size_t>(suit)]--;
+    return card;
+}
+
+auto StackTable::push_visible(size_t col_idx, uint8_t card_index) -> void {
+    assert(m_n_cards[col_idx] < c_max_column_cards);
+    m_columns[col_idx][m_n_cards[col_idx]++] = card_index;
+}
+
+auto StackTable::pop_visible(size_t col_idx) -> uint8_t {
+    assert(n_cards_in_visible_tableau_column(col_idx) > 0);
+    return m_columns[col_idx][--m_n_cards[col_idx]];
+}
+
+auto StackTable::move_run(size_t from_col, size_t to_col, size_t n_cards)
+    -> void {
+    assert(n_cards <= n_cards_in_visible_tableau_column(from_col));
+    assert(m_n_cards[to_col] + n_cards <= c_max_column_cards);
+    auto from_begin = m_columns[from_col].begin() + m_n_cards[from_col] -
+                      static_cast<std::ptrdiff_t>(n_cards);
+    std::copy_n(from_begin, n_cards,
+                m_columns[to_col].begin() + m_n_cards[to_col]);
+    m_n_cards[from_col] = static_cast<uint8_t>(m_n_cards[from_col] - n_cards);
+    m_n_cards[to_col] = static_cast<uint8_t>(m_n_cards[to_col] + n_cards);
+}
+
+auto StackTable::reveal_hidden(size_t col_idx) -> void {
+    if (m_n_hidden[col_idx] > 0 &&
+        n_cards_in_visible_tableau_column(col_idx) == 0) {
+        m_n_hidden[col_idx]--;
+    }
+}
+
+auto StackTable::return_to_stock() -> void {
+    assert(m_n_waste > 0);
+    m_n_waste--;
+}
+
+auto StackTable::restore_waste_from_stock() -> void {
+    assert(m_n_waste == 0);
+    m_n_waste = m_n_talon;
+}
+
+auto StackTable::push_waste(uint8_t card_index) -> void {
+    assert(m_n_talon < c_max_talon_cards);
+    std::copy_backward(m_talon.begin() + m_n_waste,
+                       m_talon.begin() + m_n_talon,
+                       m_talon.begin() + m_n_talon + 1);
+    m_talon[m_n_waste] = card_index;
+    m_n_waste++;
+    m_n_talon++;
+}
+
+auto StackTable::hide_visible(size_t col_idx) -> void {
+    assert(n_cards_in_visible_tableau_column(col_idx) == 1);
+    m_n_hidden[col_idx]++;
+}
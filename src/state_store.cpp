@@ -0,0 +1,116 @@
+#include "state_store.hpp"
+
+#include <algorithm>
+#include <bit>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+#include "common.hpp"
+#include "table.hpp"
+
+StateStore::StateStore(size_t initial_capacity) {
+    rehash(std::bit_ceil(std::max(initial_capacity, c_min_capacity)));
+}
+
+auto StateStore::probe(const StateKey& key) const -> Probe {
+    size_t pos = static_cast<size_t>(key.m_tag) & m_mask;
+    for (size_t dist = 0;; dist++) {
+        const Slot& slot = m_slots[pos];
+        // Robin Hood invariant: once we pass a slot that is closer to its
+        // home than we are to ours, the key cannot be further along.
+        if (slot.m_id == c_null_state ||
+            probe_distance(pos, slot.m_tag) < dist) {
+            return {.m_pos = pos, .m_dist = dist, .m_id = c_null_state};
+        }
+        if (slot.m_tag == key.m_tag && m_states[slot.m_id] == key.m_state) {
+            return {.m_pos = pos, .m_dist = dist, .m_id = slot.m_id};
+        }
+        pos = (pos + 1) & m_mask;
+    }
+}
+
+auto StateStore::find(const StateKey& key) const -> std::optional<StateId> {
+    StateId id = probe(key).m_id;
+    return id == c_null_state ? std::nullopt : std::optional(id);
+}
+
+auto StateStore::insert(const StateKey& key) -> std::pair<StateId, bool> {
+    Probe found = probe(key);
+    if (found.m_id != c_null_state) {
+        return {found.m_id, false};
+    }
+    if (m_states.size() >= static_cast<size_t>(c_null_state)) {
+        throw std::length_error("StateStore is full");
+    }
+    auto id = static_cast<StateId>(m_states.size());
+    m_states.push_back(key.m_state);
+    Slot slot{.m_tag = key.m_tag, .m_id = id};
+    if (m_states.size() * c_max_load_den > m_slots.size() * c_max_load_num) {
+        rehash(m_slots.size() * 2);
+        place(slot);
+    } else {
+        // Placing from the home slot would pass the same slots as the
+        // probe did without displacing any of them.
+        place(slot, found.m_pos, found.m_dist);
+    }
+    return {id, true};
+}
+
+auto StateStore::reserve(size_t n_states) -> void {
+    m_states.reserve(n_states);
+    size_t n_slots = std::bit_ceil(
+        std::max((n_states * c_max_load_den / c_max_load_num) + 1,
+                 c_min_capacity));
+    if (n_slots > m_slots.size()) {
+        rehash(n_slots);
+    }
+}
+
+auto StateStore::memory_usage(size_t n_inserts) const -> size_t {
+    size_t n_slots = m_slots.size();
+    while ((m_states.size() + n_inserts) * c_max_load_den >
+           n_slots * c_max_load_num) {
+        n_slots *= 2;
+    }
+    return vector_bytes_after(m_states, n_inserts) + (n_slots * sizeof(Slot));
+}
+
+auto StateStore::clear() -> void {
+    m_states.clear();
+    std::fill(m_slots.begin(), m_slots.end(),
+              Slot{.m_tag = 0, .m_id = c_null_state});
+}
+
+auto StateStore::place(Slot slot, size_t pos, size_t dist) -> void {
+    while (true) {
+        Slot& occupant = m_slots[pos];
+        if (occupant.m_id == c_null_state) {
+            occupant = slot;
+            return;
+        }
+        size_t occupant_dist = probe_distance(pos, occupant.m_tag);
+        if (occupant_dist < dist) {
+            std::swap(occupant, slot);
+            dist = occupant_dist;
+        }
+        pos = (pos + 1) & m_mask;
+        dist++;
+    }
+}
+
+auto StateStore::rehash(size_t n_slots) -> void {
+    assert(std::has_single_bit(n_slots));
+    std::vector<Slot> slots(n_slots, Slot{.m_tag = 0, .m_id = c_null_state});
+    std::swap(m_slots, slots);
+    m_mask = n_slots - 1;
+    for (const Slot& slot : slots) {
+        if (slot.m_id != c_null_state) {
+            place(slot);
+        }
+    }
+}
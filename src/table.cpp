@@ -10,12 +10,14 @@
 #include <vector>
 
 #include "common.hpp"
+#include "legality.hpp"
 
 Table::Table(const std::array<uint8_t, c_num_cards>& deck) {
     m_foundation_indices.fill(c_null_index);
     m_tableau_visible_indices.fill(c_null_index);
     m_tableau_hidden_indices.fill(c_null_index);
     m_deck.fill(c_null_index);
+    rehash();
     size_t deck_i = 0;
     for (size_t i = 0; i < c_tableau_columns; i++) {
         assert(deck_i < c_num_cards);
@@ -25,9 +27,9 @@ Table::Table(const std::array<uint8_t, c_num_cards>& deck) {
         }
         add_to_visible_tableau_column(i, deck[deck_i++]);
     }
-    m_stock_index = deck[deck_i++];
+    set_stock(deck[deck_i++]);
     for (; deck_i < c_num_cards; deck_i++) {
-        m_deck[static_cast<size_t>(deck[deck_i - 1])] = deck[deck_i];
+        set_next(deck[deck_i - 1], deck[deck_i]);
     }
 }
 
@@ -154,12 +156,12 @@ auto Table::add_to_hidden_tableau_column(size_t col_idx, uint8_t card_index)
     -> void {
     assert(col_idx < c_tableau_columns);
     if (m_tableau_hidden_indices[col_idx] == c_null_index) {
-        m_tableau_hidden_indices[col_idx] = card_index;
+        set_hidden(col_idx, card_index);
     } else {
         // Place on top of the hidden column, replacing the top pointer
         uint8_t last_index = m_tableau_hidden_indices[col_idx];
-        m_deck[static_cast<size_t>(card_index)] = last_index;
-        m_tableau_hidden_indices[col_idx] = card_index;
+        set_next(card_index, last_index);
+        set_hidden(col_idx, card_index);
     }
 }
 
@@ -167,13 +169,13 @@ auto Table::add_to_visible_tableau_column(size_t col_idx, uint8_t card_index)
     -> void {
     assert(col_idx < c_tableau_columns);
     if (m_tableau_visible_indices[col_idx] == c_null_index) {
-        m_tableau_visible_indices[col_idx] = card_index;
-        m_deck[static_cast<size_t>(card_index)] = c_null_index;
+        set_visible(col_idx, card_index);
+        set_next(card_index, c_null_index);
     } else {
         // Place on top of the visible column, replacing the top pointer
         uint8_t last_index = m_tableau_visible_indices[col_idx];
-        m_deck[static_cast<size_t>(card_index)] = last_index;
-        m_tableau_visible_indices[col_idx] = card_index;
+        set_next(card_index, last_index);
+        set_visible(col_idx, card_index);
     }
 }
 
@@ -184,20 +186,21 @@ auto Table::move_from_hidden_to_visible(size_t col_idx) -> void {
         return;
     }
     uint8_t next_hidden = m_deck[static_cast<size_t>(hidden_top)];
-    m_tableau_hidden_indices[col_idx] = next_hidden;
+    set_hidden(col_idx, next_hidden);
     assert(m_tableau_visible_indices[col_idx] == c_null_index);
-    m_tableau_visible_indices[col_idx] = hidden_top;
-    m_deck[static_cast<size_t>(hidden_top)] = c_null_index;
+    set_visible(col_idx, hidden_top);
+    set_next(hidden_top, c_null_index);
 }
 
 auto Table::move_from_stock_to_waste() -> void {
     if (m_stock_index == c_null_index) {
         return;
     }
-    uint8_t next_stock = m_deck[static_cast<size_t>(m_stock_index)];
-    m_deck[static_cast<size_t>(m_stock_index)] = m_waste_index;
-    m_waste_index = m_stock_index;
-    m_stock_index = next_stock;
+    uint8_t stock_top = m_stock_index;
+    uint8_t next_stock = m_deck[static_cast<size_t>(stock_top)];
+    set_next(stock_top, m_waste_index);
+    set_waste(stock_top);
+    set_stock(next_stock);
 }
 
 auto Table::reset_stock_from_waste() -> void {
@@ -208,40 +211,58 @@ auto Table::reset_stock_from_waste() -> void {
     uint8_t curr = m_waste_index;
     while (curr != c_null_index) {
         uint8_t next = m_deck[static_cast<size_t>(curr)];
-        m_deck[static_cast<size_t>(curr)] = prev;
+        set_next(curr, prev);
         prev = curr;
         curr = next;
     }
-    m_stock_index = prev;
-    m_waste_index = c_null_index;
+    set_stock(prev);
+    set_waste(c_null_index);
 }
 
-auto Table::can_be_placed_on_foundation(uint8_t card_index) const -> bool {
-    auto [card_suit, card_rank] =
-        index_to_card(static_cast<size_t>(card_index));
-    uint8_t foundation_top =
-        m_foundation_indices[static_cast<size_t>(card_suit)];
-    if (foundation_top == c_null_index) {
-        return card_rank == 0;
+auto Table::move_from_visible_to_hidden(size_t col_idx) -> void {
+    assert(col_idx < c_tableau_columns);
+    assert(n_cards_in_visible_tableau_column(col_idx) == 1);
+    uint8_t visible_top = m_tableau_visible_indices[col_idx];
+    set_visible(col_idx, c_null_index);
+    set_next(visible_top, m_tableau_hidden_indices[col_idx]);
+    set_hidden(col_idx, visible_top);
+}
+
+auto Table::move_from_waste_to_stock() -> void {
+    if (m_waste_index == c_null_index) {
+        return;
+    }
+    uint8_t waste_top = m_waste_index;
+    set_waste(m_deck[static_cast<size_t>(waste_top)]);
+    set_next(waste_top, m_stock_index);
+    set_stock(waste_top);
+}
+
+auto Table::restore_waste_from_stock() -> void {
+    assert(m_waste_index == c_null_index);
+    uint8_t prev = c_null_index;
+    uint8_t curr = m_stock_index;
+    while (curr != c_null_index) {
+        uint8_t next = m_deck[static_cast<size_t>(curr)];
+        set_next(curr, prev);
+        prev = curr;
+        curr = next;
     }
-    auto [foundation_suit, foundation_rank] =
-        index_to_card(static_cast<size_t>(foundation_top));
-    return (card_rank == foundation_rank + 1) && (card_suit == foundation_suit);
+    set_waste(prev);
+    set_stock(c_null_index);
+}
+
+auto Table::can_be_placed_on_foundation(uint8_t card_index) const -> bool {
+    size_t suit = static_cast<size_t>(card_index) % c_num_suits;
+    return (c_foundation_predecessors[static_cast<size_t>(card_index)] &
+            pile_top_bit(m_foundation_indices[suit])) != 0;
 }
 
 auto Table::can_be_placed_on_tableau(size_t to_col, uint8_t card_index) const
     -> bool {
     assert(to_col < c_tableau_columns);
-    uint8_t tableau_top = m_tableau_visible_indices[to_col];
-    auto [card_suit, card_rank] =
-        index_to_card(static_cast<size_t>(card_index));
-    if (tableau_top == c_null_index) {
-        return card_rank == c_num_cards_in_suit - 1;
-    }
-    auto [tableau_suit, tableau_rank] =
-        index_to_card(static_cast<size_t>(tableau_top));
-    return (card_rank + 1 == tableau_rank) &&
-           (!suit_colours_equal(card_suit, tableau_suit));
+    return (c_tableau_parents[static_cast<size_t>(card_index)] &
+            pile_top_bit(m_tableau_visible_indices[to_col])) != 0;
 }
 
 auto Table::is_complete() const -> bool {
@@ -259,27 +280,51 @@ auto Table::is_complete() const -> bool {
     return true;
 }
 
-template <class T>
-inline void hash_combine(std::size_t& seed, const T& v) {
-    std::hash<T> hasher;
-    seed ^= hasher(v) + 0x9e3779b9 + (seed << 6) + (seed >> 2);
+auto Table::pack() const -> PackedTable {
+    PackedTable packed{};
+    packed[c_stock_offset] = m_stock_index;
+    packed[c_waste_offset] = m_waste_index;
+    std::ranges::copy(m_foundation_indices,
+                      packed.begin() + c_foundation_offset);
+    std::ranges::copy(m_tableau_visible_indices,
+                      packed.begin() + c_visible_offset);
+    std::ranges::copy(m_tableau_hidden_indices,
+                      packed.begin() + c_hidden_offset);
+    std::ranges::copy(m_deck, packed.begin() + c_deck_offset);
+    return packed;
 }
 
-auto Table::hash() const -> std::size_t {
-    std::size_t seed = 0;
-    for (uint8_t index : m_foundation_indices) {
-        hash_combine(seed, index);
-    }
-    for (uint8_t index : m_tableau_visible_indices) {
-        hash_combine(seed, index);
+auto Table::unpack(const PackedTable& packed) -> Table {
+    Table table{Unhashed{}};
+    table.m_stock_index = packed[c_stock_offset];
+    table.m_waste_index = packed[c_waste_offset];
+    auto copy_field = [&packed](size_t offset, auto& field) {
+        std::copy_n(packed.begin() + static_cast<std::ptrdiff_t>(offset),
+                    field.size(), field.begin());
+    };
+    copy_field(c_foundation_offset, table.m_foundation_indices);
+    copy_field(c_visible_offset, table.m_tableau_visible_indices);
+    copy_field(c_hidden_offset, table.m_tableau_hidden_indices);
+    copy_field(c_deck_offset, table.m_deck);
+    table.rehash();
+    return table;
+}
+
+auto Table::full_hash() const -> uint64_t {
+    uint64_t hash = zobrist_key(c_stock_offset, m_stock_index) ^
+                    zobrist_key(c_waste_offset, m_waste_index);
+    for (size_t suit = 0; suit < c_num_suits; suit++) {
+        hash ^= zobrist_key(c_foundation_offset + suit,
+                            m_foundation_indices[suit]);
     }
-    for (uint8_t index : m_tableau_hidden_indices) {
-        hash_combine(seed, index);
+    for (size_t col = 0; col < c_tableau_columns; col++) {
+        hash ^= zobrist_key(c_visible_offset + col,
+                            m_tableau_visible_indices[col]);
+        hash ^=
+            zobrist_key(c_hidden_offset + col, m_tableau_hidden_indices[col]);
     }
-    hash_combine(seed, m_stock_index);
-    hash_combine(seed, m_waste_index);
-    for (uint8_t index : m_deck) {
-        hash_combine(seed, index);
+    for (size_t card = 0; card < c_num_cards; card++) {
+        hash ^= zobrist_key(c_deck_offset + card, m_deck[card]);
     }
-    return seed;
+    return hash;
 }
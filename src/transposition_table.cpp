@@ -0,0 +1,75 @@
+#include "transposition_table.hpp"
+
+#include <algorithm>
+#include <bit>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <stdexcept>
+
+TranspositionTable::TranspositionTable(size_t n_bytes) {
+    size_t n_buckets = n_bytes / sizeof(Bucket);
+    if (n_buckets == 0) {
+        throw std::invalid_argument(
+            "Transposition table needs at least one bucket");
+    }
+    // Round down so that the bucket index is a mask of the hash.
+    n_buckets = std::bit_floor(n_buckets);
+    m_buckets.resize(n_buckets);
+    m_mask = n_buckets - 1;
+}
+
+auto TranspositionTable::contains(uint64_t hash) const -> bool {
+    uint64_t key = key_of(hash);
+    const Bucket& bucket = bucket_of(key);
+    return std::ranges::any_of(bucket.m_entries, [key](const Entry& entry) {
+        return entry.m_key == key;
+    });
+}
+
+auto TranspositionTable::insert_pinned(uint64_t hash) -> bool {
+    uint64_t key = key_of(hash);
+    Bucket& bucket = bucket_of(key);
+    Entry* victim = nullptr;
+    for (Entry& entry : bucket.m_entries) {
+        if (entry.m_key == key || entry.m_key == 0) {
+            victim = &entry;
+            break;
+        }
+        if (entry.m_pinned == 0 &&
+            (victim == nullptr || entry.m_work < victim->m_work)) {
+            victim = &entry;
+        }
+    }
+    if (victim == nullptr) {
+        return false;
+    }
+    if (victim->m_key == 0) {
+        m_size++;
+    } else if (victim->m_key != key) {
+        m_n_replaced++;
+    }
+    *victim = Entry{.m_key = key, .m_work = 0, .m_pinned = 1};
+    return true;
+}
+
+auto TranspositionTable::release(uint64_t hash, size_t work) -> void {
+    uint64_t key = key_of(hash);
+    for (Entry& entry : bucket_of(key).m_entries) {
+        if (entry.m_key == key) {
+            assert(entry.m_pinned != 0);
+            entry.m_pinned = 0;
+            entry.m_work = static_cast<uint32_t>(
+                std::min<size_t>(work, std::numeric_limits<uint32_t>::max()));
+            return;
+        }
+    }
+    assert(false && "Released a hash that was never pinned");
+}
+
+auto TranspositionTable::clear() -> void {
+    std::ranges::fill(m_buckets, Bucket{});
+    m_size = 0;
+    m_n_replaced = 0;
+}
@@ -0,0 +1,23 @@
+#pragma once
+
+#include <catch2/catch_test_macros.hpp>
+
+#include <algorithm>
+
+#include "graph.hpp"
+
+// Requires the two graphs to have the same nodes, ids, depths, frontier
+// and edge runs.
+inline auto require_same_graph(const Graph& a, const Graph& b) -> void {
+    REQUIRE(a.size() == b.size());
+    REQUIRE(a.n_edges() == b.n_edges());
+    REQUIRE(a.frontier_begin() == b.frontier_begin());
+    for (NodeId id = 0; id < a.size(); id++) {
+        REQUIRE(a.table(id) == b.table(id));
+        REQUIRE(a.node(id).m_depth == b.node(id).m_depth);
+        REQUIRE(std::ranges::equal(
+            a.edges(id), b.edges(id), [](const Edge& x, const Edge& y) {
+                return x.m_to == y.m_to && x.m_move == y.m_move;
+            }));
+    }
+}
@@ -0,0 +1,93 @@
+#pragma once
+
+#include <catch2/catch_test_macros.hpp>
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <sys/time.h>
+#include <unistd.h>
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <utility>
+
+// A connection to a server on the loopback interface, whose reads give
+// up after a few seconds rather than hang a failing test.
+class TestClient {
+   public:
+    explicit TestClient(uint16_t port)
+        : m_fd(::socket(AF_INET, SOCK_STREAM, 0)) {
+        REQUIRE(m_fd >= 0);
+        timeval timeout{.tv_sec = 5, .tv_usec = 0};
+        ::setsockopt(m_fd, SOL_SOCKET, SO_RCVTIMEO, &timeout,
+                     sizeof(timeout));
+        sockaddr_in address{};
+        address.sin_family = AF_INET;
+        address.sin_port = htons(port);
+        address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        REQUIRE(::connect(m_fd, reinterpret_cast<sockaddr*>(&address),
+                          sizeof(address)) == 0);
+    }
+    ~TestClient() { ::close(m_fd); }
+    TestClient(const TestClient&) = delete;
+    auto operator=(const TestClient&) -> TestClient& = delete;
+
+    auto get(std::string_view path) -> void {
+        send("GET " + std::string(path) +
+             " HTTP/1.1\r\nHost: localhost\r\n\r\n");
+    }
+
+    // Everything received up to and including `text`, or up to the
+    // connection closing or the read timing out.
+    auto read_until(std::string_view text) -> std::string {
+        while (m_received.find(text) == std::string::npos && receive()) {
+        }
+        return m_received;
+    }
+
+    // The status and body of the next response, which must have a
+    // Content-Length.
+    auto read_response() -> std::pair<int, std::string> {
+        constexpr std::string_view c_length = "Content-Length: ";
+        size_t head_end;
+        while ((head_end = m_received.find("\r\n\r\n")) ==
+               std::string::npos) {
+            REQUIRE(receive());
+        }
+        std::string head = m_received.substr(0, head_end);
+        size_t length_start = head.find(c_length);
+        REQUIRE(length_start != std::string::npos);
+        size_t length = std::stoul(head.substr(length_start + c_length.size()));
+        size_t body_start = head_end + 4;
+        while (m_received.size() < body_start + length) {
+            REQUIRE(receive());
+        }
+        int status = std::stoi(head.substr(head.find(' ') + 1));
+        std::string body = m_received.substr(body_start, length);
+        m_received.erase(0, body_start + length);
+        return {status, body};
+    }
+
+    auto send(std::string_view data) -> void {
+        REQUIRE(::send(m_fd, data.data(), data.size(), 0) ==
+                static_cast<ssize_t>(data.size()));
+    }
+
+   private:
+    int m_fd;
+    std::string m_received;
+
+    auto receive() -> bool {
+        std::array<char, 4096> buffer;
+        ssize_t n = ::recv(m_fd, buffer.data(), buffer.size(), 0);
+        if (n <= 0) {
+            return false;
+        }
+        m_received.append(buffer.data(), static_cast<size_t>(n));
+        return true;
+    }
+};
@@ -0,0 +1,39 @@
+#pragma once
+
+#include <unistd.h>
+
+#include <atomic>
+#include <cstddef>
+#include <filesystem>  // NOLINT(build/c++17)
+#include <string>
+#include <string_view>
+#include <system_error>
+
+// A path in the temporary directory that no other test uses, whether in
+// this process or in another one started by `ctest -j`. Whatever is at the
+// path is removed when it goes out of scope.
+class TempPath {
+   public:
+    explicit TempPath(std::string_view name)
+        : m_path(std::filesystem::temp_directory_path() /
+                 ("rose-test-" + std::to_string(getpid()) + "-" +
+                  std::to_string(next_id()) + "-" + std::string(name))) {}
+    TempPath(const TempPath&) = delete;
+    auto operator=(const TempPath&) -> TempPath& = delete;
+    ~TempPath() {
+        std::error_code error;
+        std::filesystem::remove_all(m_path, error);
+    }
+
+    [[nodiscard]] auto path() const -> const std::filesystem::path& {
+        return m_path;
+    }
+
+   private:
+    std::filesystem::path m_path;
+
+    static auto next_id() -> size_t {
+        static std::atomic<size_t> id{0};
+        return id++;
+    }
+};
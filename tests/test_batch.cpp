@@ -0,0 +1,78 @@
+#include <catch2/catch_test_macros.hpp>
+
+#include <algorithm>
+#include <cstddef>
+#include <optional>
+#include <random>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "batch.hpp"
+#include "common.hpp"
+#include "res_config.hpp"
+
+TEST_CASE("Parse corpus lines", "[batch]") {
+    REQUIRE_FALSE(parse_corpus_line("", 0));
+    REQUIRE_FALSE(parse_corpus_line("  \r", 0));
+    REQUIRE_FALSE(parse_corpus_line("# seeds 1 to 10", 0));
+
+    auto seeded = parse_corpus_line(" 42\r", 3);
+    REQUIRE(seeded);
+    REQUIRE(seeded->m_index == 3);
+    REQUIRE(seeded->m_seed == 42);
+    std::optional<std::mt19937> rng = std::mt19937(42);
+    REQUIRE(seeded->m_deck == random_deck(rng));
+
+    auto deck = import_deck(res_dir / "random-deck.txt");
+    std::string line;
+    for (uint8_t card : deck) {
+        line += card_to_string(card) + " ";
+    }
+    auto dealt = parse_corpus_line(line, 0);
+    REQUIRE(dealt);
+    REQUIRE_FALSE(dealt->m_seed);
+    REQUIRE(dealt->m_deck == deck);
+
+    REQUIRE_THROWS_AS(parse_corpus_line("-1", 0), std::invalid_argument);
+    REQUIRE_THROWS_AS(parse_corpus_line("12x", 0), std::invalid_argument);
+    REQUIRE_THROWS_AS(parse_corpus_line("A♠ 2♠", 0), std::invalid_argument);
+    line.replace(0, line.find(' '), card_to_string(deck[1]));
+    REQUIRE_THROWS_AS(parse_corpus_line(line, 0), std::invalid_argument);
+}
+
+TEST_CASE("Run a batch", "[batch]") {
+    std::istringstream in("# seeds\n1\n2\n\n3\n4\n5\n6\n7\n");
+    CorpusReader corpus(in);
+    std::ostringstream out;
+    auto job = [](const CorpusDeck& deck) -> nlohmann::json {
+        return {{"first", deck.m_deck[0]}};
+    };
+    REQUIRE(run_batch(corpus, 3, job, out) == 7);
+
+    std::istringstream records(out.str());
+    std::vector<size_t> indices;
+    std::string record_line;
+    while (std::getline(records, record_line)) {
+        auto record = nlohmann::json::parse(record_line);
+        indices.push_back(record["deck"].get<size_t>());
+        REQUIRE(record["seed"].get<size_t>() == indices.back() + 1);
+    }
+    std::ranges::sort(indices);
+    REQUIRE(indices == std::vector<size_t>{0, 1, 2, 3, 4, 5, 6});
+
+    SECTION("Errors stop the batch") {
+        std::istringstream bad_in("1\n2\nthree\n4\n");
+        CorpusReader bad_corpus(bad_in);
+        REQUIRE_THROWS_AS(run_batch(bad_corpus, 2, job, out),
+                          std::invalid_argument);
+        std::istringstream good_in("1\n2\n");
+        CorpusReader good_corpus(good_in);
+        auto failing_job = [](const CorpusDeck&) -> nlohmann::json {
+            throw std::runtime_error("job failed");
+        };
+        REQUIRE_THROWS_AS(run_batch(good_corpus, 2, failing_job, out),
+                          std::runtime_error);
+    }
+}
@@ -0,0 +1,115 @@
+#include <catch2/catch_test_macros.hpp>
+
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>  // NOLINT(build/c++17)
+#include <fstream>
+#include <optional>
+#include <stdexcept>
+
+#include "checkpoint.hpp"
+#include "graph.hpp"
+#include "graph_checks.hpp"
+#include "res_config.hpp"
+#include "solver.hpp"
+#include "temp_path.hpp"
+
+TEST_CASE("Checkpoints round trip", "[checkpoint]") {
+    auto deck = import_deck(res_dir / "random-deck.txt");
+    Graph graph{Table(deck)};
+    // Stop partway through a level, so the frontier starts mid-level.
+    graph.generate_bfs(10, std::nullopt, 1, size_t{1} << 20);
+    REQUIRE(graph.frontier_begin() > 0);
+    REQUIRE(graph.frontier_begin() < graph.size());
+
+    TempPath path("checkpoint.bin");
+    write_checkpoint(graph, path.path());
+    Graph loaded = read_checkpoint(path.path());
+    require_same_graph(loaded, graph);
+    REQUIRE(loaded.table(Graph::c_root).hash() ==
+            graph.table(Graph::c_root).hash());
+}
+
+TEST_CASE("Resuming from a checkpoint matches an uninterrupted BFS",
+          "[checkpoint]") {
+    auto deck = import_deck(res_dir / "random-deck.txt");
+    Table table(deck);
+    Graph uninterrupted(table);
+    size_t budget = uninterrupted.generate_bfs(8).m_memory_bytes / 2;
+
+    TempPath path("checkpoint.bin");
+    for (size_t n_threads : {1, 2}) {
+        Graph graph(table);
+        auto report = graph.generate_bfs(8, std::nullopt, n_threads, budget);
+        REQUIRE(report.m_stop == BfsStop::MaxMemory);
+        write_checkpoint(graph, path.path());
+        Graph resumed = read_checkpoint(path.path());
+        report = resumed.generate_bfs(8, std::nullopt, n_threads);
+        REQUIRE(report.m_stop == BfsStop::MaxDepth);
+        REQUIRE(report.m_depth == 8);
+        require_same_graph(resumed, uninterrupted);
+    }
+}
+
+TEST_CASE("Checkpoints of graphs with moved edge runs resume", "[checkpoint]") {
+    // Nodes added by a DFS or a solver's path already have edges when the
+    // BFS expands them, so their runs are moved and the edge array holds
+    // slots that are not edges of any node.
+    Table table(import_deck(res_dir / "random-deck.txt"));
+    auto moves = solve_best_first(table).m_moves;
+    TempPath path("checkpoint.bin");
+    for (bool dfs : {false, true}) {
+        Graph uninterrupted(table);
+        Graph graph(table);
+        for (Graph* g : {&uninterrupted, &graph}) {
+            if (dfs) {
+                g->generate_dfs();
+            } else {
+                g->add_path(moves);
+            }
+        }
+        uninterrupted.generate_bfs(4);
+        graph.generate_bfs(3);
+        write_checkpoint(graph, path.path());
+        Graph resumed = read_checkpoint(path.path());
+        require_same_graph(resumed, graph);
+        REQUIRE(resumed.generate_bfs(4).m_stop == BfsStop::MaxDepth);
+        require_same_graph(resumed, uninterrupted);
+    }
+}
+
+TEST_CASE("Invalid checkpoints are rejected", "[checkpoint]") {
+    TempPath temp("checkpoint.bin");
+    const auto& path = temp.path();
+    REQUIRE_THROWS_AS(read_checkpoint(path.string() + ".missing"),
+                      std::runtime_error);
+    {
+        std::ofstream out(path, std::ios::binary);
+        out << "not a checkpoint";
+    }
+    REQUIRE_THROWS_AS(read_checkpoint(path), std::runtime_error);
+
+    Graph graph{Table(import_deck(res_dir / "random-deck.txt"))};
+    graph.generate_bfs(2);
+    write_checkpoint(graph, path);
+    std::filesystem::resize_file(path,
+                                 std::filesystem::file_size(path) - 1);
+    REQUIRE_THROWS_AS(read_checkpoint(path), std::runtime_error);
+
+    // The last edge's move, which ends the file, gets a type past
+    // `MoveType::FoundationToTableau`.
+    write_checkpoint(graph, path);
+    {
+        std::fstream file(path, std::ios::binary | std::ios::in |
+                                    std::ios::out);
+        file.seekg(-static_cast<std::streamoff>(sizeof(uint16_t)),
+                   std::ios::end);
+        uint16_t bits = 0;
+        file.read(reinterpret_cast<char*>(&bits), sizeof(bits));
+        bits |= 7;
+        file.seekp(-static_cast<std::streamoff>(sizeof(uint16_t)),
+                   std::ios::end);
+        file.write(reinterpret_cast<const char*>(&bits), sizeof(bits));
+    }
+    REQUIRE_THROWS_AS(read_checkpoint(path), std::runtime_error);
+}
@@ -0,0 +1,82 @@
+#include <catch2/catch_test_macros.hpp>
+
+#include <cstddef>
+#include <cstdint>
+#include <numeric>
+#include <vector>
+
+#include "coarsen.hpp"
+#include "graph.hpp"
+#include "res_config.hpp"
+
+TEST_CASE("Weighted graphs have every edge both ways", "[coarsen]") {
+    Graph graph{Table(import_deck(res_dir / "random-deck.txt"))};
+    graph.generate_bfs(5);
+    auto weighted = weighted_graph_of(graph);
+    REQUIRE(weighted.size() == graph.size());
+    auto weight = [&](uint32_t from, uint32_t to) {
+        float total = 0.0F;
+        for (uint32_t e = weighted.m_offsets[from];
+             e < weighted.m_offsets[from + 1]; e++) {
+            if (weighted.m_neighbours[e] == to) {
+                total += weighted.m_weights[e];
+            }
+        }
+        return total;
+    };
+    for (uint32_t node = 0; node < weighted.size(); node++) {
+        REQUIRE(weighted.m_masses[node] ==
+                static_cast<float>(weighted.m_offsets[node + 1] -
+                                   weighted.m_offsets[node]) +
+                    1.0F);
+        for (uint32_t e = weighted.m_offsets[node];
+             e < weighted.m_offsets[node + 1]; e++) {
+            uint32_t other = weighted.m_neighbours[e];
+            REQUIRE(other != node);
+            REQUIRE(weight(node, other) == weight(other, node));
+        }
+    }
+}
+
+TEST_CASE("Coarsening clusters every level", "[coarsen]") {
+    Graph graph{Table(import_deck(res_dir / "random-deck.txt"))};
+    graph.generate_bfs(12);
+    constexpr size_t max_nodes = 100;
+    auto coarsening = coarsen_graph(graph, max_nodes);
+    const auto& levels = coarsening.m_levels;
+    REQUIRE(levels.size() > 2);
+    REQUIRE(coarsening.m_clusters.size() == levels.size() - 1);
+    REQUIRE(levels.front().size() == graph.size());
+    for (size_t level = 0; level + 1 < levels.size(); level++) {
+        const auto& fine = levels[level];
+        const auto& coarse = levels[level + 1];
+        const auto& cluster = coarsening.m_clusters[level];
+        REQUIRE(cluster.size() == fine.size());
+        REQUIRE(coarse.size() < fine.size());
+        // Every cluster has nodes, and its first node is its smallest.
+        std::vector<float> masses(coarse.size(), 0.0F);
+        uint32_t next_cluster = 0;
+        for (uint32_t node = 0; node < fine.size(); node++) {
+            REQUIRE(cluster[node] <= next_cluster);
+            if (cluster[node] == next_cluster) {
+                next_cluster++;
+            }
+            masses[cluster[node]] += fine.m_masses[node];
+        }
+        REQUIRE(next_cluster == coarse.size());
+        REQUIRE(masses == coarse.m_masses);
+        auto total_weight = [](const WeightedGraph& g) {
+            return std::accumulate(g.m_weights.begin(), g.m_weights.end(),
+                                   0.0);
+        };
+        REQUIRE(total_weight(coarse) <= total_weight(fine));
+    }
+}
+
+TEST_CASE("Small graphs are not coarsened", "[coarsen]") {
+    Graph graph{Table(import_deck(res_dir / "random-deck.txt"))};
+    graph.generate_bfs(2);
+    auto coarsening = coarsen_graph(graph, graph.size());
+    REQUIRE(coarsening.m_levels.size() == 1);
+    REQUIRE(coarsening.m_clusters.empty());
+}
@@ -0,0 +1,60 @@
+#include <catch2/catch_test_macros.hpp>
+
+#include <cstddef>
+#include <stdexcept>
+#include <string>
+
+#include "event_server.hpp"
+#include "http_client.hpp"
+
+TEST_CASE("Events are streamed to clients", "[event_server]") {
+    EventServer server(0);
+    REQUIRE(server.port() != 0);
+    server.publish("batch", R"({"nodes":[0]})");
+    TestClient client(server.port());
+    client.get("/events");
+    auto received = client.read_until("\n\n");
+    REQUIRE(received.starts_with("HTTP/1.1 200 OK\r\n"));
+    REQUIRE(received.find("Content-Type: text/event-stream\r\n") !=
+            std::string::npos);
+    received = client.read_until("[0]}\n\n");
+    REQUIRE(received.ends_with("event: batch\ndata: {\"nodes\":[0]}\n\n"));
+    server.publish("done", "{}");
+    received = client.read_until("event: done\ndata: {}\n\n");
+    REQUIRE(received.ends_with("event: done\ndata: {}\n\n"));
+}
+
+TEST_CASE("Late clients are sent every event", "[event_server]") {
+    EventServer server(0);
+    server.publish("batch", "1");
+    server.publish("batch", "2");
+    TestClient first(server.port());
+    first.get("/events?from=start");
+    REQUIRE(first.read_until("data: 2\n\n").ends_with("data: 2\n\n"));
+    TestClient second(server.port());
+    second.get("/events");
+    auto received = second.read_until("data: 2\n\n");
+    REQUIRE(received.find("data: 1\n\n") < received.find("data: 2\n\n"));
+}
+
+TEST_CASE("Kept events count towards memory usage", "[event_server]") {
+    EventServer server(0);
+    size_t empty = server.memory_usage();
+    std::string data(1000, 'x');
+    server.publish("batch", data);
+    server.publish("batch", data);
+    REQUIRE(server.memory_usage() >= empty + (2 * data.size()));
+}
+
+TEST_CASE("Other paths are not found", "[event_server]") {
+    EventServer server(0);
+    TestClient client(server.port());
+    client.get("/graph.json");
+    REQUIRE(client.read_until("\r\n\r\n")
+                .starts_with("HTTP/1.1 404 Not Found\r\n"));
+}
+
+TEST_CASE("Servers cannot share a port", "[event_server]") {
+    EventServer server(0);
+    REQUIRE_THROWS_AS(EventServer(server.port()), std::runtime_error);
+}
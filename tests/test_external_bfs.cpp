@@ -0,0 +1,69 @@
+#include <catch2/catch_test_macros.hpp>
+
+#include <cstddef>
+#include <filesystem>  // NOLINT(build/c++17)
+#include <vector>
+
+#include "common.hpp"
+#include "external_bfs.hpp"
+#include "graph.hpp"
+#include "res_config.hpp"
+#include "table.hpp"
+#include "temp_path.hpp"
+
+TEST_CASE("Pack and unpack tables", "[external_bfs]") {
+    auto deck = import_deck(res_dir / "random-deck.txt");
+    Table table(deck);
+    auto packed = table.pack();
+    REQUIRE(packed[0] == table.m_stock_index);
+    Table unpacked = Table::unpack(packed);
+    REQUIRE(unpacked == table);
+    REQUIRE(unpacked.hash() == table.hash());
+}
+
+TEST_CASE("External BFS matches the in-memory BFS", "[external_bfs]") {
+    constexpr size_t max_depth = 6;
+    auto deck = import_deck(res_dir / "random-deck.txt");
+    Table table(deck);
+    Graph graph(table);
+    graph.generate_bfs(max_depth);
+    std::vector<size_t> expected(max_depth + 1, 0);
+    for (NodeId id = 0; id < graph.size(); id++) {
+        expected[graph.node(id).m_depth]++;
+    }
+
+    TempPath work_dir_path("external-bfs");
+    const auto& work_dir = work_dir_path.path();
+    // A buffer of a few states forces many runs per layer, and more than
+    // one merge pass.
+    auto result =
+        external_bfs(table, work_dir, max_depth, 5 * sizeof(PackedTable));
+    REQUIRE(result.m_layer_sizes == expected);
+    REQUIRE_FALSE(result.m_win_depth);
+    REQUIRE_FALSE(result.m_exhausted);
+    REQUIRE_FALSE(result.m_timed_out);
+    REQUIRE(std::filesystem::file_size(external_layer_path(
+                work_dir, max_depth)) ==
+            expected[max_depth] * sizeof(PackedTable));
+
+    auto unbuffered = external_bfs(table, work_dir, max_depth, size_t{1} << 20);
+    REQUIRE(unbuffered.m_layer_sizes == expected);
+
+    // A shallower run in the same directory leaves none of the deeper
+    // layers behind.
+    auto shallow = external_bfs(table, work_dir, 3, size_t{1} << 20);
+    REQUIRE(shallow.m_layer_sizes.size() == 4);
+    REQUIRE(std::filesystem::exists(external_layer_path(work_dir, 3)));
+    REQUIRE_FALSE(std::filesystem::exists(external_layer_path(work_dir, 4)));
+}
+
+TEST_CASE("External BFS exhausts a small state space", "[external_bfs]") {
+    // Only the two aces can move, each to its foundation.
+    Table table;
+    table.add_to_visible_tableau_column(0, CARD("A♠"));
+    table.add_to_visible_tableau_column(1, CARD("A♥"));
+    TempPath work_dir("external-bfs");
+    auto result = external_bfs(table, work_dir.path(), 10, 1024);
+    REQUIRE(result.m_exhausted);
+    REQUIRE(result.m_layer_sizes == std::vector<size_t>{1, 2, 1, 0});
+}
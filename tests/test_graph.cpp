@@ -1,18 +1,25 @@
 #include <catch2/catch_test_macros.hpp>
 
+#include <algorithm>
+#include <atomic>
+#include <optional>
+#include <vector>
+
 #include "graph.hpp"
+#include "graph_checks.hpp"
 #include "res_config.hpp"
+#include "solver.hpp"
+#include "traversal.hpp"
 
-TEST_CASE("Graph iterator", "[graph]") {
+TEST_CASE("Graph traversal", "[graph]") {
     auto deck = import_deck(res_dir / "random-deck.txt");
     Table table(deck);
     Graph graph(table);
     graph.generate_bfs(2);
-    size_t count = 0;
-    for (auto node : graph) {
-        REQUIRE(node != nullptr);
-        count++;
-    }
+    size_t count = GraphTraversal(graph).bfs(
+        Graph::c_root, [&](NodeId node, size_t) {
+            REQUIRE(node < graph.size());
+        });
     REQUIRE(count == 16);
 }
 
@@ -23,11 +30,154 @@ TEST_CASE("Stock cycling loop", "[graph]") {
     table.m_deck[CARD("2♣")] = CARD("3♦");
     table.m_deck[CARD("3♦")] = c_null_index;
     Graph graph(table);
-    graph.generate_bfs(100);
-    size_t count = 0;
-    for (auto node : graph) {
-        REQUIRE(node != nullptr);
-        count++;
-    }
+    REQUIRE(graph.generate_bfs(100).m_stop == BfsStop::Exhausted);
+    size_t count = GraphTraversal(graph).bfs(
+        Graph::c_root, [&](NodeId node, size_t) {
+            REQUIRE(node < graph.size());
+        });
     REQUIRE(count == 4);
 }
+
+TEST_CASE("Parallel BFS matches serial BFS", "[graph]") {
+    auto deck = import_deck(res_dir / "random-deck.txt");
+    Table table(deck);
+    Graph serial(table);
+    auto serial_report = serial.generate_bfs(8);
+    REQUIRE(serial_report.m_depth == 8);
+    REQUIRE(serial_report.m_stop == BfsStop::MaxDepth);
+    for (size_t n_threads : {2, 4}) {
+        Graph parallel(table);
+        auto parallel_report =
+            parallel.generate_bfs(8, std::nullopt, n_threads);
+        REQUIRE(parallel_report.m_depth == serial_report.m_depth);
+        REQUIRE(parallel_report.m_stop == serial_report.m_stop);
+        require_same_graph(parallel, serial);
+    }
+}
+
+TEST_CASE("Parallel BFS after a DFS or a path matches serial BFS",
+          "[graph]") {
+    Table table(import_deck(res_dir / "random-deck.txt"));
+    auto moves = solve_best_first(table).m_moves;
+    for (bool dfs : {false, true}) {
+        Graph serial(table);
+        Graph parallel(table);
+        for (Graph* graph : {&serial, &parallel}) {
+            if (dfs) {
+                graph->generate_dfs();
+            } else {
+                graph->add_path(moves);
+            }
+        }
+        serial.generate_bfs(2);
+        parallel.generate_bfs(2, std::nullopt, 4);
+        require_same_graph(parallel, serial);
+    }
+}
+
+TEST_CASE("BFS stops at a memory budget", "[graph]") {
+    auto deck = import_deck(res_dir / "random-deck.txt");
+    Table table(deck);
+    Graph unbounded(table);
+    auto unbounded_report = unbounded.generate_bfs(10);
+    REQUIRE(unbounded_report.m_stop == BfsStop::MaxDepth);
+    REQUIRE(unbounded_report.m_memory_bytes == unbounded.memory_usage());
+    size_t budget = unbounded_report.m_memory_bytes / 2;
+    for (size_t n_threads : {1, 2}) {
+        Graph graph(table);
+        auto report = graph.generate_bfs(10, std::nullopt, n_threads, budget);
+        REQUIRE(report.m_stop == BfsStop::MaxMemory);
+        REQUIRE(report.m_memory_bytes <= budget);
+        REQUIRE(graph.size() > 1);
+        REQUIRE(graph.size() < unbounded.size());
+        // The nodes that were added are the first ones the unbounded BFS
+        // added.
+        for (NodeId id = 0; id < graph.size(); id++) {
+            REQUIRE(graph.table(id) == unbounded.table(id));
+        }
+        // Every node is still reachable from the root.
+        REQUIRE(GraphTraversal(graph).bfs(Graph::c_root,
+                                           [](NodeId, size_t) {}) ==
+                graph.size());
+    }
+}
+
+TEST_CASE("BFS stops at an expansion budget", "[graph]") {
+    Table table(import_deck(res_dir / "random-deck.txt"));
+    Graph serial(table);
+    auto report = serial.generate_bfs(10, std::nullopt, 1, std::nullopt, 500);
+    REQUIRE(report.m_stop == BfsStop::MaxExpansions);
+    REQUIRE(serial.frontier_begin() == 500);
+    for (size_t n_threads : {2, 4}) {
+        Graph parallel(table);
+        REQUIRE(parallel.generate_bfs(10, std::nullopt, n_threads,
+                                      std::nullopt, 500)
+                    .m_stop == BfsStop::MaxExpansions);
+        require_same_graph(parallel, serial);
+    }
+}
+
+TEST_CASE("BFS continues from its frontier", "[graph]") {
+    auto deck = import_deck(res_dir / "random-deck.txt");
+    Table table(deck);
+    Graph full(table);
+    full.generate_bfs(6);
+    for (size_t n_threads : {1, 2}) {
+        Graph graph(table);
+        REQUIRE(graph.generate_bfs(3, std::nullopt, n_threads).m_stop ==
+                BfsStop::MaxDepth);
+        REQUIRE(graph.frontier_begin() < graph.size());
+        REQUIRE(graph.node(graph.frontier_begin()).m_depth == 3);
+        auto report = graph.generate_bfs(6, std::nullopt, n_threads);
+        REQUIRE(report.m_depth == 6);
+        REQUIRE(graph.size() == full.size());
+        REQUIRE(graph.n_edges() == full.n_edges());
+        REQUIRE(graph.frontier_begin() == full.frontier_begin());
+    }
+}
+
+TEST_CASE("Edge runs moved by a BFS stay whole", "[graph]") {
+    // The nodes of a path or a DFS already have an edge when the BFS
+    // expands them, so their runs move as the BFS adds edges to them, and
+    // the edge array is compacted after the DFS.
+    Table table(import_deck(res_dir / "random-deck.txt"));
+    Graph graph(table);
+    SECTION("After a path") {
+        graph.add_path(solve_best_first(table).m_moves);
+        graph.generate_bfs(3);
+    }
+    SECTION("After a DFS") {
+        graph.generate_dfs();
+        graph.generate_bfs(2);
+    }
+    size_t n_edges = 0;
+    for (NodeId id = 0; id < graph.size(); id++) {
+        n_edges += graph.edges(id).size();
+        if (id >= graph.frontier_begin()) {
+            continue;
+        }
+        std::vector<Move> moves;
+        for (const auto& edge : graph.edges(id)) {
+            moves.push_back(edge.m_move);
+            Table child = graph.table(id);
+            apply_move(child, edge.m_move);
+            REQUIRE(graph.table(edge.m_to) == child);
+        }
+        auto possible_moves = generate_moves(graph.table(id));
+        REQUIRE(std::ranges::is_permutation(moves, possible_moves));
+    }
+    REQUIRE(graph.n_edges() == n_edges);
+}
+
+TEST_CASE("BFS stops when interrupted", "[graph]") {
+    auto deck = import_deck(res_dir / "random-deck.txt");
+    std::atomic<bool> interrupt{true};
+    for (size_t n_threads : {1, 2}) {
+        Graph graph{Table(deck)};
+        graph.set_interrupt_flag(&interrupt);
+        REQUIRE(graph.generate_bfs(6, std::nullopt, n_threads).m_stop ==
+                BfsStop::Interrupted);
+        REQUIRE(graph.size() == 1);
+        REQUIRE(graph.frontier_begin() == Graph::c_root);
+    }
+}
@@ -0,0 +1,200 @@
+#include <catch2/catch_test_macros.hpp>
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>  // NOLINT(build/c++17)
+#include <fstream>
+#include <stdexcept>
+#include <vector>
+
+#include "coarsen.hpp"
+#include "graph.hpp"
+#include "graph_file.hpp"
+#include "outcome.hpp"
+#include "res_config.hpp"
+#include "serialise.hpp"
+#include "solver.hpp"
+#include "temp_path.hpp"
+
+TEST_CASE("Graph files round trip", "[graph_file]") {
+    auto deck = import_deck(res_dir / "random-deck.txt");
+    Graph graph{Table(deck)};
+    constexpr size_t max_depth = 5;
+    graph.generate_bfs(max_depth);
+    TempPath temp("graph.bin");
+    const auto& path = temp.path();
+    write_graph_to_binary_file(graph, path, max_depth);
+    REQUIRE(std::filesystem::file_size(path) ==
+            GraphFileLayout::of(graph.size(), graph.n_edges()).m_size);
+
+    GraphFile file(path);
+    REQUIRE(file.size() == graph.size());
+    REQUIRE(file.n_edges() == graph.n_edges());
+    REQUIRE(file.max_depth() == max_depth);
+    for (NodeId id = 0; id < file.size(); id++) {
+        REQUIRE(file.table(id) == graph.table(id));
+        REQUIRE(file.depth(id) == graph.node(id).m_depth);
+        REQUIRE(file.is_winning(id) == graph.table(id).is_complete());
+        auto targets = file.edge_targets(id);
+        auto edges = graph.edges(id);
+        REQUIRE(targets.size() == edges.size());
+        for (size_t i = 0; i < targets.size(); i++) {
+            REQUIRE(targets[i] == edges[i].m_to);
+            REQUIRE(file.edge_move(id, i) == edges[i].m_move);
+        }
+    }
+}
+
+TEST_CASE("Graph files of a solved deal load", "[graph_file]") {
+    // The winning line added to the graph moves the edge runs of the nodes
+    // on it, so the graph holds more edges than the file.
+    Table table(import_deck(res_dir / "random-deck.txt"));
+    Graph graph(table);
+    graph.add_path(solve_best_first(table).m_moves);
+    graph.generate_bfs(2);
+    TempPath temp("graph.bin");
+    const auto& path = temp.path();
+    write_graph_to_binary_file(graph, path, 2);
+    GraphFile file(path);
+    size_t n_edges = 0;
+    for (NodeId id = 0; id < file.size(); id++) {
+        auto targets = file.edge_targets(id);
+        auto edges = graph.edges(id);
+        REQUIRE(targets.size() == edges.size());
+        for (size_t i = 0; i < targets.size(); i++) {
+            REQUIRE(targets[i] == edges[i].m_to);
+        }
+        n_edges += edges.size();
+    }
+    REQUIRE(file.n_edges() == n_edges);
+}
+
+TEST_CASE("Invalid graph files are rejected", "[graph_file]") {
+    TempPath temp("graph.bin");
+    const auto& path = temp.path();
+    {
+        std::ofstream out(path, std::ios::binary);
+        out << "ROSEGRPH but not much else, and certainly not a graph";
+    }
+    REQUIRE_THROWS_AS(GraphFile(path), std::runtime_error);
+
+    Graph graph{Table(import_deck(res_dir / "random-deck.txt"))};
+    graph.generate_bfs(2);
+    write_graph_to_binary_file(graph, path, 2);
+    std::filesystem::resize_file(path, std::filesystem::file_size(path) - 8);
+    REQUIRE_THROWS_AS(GraphFile(path), std::runtime_error);
+
+    // A file without even the start node, otherwise well formed.
+    {
+        std::ofstream out(path, std::ios::binary | std::ios::trunc);
+        out << c_graph_file_magic;
+        for (uint32_t field : {c_graph_file_version, 0U, 0U, 0U,
+                               static_cast<uint32_t>(c_table_state_size),
+                               0U}) {
+            out.write(reinterpret_cast<const char*>(&field), sizeof(field));
+        }
+    }
+    std::filesystem::resize_file(path, GraphFileLayout::of(0, 0).m_size);
+    REQUIRE_THROWS_AS(GraphFile(path), std::runtime_error);
+
+    // A flag from a later writer would add a section of unknown size.
+    write_graph_to_binary_file(graph, path, 2);
+    {
+        std::fstream file(path, std::ios::binary | std::ios::in |
+                                    std::ios::out);
+        uint32_t flags = uint32_t{1} << 31;
+        file.seekp(28);
+        file.write(reinterpret_cast<const char*>(&flags), sizeof(flags));
+    }
+    REQUIRE_THROWS_AS(GraphFile(path), std::runtime_error);
+}
+
+TEST_CASE("Graph files keep node positions", "[graph_file]") {
+    Graph graph{Table(import_deck(res_dir / "random-deck.txt"))};
+    graph.generate_bfs(3);
+    std::vector<Point> positions;
+    for (NodeId id = 0; id < graph.size(); id++) {
+        positions.push_back(Point{static_cast<float>(id) / 7.0F,
+                                  -static_cast<float>(id)});
+    }
+    TempPath temp("graph.bin");
+    const auto& path = temp.path();
+    write_graph_to_binary_file(graph, path, 3);
+    REQUIRE_FALSE(GraphFile(path).has_positions());
+    write_graph_to_binary_file(graph, path, 3, positions);
+    REQUIRE(std::filesystem::file_size(path) ==
+            GraphFileLayout::of(graph.size(), graph.n_edges(), true).m_size);
+    GraphFile file(path);
+    REQUIRE(file.has_positions());
+    for (NodeId id = 0; id < file.size(); id++) {
+        REQUIRE(file.position(id).m_x == positions[id].m_x);
+        REQUIRE(file.position(id).m_y == positions[id].m_y);
+        REQUIRE(file.table(id) == graph.table(id));
+    }
+}
+
+TEST_CASE("Graph files keep clusters", "[graph_file]") {
+    Graph graph{Table(import_deck(res_dir / "random-deck.txt"))};
+    graph.generate_bfs(8);
+    auto clusters = coarsen_graph(graph, 50).m_clusters;
+    REQUIRE(clusters.size() > 1);
+    TempPath temp("graph.bin");
+    const auto& path = temp.path();
+    write_graph_to_binary_file(graph, path, 8, {}, clusters);
+    GraphFile file(path);
+    REQUIRE_FALSE(file.has_positions());
+    REQUIRE(file.n_cluster_levels() == clusters.size());
+    for (size_t level = 0; level < clusters.size(); level++) {
+        auto read = file.clusters(level);
+        REQUIRE(std::vector<uint32_t>(read.begin(), read.end()) ==
+                clusters[level]);
+        size_t next_size = level + 1 < clusters.size()
+                               ? clusters[level + 1].size()
+                               : std::ranges::max(clusters.back()) + 1;
+        REQUIRE(file.n_clusters(level + 1) == next_size);
+    }
+    for (NodeId id = 0; id < file.size(); id++) {
+        REQUIRE(file.table(id) == graph.table(id));
+    }
+
+    write_graph_to_binary_file(graph, path, 8, {}, clusters);
+    std::filesystem::resize_file(path, std::filesystem::file_size(path) - 8);
+    REQUIRE_THROWS_AS(GraphFile(path), std::runtime_error);
+}
+
+TEST_CASE("Graph files keep outcomes", "[graph_file]") {
+    Table table(import_deck(res_dir / "random-deck.txt"));
+    Graph graph(table);
+    graph.add_path(solve_best_first(table).m_moves);
+    graph.generate_bfs(2);
+    auto outcomes = label_outcomes(graph);
+    TempPath temp("graph.bin");
+    const auto& path = temp.path();
+    write_graph_to_binary_file(graph, path, 2);
+    REQUIRE_FALSE(GraphFile(path).has_outcomes());
+    write_graph_to_binary_file(graph, path, 2, {}, {}, outcomes);
+    GraphFile file(path);
+    REQUIRE(file.has_outcomes());
+    for (NodeId id = 0; id < file.size(); id++) {
+        REQUIRE(file.outcome(id) == outcomes[id].m_outcome);
+        REQUIRE(file.win_distance(id) == outcomes[id].m_win_distance);
+    }
+    REQUIRE(std::filesystem::file_size(path) ==
+            GraphFileLayout::of(file.size(), file.n_edges(), false, {}, true)
+                .m_size);
+    REQUIRE((c_graph_file_known_flags & c_graph_file_has_outcomes) != 0);
+
+    // The flag without its section is rejected rather than read past the
+    // end of the file.
+    TempPath bare_path("graph.bin");
+    write_graph_to_binary_file(graph, bare_path.path(), 2);
+    {
+        std::fstream bare(bare_path.path(), std::ios::binary | std::ios::in |
+                                                std::ios::out);
+        uint32_t flags = c_graph_file_has_outcomes;
+        bare.seekp(28);
+        bare.write(reinterpret_cast<const char*>(&flags), sizeof(flags));
+    }
+    REQUIRE_THROWS_AS(GraphFile(bare_path.path()), std::runtime_error);
+}
@@ -0,0 +1,55 @@
+#include <catch2/catch_test_macros.hpp>
+
+#include <string>
+
+#include "http_client.hpp"
+#include "http_server.hpp"
+
+TEST_CASE("Requests are parsed", "[http_server]") {
+    auto request =
+        parse_http_request("GET /neighbourhood?id=12&hops=&flag HTTP/1.1\r\n"
+                           "Host: localhost");
+    REQUIRE(request);
+    REQUIRE(request->m_path == "/neighbourhood");
+    REQUIRE(request->param("id") == "12");
+    REQUIRE(request->param("hops") == "");
+    REQUIRE(request->param("flag") == "");
+    REQUIRE_FALSE(request->param("limit"));
+
+    request = parse_http_request("GET / HTTP/1.0");
+    REQUIRE(request);
+    REQUIRE(request->m_path == "/");
+    REQUIRE(request->m_params.empty());
+
+    REQUIRE_FALSE(parse_http_request("POST /node HTTP/1.1"));
+    REQUIRE_FALSE(parse_http_request("GET /node"));
+    REQUIRE_FALSE(parse_http_request("GET /node SMTP"));
+}
+
+TEST_CASE("Connections are kept open between requests", "[http_server]") {
+    HttpServer server(0, [](const HttpRequest& request,
+                            HttpConnection& connection) {
+        return connection.respond(HttpResponse{
+            .m_status = request.m_path == "/missing" ? 404 : 200,
+            .m_content_type = "text/plain",
+            .m_body = request.m_path});
+    });
+    TestClient client(server.port());
+    client.get("/first");
+    REQUIRE(client.read_response() == std::pair{200, std::string("/first")});
+    // Pipelined requests are answered in order.
+    client.get("/missing");
+    client.get("/");
+    REQUIRE(client.read_response() ==
+            std::pair{404, std::string("/missing")});
+    REQUIRE(client.read_response() == std::pair{200, std::string("/")});
+}
+
+TEST_CASE("Requests other than GET are refused", "[http_server]") {
+    HttpServer server(0, [](const HttpRequest&, HttpConnection& connection) {
+        return connection.respond(HttpResponse{});
+    });
+    TestClient client(server.port());
+    client.send("DELETE /node HTTP/1.1\r\n\r\n");
+    REQUIRE(client.read_response().first == 400);
+}
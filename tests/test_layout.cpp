@@ -0,0 +1,80 @@
+#include <catch2/catch_test_macros.hpp>
+
+#include <cmath>
+#include <cstddef>
+#include <vector>
+
+#include "graph.hpp"
+#include "layout.hpp"
+#include "res_config.hpp"
+
+auto distance(Point a, Point b) -> double {
+    return std::hypot(static_cast<double>(a.m_x) - b.m_x,
+                      static_cast<double>(a.m_y) - b.m_y);
+}
+
+// The mean length of the edges over the mean distance between nodes.
+auto edge_length_ratio(const Graph& graph, const std::vector<Point>& layout)
+    -> double {
+    double edge_length = 0.0;
+    for (NodeId id = 0; id < graph.size(); id++) {
+        for (const auto& edge : graph.edges(id)) {
+            edge_length += distance(layout[id], layout[edge.m_to]);
+        }
+    }
+    edge_length /= static_cast<double>(graph.n_edges());
+    double pair_distance = 0.0;
+    size_t n_pairs = 0;
+    for (NodeId a = 0; a < graph.size(); a += 7) {
+        for (NodeId b = a + 1; b < graph.size(); b += 13) {
+            pair_distance += distance(layout[a], layout[b]);
+            n_pairs++;
+        }
+    }
+    return edge_length / (pair_distance / static_cast<double>(n_pairs));
+}
+
+TEST_CASE("Layout places neighbours close together", "[layout]") {
+    Graph graph{Table(import_deck(res_dir / "random-deck.txt"))};
+    graph.generate_bfs(8);
+    auto layout = compute_layout(graph);
+    REQUIRE(layout.size() == graph.size());
+    for (const Point& p : layout) {
+        REQUIRE(std::isfinite(p.m_x));
+        REQUIRE(std::isfinite(p.m_y));
+    }
+    REQUIRE(edge_length_ratio(graph, layout) < 0.5);
+}
+
+TEST_CASE("Layout is deterministic", "[layout]") {
+    Graph graph{Table(import_deck(res_dir / "random-deck.txt"))};
+    graph.generate_bfs(5);
+    auto first = compute_layout(graph, LayoutOptions{.m_iterations = 20});
+    auto second = compute_layout(graph, LayoutOptions{.m_iterations = 20});
+    for (NodeId id = 0; id < graph.size(); id++) {
+        REQUIRE(first[id].m_x == second[id].m_x);
+        REQUIRE(first[id].m_y == second[id].m_y);
+    }
+}
+
+TEST_CASE("Layout on several threads", "[layout]") {
+    Graph graph{Table(import_deck(res_dir / "random-deck.txt"))};
+    graph.generate_bfs(18);
+    REQUIRE(graph.size() > 10000);
+    auto layout = compute_layout(
+        graph, LayoutOptions{.m_iterations = 10, .m_n_threads = 4});
+    REQUIRE(layout.size() == graph.size());
+    for (const Point& p : layout) {
+        REQUIRE(std::isfinite(p.m_x));
+        REQUIRE(std::isfinite(p.m_y));
+    }
+    REQUIRE(edge_length_ratio(graph, layout) < 0.5);
+}
+
+TEST_CASE("Layout of a single node", "[layout]") {
+    Graph graph{Table()};
+    auto layout = compute_layout(graph);
+    REQUIRE(layout.size() == 1);
+    REQUIRE(std::isfinite(layout[0].m_x));
+    REQUIRE(std::isfinite(layout[0].m_y));
+}
@@ -0,0 +1,53 @@
+#include <catch2/catch_test_macros.hpp>
+
+#include "common.hpp"
+#include "legality.hpp"
+#include "table.hpp"
+
+auto reference_can_stack(uint8_t card, uint8_t top) -> bool {
+    auto [card_suit, card_rank] = index_to_card(card);
+    if (top == c_null_index) {
+        return card_rank == c_num_cards_in_suit - 1;
+    }
+    auto [top_suit, top_rank] = index_to_card(top);
+    return card_rank + 1 == top_rank &&
+           !suit_colours_equal(card_suit, top_suit);
+}
+
+TEST_CASE("Tableau target kernels", "[legality]") {
+    // Cycle every possible top (including an empty column) through the
+    // columns so each card is checked against each top in every lane.
+    for (size_t offset = 0; offset <= c_num_cards; offset++) {
+        Table table;
+        for (size_t col = 0; col < c_tableau_columns; col++) {
+            size_t top = (offset + (col * 8)) % (c_num_cards + 1);
+            table.m_tableau_visible_indices[col] = static_cast<uint8_t>(top);
+        }
+        TableauTops tops = tableau_tops(table);
+        for (uint8_t card = 0; card < c_num_cards; card++) {
+            unsigned expected = 0;
+            for (size_t col = 0; col < c_tableau_columns; col++) {
+                bool legal = reference_can_stack(
+                    card, table.m_tableau_visible_indices[col]);
+                REQUIRE(table.can_be_placed_on_tableau(col, card) == legal);
+                expected |= static_cast<unsigned>(legal) << col;
+            }
+            REQUIRE(tableau_targets_scalar(tops, card) == expected);
+            REQUIRE(tableau_targets(tops, card) == expected);
+            if (has_avx2()) {
+                REQUIRE(tableau_targets_avx2(tops, card) == expected);
+            }
+        }
+    }
+}
+
+TEST_CASE("Foundation predecessors", "[legality]") {
+    Table table;
+    REQUIRE(table.can_be_placed_on_foundation(CARD("A♥")));
+    REQUIRE_FALSE(table.can_be_placed_on_foundation(CARD("2♥")));
+    table.m_foundation_indices[Suit::hearts] = CARD("A♥");
+    REQUIRE(table.can_be_placed_on_foundation(CARD("2♥")));
+    REQUIRE_FALSE(table.can_be_placed_on_foundation(CARD("2♦")));
+    REQUIRE_FALSE(table.can_be_placed_on_foundation(CARD("3♥")));
+    REQUIRE(table.can_be_placed_on_foundation(CARD("A♦")));
+}
@@ -1,5 +1,7 @@
 #include <catch2/catch_test_macros.hpp>
 
+#include <vector>
+
 #include "common.hpp"
 #include "moves.hpp"
 #include "res_config.hpp"
@@ -174,3 +176,118 @@ TEST_CASE("Generate moves", "[moves]") {
         REQUIRE(moves.size() == 6);
     }
 }
+
+TEST_CASE("Incremental hash matches full rehash", "[moves]") {
+    auto deck = import_deck(res_dir / "random-deck.txt");
+    Table table(deck);
+    REQUIRE(table.hash() == table.full_hash());
+    SECTION("Stock cycle returns to the initial hash") {
+        size_t initial_hash = table.hash();
+        size_t n_stock = table.n_cards_in_stock();
+        for (size_t i = 0; i <= n_stock; i++) {
+            apply_move(table, Move::create_stock_to_waste());
+            REQUIRE(table.hash() == table.full_hash());
+        }
+        REQUIRE(table.hash() == initial_hash);
+    }
+    SECTION("Random walk") {
+        std::mt19937 rng(42);
+        for (size_t step = 0; step < 500; step++) {
+            auto moves = generate_moves(table);
+            if (moves.empty()) {
+                break;
+            }
+            std::uniform_int_distribution<size_t> pick(0, moves.size() - 1);
+            apply_move(table, moves[pick(rng)]);
+            REQUIRE(table.hash() == table.full_hash());
+        }
+    }
+}
+
+TEST_CASE("Undo restores the table", "[moves]") {
+    auto deck = import_deck(res_dir / "random-deck.txt");
+    Table initial(deck);
+    SECTION("Every move from a random walk") {
+        Table table = initial;
+        std::mt19937 rng(7);
+        for (size_t step = 0; step < 500; step++) {
+            auto moves = generate_moves(table);
+            if (moves.empty()) {
+                break;
+            }
+            for (const Move& move : moves) {
+                Table before = table;
+                UndoRecord undo = apply_move(table, move);
+                undo_move(table, undo);
+                REQUIRE(table == before);
+                REQUIRE(table.hash() == before.hash());
+            }
+            std::uniform_int_distribution<size_t> pick(0, moves.size() - 1);
+            apply_move(table, moves[pick(rng)]);
+        }
+    }
+    SECTION("Unwinding a whole walk, including stock resets") {
+        Table table = initial;
+        std::mt19937 rng(11);
+        std::vector<UndoRecord> undos;
+        bool reset_stock = false;
+        for (size_t step = 0; step < 500; step++) {
+            auto moves = generate_moves(table);
+            if (moves.empty()) {
+                break;
+            }
+            std::uniform_int_distribution<size_t> pick(0, moves.size() - 1);
+            undos.push_back(apply_move(table, moves[pick(rng)]));
+            reset_stock |= undos.back().m_move.type() ==
+                               MoveType::StockToWaste &&
+                           undos.back().m_turned_over;
+        }
+        REQUIRE(reset_stock);
+        for (auto it = undos.rbegin(); it != undos.rend(); it++) {
+            undo_move(table, *it);
+        }
+        REQUIRE(table == initial);
+    }
+}
+
+TEST_CASE("Foundation links", "[moves]") {
+    Table table;
+    table.m_waste_index = CARD("A♠");
+    table.m_deck[CARD("A♠")] = CARD("2♠");
+    table.m_deck[CARD("2♠")] = c_null_index;
+    table.m_tableau_visible_indices[0] = CARD("3♥");
+    table.rehash();
+    waste_to_foundation(table);
+    waste_to_foundation(table);
+    REQUIRE(table.m_deck[CARD("2♠")] == CARD("A♠"));
+    REQUIRE(table.m_deck[CARD("A♠")] == c_null_index);
+    foundation_to_tableau(table, Suit::spades, 0);
+    REQUIRE(table.m_foundation_indices[Suit::spades] == CARD("A♠"));
+    REQUIRE(table.hash() == table.full_hash());
+}
+
+TEST_CASE("Packed move encoding", "[moves]") {
+    for (size_t from_col = 0; from_col < c_tableau_columns; from_col++) {
+        for (size_t to_col = 0; to_col < c_tableau_columns; to_col++) {
+            for (size_t n_cards = 1; n_cards <= c_num_cards_in_suit;
+                 n_cards++) {
+                auto move =
+                    Move::create_tableau_to_tableau(from_col, to_col, n_cards);
+                REQUIRE(move.type() == MoveType::TableauToTableau);
+                REQUIRE(move.from_col() == from_col);
+                REQUIRE(move.to_col() == to_col);
+                REQUIRE(move.n_cards() == n_cards);
+                REQUIRE(Move::from_bits(move.bits()) == move);
+            }
+        }
+    }
+    auto ft = Move::create_foundation_to_tableau(Suit::diamonds, 3);
+    REQUIRE(ft.type() == MoveType::FoundationToTableau);
+    REQUIRE(ft.from_suit() == Suit::diamonds);
+    REQUIRE(ft.to_col() == 3);
+    REQUIRE(ft.to_string() == "FT ♦ 3");
+    REQUIRE(Move::create_waste_to_tableau(2).to_json() ==
+            nlohmann::json{{"type", "WT"}, {"to_col", 2}});
+    REQUIRE(Move::create_tableau_to_foundation(2) !=
+            Move::create_waste_to_tableau(2));
+}
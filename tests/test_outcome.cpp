@@ -0,0 +1,123 @@
+#include <catch2/catch_test_macros.hpp>
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "common.hpp"
+#include "graph.hpp"
+#include "outcome.hpp"
+#include "res_config.hpp"
+#include "solver.hpp"
+#include "table.hpp"
+
+// A table with every card on its foundation but the spades from
+// `first_missing` up, which are laid out one per column.
+auto nearly_won_table(size_t first_missing) -> Table {
+    Table table;
+    for (size_t suit = 0; suit < c_num_suits; suit++) {
+        size_t end = suit == Suit::spades ? first_missing : c_num_cards_in_suit;
+        for (size_t rank = 0; rank < end; rank++) {
+            auto card = static_cast<uint8_t>(
+                card_to_index(static_cast<Suit>(suit), rank));
+            table.set_next(card, table.foundation_top(suit));
+            table.set_foundation(suit, card);
+        }
+    }
+    for (size_t rank = first_missing; rank < c_num_cards_in_suit; rank++) {
+        table.add_to_visible_tableau_column(
+            rank - first_missing,
+            static_cast<uint8_t>(card_to_index(Suit::spades, rank)));
+    }
+    return table;
+}
+
+// The graph of the BFS around the solver's winning line for the test deck.
+auto solved_graph(size_t max_depth) -> Graph {
+    Table table(import_deck(res_dir / "random-deck.txt"));
+    Graph graph(table);
+    graph.add_path(solve_best_first(table).m_moves);
+    graph.generate_bfs(max_depth);
+    return graph;
+}
+
+// The outcome of `start` found by a breadth-first search forward from it.
+auto search_forward(const Graph& graph, NodeId start) -> NodeOutcome {
+    std::vector<uint32_t> distances(graph.size(), c_no_win_distance);
+    distances[start] = 0;
+    std::vector<NodeId> queue{start};
+    bool reaches_unexpanded = false;
+    for (size_t head = 0; head < queue.size(); head++) {
+        NodeId id = queue[head];
+        if (graph.table(id).is_complete()) {
+            return NodeOutcome{.m_win_distance = distances[id],
+                               .m_outcome = Outcome::Winnable};
+        }
+        reaches_unexpanded |= id >= graph.frontier_begin();
+        for (const auto& edge : graph.edges(id)) {
+            if (distances[edge.m_to] == c_no_win_distance) {
+                distances[edge.m_to] = distances[id] + 1;
+                queue.push_back(edge.m_to);
+            }
+        }
+    }
+    return NodeOutcome{.m_outcome = reaches_unexpanded ? Outcome::Unknown
+                                                       : Outcome::Losing};
+}
+
+TEST_CASE("Winnable nodes count the moves to the nearest win",
+          "[outcome]") {
+    Graph graph(nearly_won_table(c_num_cards_in_suit - 2));
+    REQUIRE(graph.generate_bfs().m_stop == BfsStop::Exhausted);
+    auto outcomes = label_outcomes(graph);
+    REQUIRE(outcomes[Graph::c_root] ==
+            NodeOutcome{.m_win_distance = 2, .m_outcome = Outcome::Winnable});
+    for (NodeId id = 0; id < graph.size(); id++) {
+        REQUIRE(outcomes[id].m_outcome != Outcome::Unknown);
+        if (graph.table(id).is_complete()) {
+            REQUIRE(outcomes[id].m_win_distance == 0);
+            continue;
+        }
+        uint32_t nearest = c_no_win_distance;
+        for (const auto& edge : graph.edges(id)) {
+            nearest = std::min(nearest, outcomes[edge.m_to].m_win_distance);
+        }
+        if (nearest == c_no_win_distance) {
+            REQUIRE(outcomes[id].m_outcome == Outcome::Losing);
+        } else {
+            REQUIRE(outcomes[id].m_win_distance == nearest + 1);
+        }
+    }
+}
+
+TEST_CASE("Dead ends are losing once expanded", "[outcome]") {
+    // Nothing can move.
+    Table table;
+    table.add_to_visible_tableau_column(0, CARD("2♠"));
+    table.add_to_visible_tableau_column(1, CARD("2♥"));
+    Graph graph(table);
+    REQUIRE(label_outcomes(graph)[Graph::c_root].m_outcome ==
+            Outcome::Unknown);
+    graph.generate_bfs();
+    REQUIRE(label_outcomes(graph)[Graph::c_root] ==
+            NodeOutcome{.m_outcome = Outcome::Losing});
+}
+
+TEST_CASE("Outcomes match a search forward from every node", "[outcome]") {
+    Graph graph = solved_graph(1);
+    auto outcomes = label_outcomes(graph);
+    std::array<size_t, 3> counts{};
+    for (NodeId id = 0; id < graph.size(); id++) {
+        REQUIRE(outcomes[id] == search_forward(graph, id));
+        counts[static_cast<size_t>(outcomes[id].m_outcome)]++;
+    }
+    REQUIRE(counts[static_cast<size_t>(Outcome::Winnable)] > 0);
+    REQUIRE(counts[static_cast<size_t>(Outcome::Unknown)] > 0);
+}
+
+TEST_CASE("Outcomes do not depend on the thread count", "[outcome]") {
+    Graph graph = solved_graph(3);
+    REQUIRE(label_outcomes(graph, 4) == label_outcomes(graph));
+}
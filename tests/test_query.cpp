@@ -0,0 +1,138 @@
+#include <catch2/catch_test_macros.hpp>
+
+#include <algorithm>
+#include <cstddef>
+#include <filesystem>  // NOLINT(build/c++17)
+#include <set>
+#include <string>
+
+#include "graph.hpp"
+#include "graph_file.hpp"
+#include "query.hpp"
+#include "ranking.hpp"
+#include "res_config.hpp"
+#include "serialise.hpp"
+#include "temp_path.hpp"
+
+// A graph file of the BFS of the test deck, removed when done with.
+struct QueryFixture {
+    Graph m_graph{Table(import_deck(res_dir / "random-deck.txt"))};
+    TempPath m_temp{"query.bin"};
+    const std::filesystem::path& m_path = m_temp.path();
+
+    explicit QueryFixture(size_t max_depth) {
+        m_graph.generate_bfs(max_depth);
+        write_graph_to_binary_file(m_graph, m_path, max_depth);
+    }
+};
+
+TEST_CASE("Neighbourhoods follow edges both ways", "[query]") {
+    QueryFixture fixture(6);
+    const Graph& graph = fixture.m_graph;
+    GraphFile file(fixture.m_path);
+    GraphQueries queries(file);
+    for (NodeId id = 0; id < graph.size(); id += 17) {
+        std::set<NodeId> expected{id};
+        for (const auto& edge : graph.edges(id)) {
+            expected.insert(edge.m_to);
+        }
+        for (NodeId from = 0; from < graph.size(); from++) {
+            for (const auto& edge : graph.edges(from)) {
+                if (edge.m_to == id) {
+                    expected.insert(from);
+                }
+            }
+        }
+        auto result = queries.neighbourhood(id, 1, 1000);
+        std::set<NodeId> nodes;
+        for (const auto& node : result["nodes"]) {
+            nodes.insert(node["id"].get<NodeId>());
+            REQUIRE(node["depth"] == graph.node(node["id"]).m_depth);
+        }
+        REQUIRE(nodes == expected);
+        REQUIRE(result["nodes"][0]["id"] == id);
+        REQUIRE_FALSE(result["truncated"].get<bool>());
+        for (const auto& edge : result["edges"]) {
+            REQUIRE(nodes.contains(edge["source"].get<NodeId>()));
+            REQUIRE(nodes.contains(edge["target"].get<NodeId>()));
+        }
+    }
+    auto whole = queries.neighbourhood(0, 100, 100000);
+    REQUIRE(whole["nodes"].size() == graph.size());
+    REQUIRE(whole["edges"].size() == graph.n_edges());
+    auto truncated = queries.neighbourhood(0, 100, 10);
+    REQUIRE(truncated["nodes"].size() == 10);
+    REQUIRE(truncated["truncated"].get<bool>());
+}
+
+TEST_CASE("Paths from the start are shortest", "[query]") {
+    QueryFixture fixture(6);
+    const Graph& graph = fixture.m_graph;
+    GraphFile file(fixture.m_path);
+    GraphQueries queries(file);
+    for (NodeId id = 0; id < graph.size(); id++) {
+        auto path = queries.path_to(id);
+        auto nodes = path["nodes"].get<std::vector<NodeId>>();
+        REQUIRE(nodes.front() == Graph::c_root);
+        REQUIRE(nodes.back() == id);
+        REQUIRE(nodes.size() == graph.node(id).m_depth + 1);
+        REQUIRE(path["moves"].size() == nodes.size() - 1);
+        for (size_t i = 0; i + 1 < nodes.size(); i++) {
+            auto edges = graph.edges(nodes[i]);
+            REQUIRE(std::ranges::any_of(edges, [&](const Edge& edge) {
+                return edge.m_to == nodes[i + 1] &&
+                       edge.m_move.to_string() == path["moves"][i];
+            }));
+        }
+    }
+}
+
+TEST_CASE("Children are sorted by move value", "[query]") {
+    QueryFixture fixture(3);
+    const Graph& graph = fixture.m_graph;
+    GraphFile file(fixture.m_path);
+    GraphQueries queries(file);
+    auto children = queries.children(Graph::c_root)["children"];
+    REQUIRE(children.size() == graph.edges(Graph::c_root).size());
+    for (size_t i = 0; i < children.size(); i++) {
+        auto id = children[i]["id"].get<NodeId>();
+        auto edges = graph.edges(Graph::c_root);
+        auto edge = std::ranges::find_if(
+            edges, [&](const Edge& e) { return e.m_to == id; });
+        REQUIRE(edge != edges.end());
+        REQUIRE(children[i]["value"] ==
+                move_value(edge->m_move, graph.table(Graph::c_root)));
+        if (i > 0) {
+            REQUIRE(children[i - 1]["value"] >= children[i]["value"]);
+        }
+    }
+    auto node = queries.node(1);
+    REQUIRE(node["table"] == graph.table(1).to_string());
+    REQUIRE(node["depth"] == 1);
+}
+
+TEST_CASE("Queries are routed by path", "[query]") {
+    QueryFixture fixture(3);
+    GraphFile file(fixture.m_path);
+    GraphQueries queries(file);
+    auto answer = [&](const std::string& target) {
+        auto request = parse_http_request("GET " + target + " HTTP/1.1");
+        REQUIRE(request);
+        return answer_query(queries, *request);
+    };
+    auto response = answer("/node?id=2");
+    REQUIRE(response.m_status == 200);
+    REQUIRE(nlohmann::json::parse(response.m_body) == queries.node(2));
+    response = answer("/neighbourhood?id=0&hops=2&limit=5");
+    REQUIRE(response.m_status == 200);
+    REQUIRE(nlohmann::json::parse(response.m_body) ==
+            queries.neighbourhood(0, 2, 5));
+    REQUIRE(answer("/path?id=3").m_status == 200);
+    REQUIRE(answer("/children?id=3").m_status == 200);
+    REQUIRE(answer("/node").m_status == 400);
+    REQUIRE(answer("/node?id=two").m_status == 400);
+    REQUIRE(answer("/neighbourhood?id=0&limit=0").m_status == 400);
+    REQUIRE(answer("/node?id=1000000").m_status == 404);
+    REQUIRE(answer("/table?id=0").m_status == 404);
+    REQUIRE(nlohmann::json::parse(answer("/node").m_body).contains("error"));
+}
@@ -1,8 +1,21 @@
 #include <catch2/catch_test_macros.hpp>
 
+#include <cmath>
+#include <cstdint>
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "coarsen.hpp"
 #include "graph.hpp"
+#include "layout.hpp"
+#include "outcome.hpp"
 #include "res_config.hpp"
 #include "serialise.hpp"
+#include "solver.hpp"
+#include "temp_path.hpp"
 
 TEST_CASE("Graph to JSON", "[serialise]") {
     auto deck = import_deck(res_dir / "random-deck.txt");
@@ -18,3 +31,170 @@ TEST_CASE("Graph to JSON", "[serialise]") {
     REQUIRE(graph_json["nodes"].size() == 5);
     REQUIRE(graph_json["edges"].size() == 4);
 }
+
+TEST_CASE("Streamed JSON matches the JSON tree", "[serialise]") {
+    auto deck = import_deck(res_dir / "random-deck.txt");
+    Table table(deck);
+    Graph graph(table);
+    constexpr size_t max_depth = 4;
+    graph.generate_bfs(max_depth);
+    nlohmann::json graph_json = graph_to_json(graph, max_depth);
+    REQUIRE(graph_to_string(graph, max_depth) == graph_json.dump(2));
+    REQUIRE(graph_to_string(graph, max_depth,
+                            {.m_style = JsonStyle::Compact}) ==
+            graph_json.dump());
+    JsonOptions packed{.m_tables = TableEncoding::Packed};
+    REQUIRE(graph_to_string(graph, max_depth, packed) ==
+            graph_to_json(graph, max_depth, packed).dump(2));
+
+    TempPath path("graph.json");
+    write_graph_to_file(graph, path.path(), max_depth);
+    std::ifstream file(path.path());
+    std::string written((std::istreambuf_iterator<char>(file)),
+                        std::istreambuf_iterator<char>());
+    REQUIRE(written == graph_json.dump(2));
+}
+
+TEST_CASE("Streamed JSON of a single node", "[serialise]") {
+    Graph graph{Table()};
+    REQUIRE(graph_to_string(graph, 1) == graph_to_json(graph, 1).dump(2));
+}
+
+TEST_CASE("Packed tables decode to the node's table", "[serialise]") {
+    auto deck = import_deck(res_dir / "random-deck.txt");
+    Graph graph{Table(deck)};
+    graph.generate_bfs(2);
+    auto graph_json =
+        graph_to_json(graph, 2, {.m_tables = TableEncoding::Packed});
+    auto decode = [](char c) -> uint8_t {
+        constexpr std::string_view alphabet =
+            "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+        return static_cast<uint8_t>(alphabet.find(c));
+    };
+    for (const auto& node : graph_json["nodes"]) {
+        REQUIRE_FALSE(node.contains("table"));
+        auto state = node["state"].get<std::string>();
+        REQUIRE(state.size() == 96);
+        PackedTable packed;
+        for (size_t i = 0; i < state.size(); i += 4) {
+            uint32_t bits = 0;
+            for (size_t j = 0; j < 4; j++) {
+                bits = (bits << 6) | decode(state[i + j]);
+            }
+            packed[(i / 4 * 3)] = static_cast<uint8_t>(bits >> 16);
+            packed[(i / 4 * 3) + 1] = static_cast<uint8_t>(bits >> 8);
+            packed[(i / 4 * 3) + 2] = static_cast<uint8_t>(bits);
+        }
+        REQUIRE(Table::unpack(packed) ==
+                graph.table(node["id"].get<NodeId>()));
+    }
+}
+
+TEST_CASE("JSON nodes keep their ids", "[serialise]") {
+    auto deck = import_deck(res_dir / "random-deck.txt");
+    Graph graph{Table(deck)};
+    graph.generate_bfs(3);
+    auto graph_json = graph_to_json(graph, 3);
+    REQUIRE(graph_json["nodes"].size() == graph.size());
+    REQUIRE(graph_json["edges"].size() == graph.n_edges());
+    for (NodeId id = 0; id < graph.size(); id++) {
+        REQUIRE(graph_json["nodes"][id]["id"] == id);
+        REQUIRE(graph_json["nodes"][id]["table"] ==
+                graph.table(id).to_string());
+    }
+    size_t i = 0;
+    for (NodeId id = 0; id < graph.size(); id++) {
+        for (const auto& edge : graph.edges(id)) {
+            REQUIRE(graph_json["edges"][i]["source"] == id);
+            REQUIRE(graph_json["edges"][i]["target"] == edge.m_to);
+            i++;
+        }
+    }
+}
+
+TEST_CASE("Node positions are exported", "[serialise]") {
+    auto deck = import_deck(res_dir / "random-deck.txt");
+    Graph graph{Table(deck)};
+    graph.generate_bfs(2);
+    std::vector<Point> positions;
+    for (NodeId id = 0; id < graph.size(); id++) {
+        positions.push_back(Point{static_cast<float>(id) * 10.0F,
+                                  -static_cast<float>(id) / 3.0F});
+    }
+    JsonOptions options{.m_positions = positions};
+    auto graph_json = graph_to_json(graph, 2, options);
+    for (NodeId id = 0; id < graph.size(); id++) {
+        const auto& node = graph_json["nodes"][id];
+        REQUIRE(node["x"].get<double>() == 10.0 * id);
+        REQUIRE(std::abs(node["y"].get<double>() + (id / 3.0)) <= 0.005);
+    }
+    REQUIRE(graph_to_string(graph, 2, options) == graph_json.dump(2));
+    options.m_style = JsonStyle::Compact;
+    REQUIRE(graph_to_string(graph, 2, options) == graph_json.dump());
+}
+
+TEST_CASE("Clusters are exported", "[serialise]") {
+    Graph graph{Table(import_deck(res_dir / "random-deck.txt"))};
+    graph.generate_bfs(6);
+    auto clusters = coarsen_graph(graph, 20).m_clusters;
+    REQUIRE(clusters.size() > 1);
+    JsonOptions options{.m_clusters = clusters};
+    auto graph_json = graph_to_json(graph, 6, options);
+    REQUIRE(graph_json["clusters"] == clusters);
+    REQUIRE(graph_to_string(graph, 6, options) == graph_json.dump(2));
+    options.m_style = JsonStyle::Compact;
+    REQUIRE(graph_to_string(graph, 6, options) == graph_json.dump());
+    REQUIRE_FALSE(graph_to_json(graph, 6).contains("clusters"));
+}
+
+TEST_CASE("Outcomes are exported", "[serialise]") {
+    Table table(import_deck(res_dir / "random-deck.txt"));
+    Graph graph(table);
+    graph.add_path(solve_best_first(table).m_moves);
+    graph.generate_bfs(3);
+    auto outcomes = label_outcomes(graph);
+    JsonOptions options{.m_outcomes = outcomes};
+    auto graph_json = graph_to_json(graph, 3, options);
+    for (NodeId id = 0; id < graph.size(); id++) {
+        const auto& node = graph_json["nodes"][id];
+        REQUIRE(node["outcome"] == outcome_to_string(outcomes[id].m_outcome));
+        REQUIRE(node.contains("win_distance") ==
+                (outcomes[id].m_outcome == Outcome::Winnable));
+    }
+    REQUIRE(graph_to_string(graph, 3, options) == graph_json.dump(2));
+    options.m_style = JsonStyle::Compact;
+    REQUIRE(graph_to_string(graph, 3, options) == graph_json.dump());
+    REQUIRE_FALSE(graph_to_json(graph, 3)["nodes"][0].contains("outcome"));
+}
+
+TEST_CASE("Batches of a BFS make up the graph", "[serialise]") {
+    Graph graph{Table(import_deck(res_dir / "random-deck.txt"))};
+    constexpr size_t max_depth = 6;
+    JsonOptions options{.m_style = JsonStyle::Compact};
+    nlohmann::json nodes = nlohmann::json::array();
+    nlohmann::json edges = nlohmann::json::array();
+    GraphBatch batch{.m_first_node = 0, .m_first_source = 0, .m_end_source = 0};
+    auto send = [&](NodeId end_source) {
+        batch.m_end_source = end_source;
+        auto text = graph_batch_to_string(graph, batch, max_depth, options);
+        REQUIRE(text.find('\n') == std::string::npos);
+        auto batch_json = nlohmann::json::parse(text);
+        nodes.insert(nodes.end(), batch_json["nodes"].begin(),
+                     batch_json["nodes"].end());
+        edges.insert(edges.end(), batch_json["edges"].begin(),
+                     batch_json["edges"].end());
+        batch.m_first_node = static_cast<NodeId>(graph.size());
+        batch.m_first_source = end_source;
+    };
+    send(graph.frontier_begin());
+    REQUIRE(nodes.size() == 1);
+    REQUIRE(edges.empty());
+    for (size_t depth = 2; depth <= max_depth; depth += 2) {
+        graph.generate_bfs(depth);
+        send(graph.frontier_begin());
+    }
+    send(static_cast<NodeId>(graph.size()));
+    auto graph_json = graph_to_json(graph, max_depth, options);
+    REQUIRE(nodes == graph_json["nodes"]);
+    REQUIRE(edges == graph_json["edges"]);
+}
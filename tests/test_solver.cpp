@@ -0,0 +1,94 @@
+#include <catch2/catch_test_macros.hpp>
+
+#include <algorithm>
+#include <cstddef>
+
+#include "common.hpp"
+#include "graph.hpp"
+#include "moves.hpp"
+#include "res_config.hpp"
+#include "solver.hpp"
+#include "table.hpp"
+
+TEST_CASE("Moves to win lower bound", "[solver]") {
+    auto deck = import_deck(res_dir / "random-deck.txt");
+    Table table(deck);
+    REQUIRE(moves_to_win_lower_bound(table) == c_num_cards);
+    Table won;
+    for (size_t suit = 0; suit < c_num_suits; suit++) {
+        won.m_foundation_indices[suit] = static_cast<uint8_t>(
+            card_to_index(static_cast<Suit>(suit), c_num_cards_in_suit - 1));
+    }
+    REQUIRE(moves_to_win_lower_bound(won) == 0);
+}
+
+TEST_CASE("Best-first solver", "[solver]") {
+    auto deck = import_deck(res_dir / "random-deck.txt");
+    Table table(deck);
+    auto result = solve_best_first(table);
+    REQUIRE(result.m_status == SolveStatus::Won);
+    REQUIRE(result.m_expanded > 0);
+    REQUIRE(result.m_moves.size() >= moves_to_win_lower_bound(table));
+    SECTION("The winning line is legal and wins") {
+        for (const Move& move : result.m_moves) {
+            auto legal = generate_moves(table);
+            REQUIRE(std::ranges::find(legal, move) != legal.end());
+            apply_move(table, move);
+        }
+        REQUIRE(table.is_complete());
+    }
+    SECTION("The winning line can be added to a graph") {
+        Graph graph(table);
+        graph.add_path(result.m_moves);
+        REQUIRE(graph.size() <= result.m_moves.size() + 1);
+        REQUIRE(graph.table(static_cast<NodeId>(graph.size() - 1))
+                    .is_complete());
+    }
+    SECTION("The expansion budget is respected") {
+        auto limited = solve_best_first(table, 10);
+        REQUIRE(limited.m_status == SolveStatus::OutOfBudget);
+        REQUIRE(limited.m_expanded == 10);
+        REQUIRE(limited.m_moves.empty());
+    }
+}
+
+TEST_CASE("Depth-first solver", "[solver]") {
+    constexpr size_t tt_bytes = size_t{1} << 20;
+    auto deck = import_deck(res_dir / "random-deck.txt");
+    Table table(deck);
+    auto result = solve_depth_first(table, tt_bytes);
+    REQUIRE(result.m_status == SolveStatus::Won);
+    SECTION("The winning line is legal and wins") {
+        for (const Move& move : result.m_moves) {
+            auto legal = generate_moves(table);
+            REQUIRE(std::ranges::find(legal, move) != legal.end());
+            apply_move(table, move);
+        }
+        REQUIRE(table.is_complete());
+    }
+    SECTION("The expansion budget is respected") {
+        auto limited = solve_depth_first(table, tt_bytes, 10);
+        REQUIRE(limited.m_status == SolveStatus::OutOfBudget);
+        REQUIRE(limited.m_expanded == 10);
+        REQUIRE(limited.m_moves.empty());
+    }
+    SECTION("A transposition table of one bucket finds the same win") {
+        auto small = solve_depth_first(table, 64);
+        REQUIRE(small.m_status == SolveStatus::Won);
+        REQUIRE(small.m_moves == result.m_moves);
+    }
+}
+
+TEST_CASE("Solver reports a lost deal", "[solver]") {
+    // Nothing can move: the stock and waste are empty and no column top can
+    // go anywhere.
+    Table table;
+    table.add_to_visible_tableau_column(0, CARD("2♠"));
+    table.add_to_visible_tableau_column(1, CARD("2♥"));
+    auto result = solve_best_first(table);
+    REQUIRE(result.m_status == SolveStatus::Lost);
+    REQUIRE(result.m_expanded == 1);
+    auto depth_first = solve_depth_first(table, 64);
+    REQUIRE(depth_first.m_status == SolveStatus::Lost);
+    REQUIRE(depth_first.m_expanded == 1);
+}
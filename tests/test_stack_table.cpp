@@ -0,0 +1,61 @@
+#include <catch2/catch_test_macros.hpp>
+
+#include <optional>
+#include <random>
+
+#include "common.hpp"
+#include "moves.hpp"
+#include "ranking.hpp"
+#include "res_config.hpp"
+#include "stack_table.hpp"
+#include "table.hpp"
+
+TEST_CASE("Stack table round trip", "[stack_table]") {
+    auto deck = import_deck(res_dir / "random-deck.txt");
+    Table table(deck);
+    StackTable stack_table(table);
+    REQUIRE(stack_table.to_table() == table);
+    REQUIRE(stack_table.n_cards_in_stock() == table.n_cards_in_stock());
+    REQUIRE(stack_table.stock_top() == table.stock_top());
+    for (size_t col = 0; col < c_tableau_columns; col++) {
+        REQUIRE(stack_table.n_cards_in_hidden_tableau_column(col) ==
+                table.n_cards_in_hidden_tableau_column(col));
+        REQUIRE(stack_table.visible_top(col) == table.visible_top(col));
+        REQUIRE(stack_table.hidden_top(col) == table.hidden_top(col));
+    }
+}
+
+TEST_CASE("Layouts agree on random walks", "[stack_table]") {
+    std::optional<std::mt19937> deck_rng = std::mt19937(7);
+    std::mt19937 rng(42);
+    for (size_t game = 0; game < 20; game++) {
+        Table table(random_deck(deck_rng));
+        StackTable stack_table(table);
+        std::optional<Move> prev_move;
+        for (size_t step = 0; step < 300; step++) {
+            auto moves = generate_moves(table, prev_move);
+            auto stack_moves = generate_moves(stack_table, prev_move);
+            REQUIRE(std::ranges::equal(moves, stack_moves));
+            if (moves.empty()) {
+                break;
+            }
+            for (const Move& move : moves) {
+                REQUIRE(move_value(move, table) ==
+                        move_value(move, stack_table));
+            }
+            std::uniform_int_distribution<size_t> pick(0, moves.size() - 1);
+            Move move = moves[pick(rng)];
+            StackTable before = stack_table;
+            UndoRecord undo = apply_move(stack_table, move);
+            REQUIRE(apply_move(table, move).m_turned_over ==
+                    undo.m_turned_over);
+            undo_move(stack_table, undo);
+            REQUIRE(stack_table == before);
+            apply_move(stack_table, move);
+            REQUIRE(stack_table.to_table() == table);
+            REQUIRE(StackTable(table) == stack_table);
+            REQUIRE(stack_table.is_complete() == table.is_complete());
+            prev_move = move;
+        }
+    }
+}
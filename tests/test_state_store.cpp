@@ -0,0 +1,80 @@
+#include <catch2/catch_test_macros.hpp>
+
+#include <optional>
+#include <random>
+#include <vector>
+
+#include "common.hpp"
+#include "res_config.hpp"
+#include "state_store.hpp"
+#include "table.hpp"
+
+TEST_CASE("State store insert and find", "[state_store]") {
+    StateStore store;
+    auto deck = import_deck(res_dir / "random-deck.txt");
+    Table table(deck);
+    REQUIRE_FALSE(store.contains(table));
+    auto [id, inserted] = store.insert(table);
+    REQUIRE(inserted);
+    REQUIRE(id == 0);
+    REQUIRE(store.size() == 1);
+    REQUIRE(store.find(table) == id);
+    REQUIRE(store[id] == table);
+    auto [same_id, inserted_again] = store.insert(table);
+    REQUIRE_FALSE(inserted_again);
+    REQUIRE(same_id == id);
+    REQUIRE(store.size() == 1);
+}
+
+TEST_CASE("State store grows and keeps dense ids", "[state_store]") {
+    StateStore store;
+    std::optional<std::mt19937> rng = std::mt19937(1234);
+    std::vector<Table> tables;
+    constexpr size_t n_tables = 5000;
+    for (size_t i = 0; i < n_tables; i++) {
+        tables.emplace_back(random_deck(rng));
+    }
+    for (size_t i = 0; i < n_tables; i++) {
+        auto [id, inserted] = store.insert(tables[i]);
+        REQUIRE(inserted);
+        REQUIRE(id == i);
+    }
+    REQUIRE(store.size() == n_tables);
+    REQUIRE(store.slot_count() >= n_tables);
+    for (size_t i = 0; i < n_tables; i++) {
+        REQUIRE(store.find(tables[i]) == i);
+        REQUIRE(store[static_cast<StateId>(i)] == tables[i]);
+        REQUIRE(store[static_cast<StateId>(i)].hash() == tables[i].hash());
+    }
+    Table empty;
+    REQUIRE_FALSE(store.contains(empty));
+    store.clear();
+    REQUIRE(store.empty());
+    REQUIRE_FALSE(store.contains(tables[0]));
+}
+
+TEST_CASE("State store keeps states whose tags collide", "[state_store]") {
+    // Every key gets the same tag, so every state shares a home slot and
+    // only the comparison of the states tells them apart, including after
+    // the index grows.
+    std::optional<std::mt19937> rng = std::mt19937(99);
+    std::vector<StateKey> keys;
+    for (size_t i = 0; i < 2000; i++) {
+        keys.push_back(
+            StateKey{.m_state = Table(random_deck(rng)).pack(), .m_tag = 42});
+    }
+    StateStore store;
+    for (size_t i = 0; i + 1 < keys.size(); i++) {
+        auto [id, inserted] = store.insert(keys[i]);
+        REQUIRE(inserted);
+        REQUIRE(id == i);
+    }
+    for (size_t i = 0; i + 1 < keys.size(); i++) {
+        REQUIRE(store.find(keys[i]) == i);
+        REQUIRE(store.state(static_cast<StateId>(i)) == keys[i].m_state);
+        REQUIRE_FALSE(store.insert(keys[i]).second);
+    }
+    REQUIRE_FALSE(store.find(keys.back()));
+    REQUIRE(store.size() == keys.size() - 1);
+    REQUIRE(store.slot_count() > 1024);
+}
@@ -0,0 +1,50 @@
+#include <catch2/catch_test_macros.hpp>
+
+#include <cstddef>
+#include <cstdint>
+#include <stdexcept>
+
+#include "transposition_table.hpp"
+
+TEST_CASE("Transposition table", "[transposition_table]") {
+    REQUIRE_THROWS_AS(TranspositionTable(1), std::invalid_argument);
+
+    // Two buckets of four entries.
+    TranspositionTable tt(128);
+    REQUIRE(tt.capacity() == 8);
+    REQUIRE_FALSE(tt.contains(0));
+    REQUIRE(tt.insert_pinned(0));
+    REQUIRE(tt.contains(0));
+    REQUIRE(tt.size() == 1);
+    tt.clear();
+    REQUIRE_FALSE(tt.contains(0));
+
+    SECTION("Pinned entries are never replaced") {
+        // Even hashes all share the first bucket.
+        for (uint64_t hash = 2; hash <= 8; hash += 2) {
+            REQUIRE(tt.insert_pinned(hash));
+        }
+        REQUIRE_FALSE(tt.insert_pinned(10));
+        REQUIRE_FALSE(tt.contains(10));
+        REQUIRE(tt.insert_pinned(1));
+        for (uint64_t hash = 2; hash <= 8; hash += 2) {
+            REQUIRE(tt.contains(hash));
+        }
+    }
+    SECTION("The cheapest released entry is replaced") {
+        for (uint64_t hash = 2; hash <= 8; hash += 2) {
+            REQUIRE(tt.insert_pinned(hash));
+        }
+        tt.release(2, 100);
+        tt.release(4, 5);
+        tt.release(6, 50);
+        REQUIRE(tt.insert_pinned(10));
+        REQUIRE(tt.n_replaced() == 1);
+        REQUIRE_FALSE(tt.contains(4));
+        REQUIRE(tt.contains(2));
+        REQUIRE(tt.contains(6));
+        REQUIRE(tt.contains(8));
+        REQUIRE(tt.contains(10));
+        REQUIRE(tt.size() == 4);
+    }
+}
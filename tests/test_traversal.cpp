@@ -0,0 +1,109 @@
+#include <catch2/catch_test_macros.hpp>
+
+#include <algorithm>
+#include <cstddef>
+#include <ranges>
+#include <vector>
+
+#include "graph.hpp"
+#include "res_config.hpp"
+#include "solver.hpp"
+#include "traversal.hpp"
+
+TEST_CASE("BFS traversal visits nodes by distance", "[traversal]") {
+    auto deck = import_deck(res_dir / "random-deck.txt");
+    Graph graph{Table(deck)};
+    graph.generate_bfs(6);
+    GraphTraversal traversal(graph);
+    std::vector<size_t> distances(graph.size(), SIZE_MAX);
+    size_t last_distance = 0;
+    size_t count = traversal.bfs(Graph::c_root, [&](NodeId node,
+                                                    size_t distance) {
+        REQUIRE(distances[node] == SIZE_MAX);
+        REQUIRE(distance >= last_distance);
+        distances[node] = distance;
+        last_distance = distance;
+    });
+    REQUIRE(count == graph.size());
+    // From the root, the distance of a node is its BFS depth.
+    for (NodeId id = 0; id < graph.size(); id++) {
+        REQUIRE(distances[id] == graph.node(id).m_depth);
+        REQUIRE(traversal.visited(id));
+    }
+}
+
+TEST_CASE("Traversals stop at the maximum distance", "[traversal]") {
+    auto deck = import_deck(res_dir / "random-deck.txt");
+    Graph graph{Table(deck)};
+    graph.generate_bfs(6);
+    auto n_within = [&](size_t max_distance) {
+        return static_cast<size_t>(std::ranges::count_if(
+            std::views::iota(NodeId{0}, static_cast<NodeId>(graph.size())),
+            [&](NodeId id) { return graph.node(id).m_depth <= max_distance; }));
+    };
+    GraphTraversal traversal(graph);
+    // The same traversal is reused for every call.
+    for (size_t max_distance : {0, 1, 3, 6}) {
+        size_t n_bfs = traversal.bfs(
+            Graph::c_root, [](NodeId, size_t) {}, max_distance);
+        REQUIRE(n_bfs == n_within(max_distance));
+        size_t n_dfs = traversal.dfs(
+            Graph::c_root,
+            [&](NodeId, size_t distance) {
+                REQUIRE(distance <= max_distance);
+            },
+            max_distance);
+        // A depth-first path may reach a node the long way round first.
+        REQUIRE(n_dfs <= n_bfs);
+    }
+    REQUIRE(traversal.dfs(Graph::c_root, [](NodeId, size_t) {}) ==
+            graph.size());
+}
+
+TEST_CASE("DFS traversal follows edges in order", "[traversal]") {
+    auto deck = import_deck(res_dir / "random-deck.txt");
+    Graph graph{Table(deck)};
+    graph.generate_bfs(2);
+    std::vector<NodeId> order;
+    GraphTraversal(graph).dfs(Graph::c_root, [&](NodeId node, size_t) {
+        order.push_back(node);
+    });
+    REQUIRE(order.front() == Graph::c_root);
+    // The root's first child comes next, then that child's first child.
+    NodeId first_child = graph.edges(Graph::c_root).front().m_to;
+    REQUIRE(order[1] == first_child);
+    REQUIRE(order[2] == graph.edges(first_child).front().m_to);
+}
+
+// Appends the nodes reachable from `node` to `order` in the preorder of a
+// recursive DFS that follows edges in order.
+auto recursive_preorder(const Graph& graph, NodeId node,
+                        std::vector<bool>& visited, std::vector<NodeId>& order)
+    -> void {
+    visited[node] = true;
+    order.push_back(node);
+    for (const auto& edge : graph.edges(node)) {
+        if (!visited[edge.m_to]) {
+            recursive_preorder(graph, edge.m_to, visited, order);
+        }
+    }
+}
+
+TEST_CASE("DFS traversal visits shared descendants in preorder",
+          "[traversal]") {
+    // Moves that commute reach the same state by several paths, so a node
+    // in the subtree of one child can also be a later child of its parent.
+    // The BFS around a winning line has many such nodes.
+    Table table(import_deck(res_dir / "random-deck.txt"));
+    Graph graph(table);
+    graph.add_path(solve_best_first(table).m_moves);
+    graph.generate_bfs(3);
+    std::vector<bool> visited(graph.size(), false);
+    std::vector<NodeId> expected;
+    recursive_preorder(graph, Graph::c_root, visited, expected);
+    std::vector<NodeId> order;
+    GraphTraversal(graph).dfs(Graph::c_root, [&](NodeId node, size_t) {
+        order.push_back(node);
+    });
+    REQUIRE(order == expected);
+}
@@ -3,6 +3,18 @@ import Graph from "graphology";
 import circular from "graphology-layout/circular.js";
 import ForceAtlas2 from "graphology-layout-forceatlas2/worker.js";
 import Sigma from "sigma";
+import {
+  depthSize,
+  moveTypeToString,
+  nodeColor,
+  nodeSize,
+  nodeTable,
+  outcomeColor,
+  parseGraphFile,
+  WINNING_FLAG,
+} from "./graph_file.mjs";
+import { ClusterView } from "./lod.mjs";
+import { packedTableToString } from "./table.mjs";
 
 const container = document.getElementById("graph");
 const tableView = document.getElementById("tableView");
@@ -18,22 +30,62 @@ resize();
 let renderer = null;
 let currentGraph = null;
 let layout = null;
+// The parsed graph.bin, whose node tables are rendered on demand.
+let graphFile = null;
+// The clusters shown in place of the graph when rose exported them.
+let clusterView = null;
 
+// Where `rose --serve` streams the graph to, unless the page is opened
+// with another URL as its `stream` parameter.
+const DEFAULT_STREAM_URL = "http://localhost:8081/events";
+// New nodes of a streamed graph start this far from their parent.
+const STREAM_SPREAD = 1;
+// Where `rose --query` answers queries, unless the page is opened with
+// another URL as its `query` parameter.
+const DEFAULT_QUERY_URL = "http://localhost:8081/";
+// How far from the start the first neighbourhood fetched reaches, and how
+// far from a clicked node the nodes added reach.
+const QUERY_START_HOPS = 2;
+const QUERY_CLICK_HOPS = 1;
+// The URL of `rose --query` when the graph is fetched node by node.
+let queryUrl = null;
+
+// The settings of `LayoutOptions` in rose, so that restarting the layout
+// of a graph rose laid out keeps its shape.
 const layoutSettings = {
   gravity: 20,
   barnesHutOptimize: true,
+  barnesHutTheta: 1.2,
 };
 
-async function loadGraph(path) {
+// Loads graph.bin if rose wrote one, or graph.json otherwise.
+async function loadGraph() {
   try {
-    const graph = await fetch(path, { cache: "no-store" }).then((res) => {
-      if (!res.ok) throw new Error(`Failed to fetch ${path}: ${res.status}`);
-      return res.json();
-    });
-    return graph;
+    const bin = await fetch("graph.bin", { cache: "no-store" });
+    clusterView = null;
+    if (bin.ok) {
+      graphFile = parseGraphFile(await bin.arrayBuffer());
+      if (graphFile.clusters) {
+        clusterView = new ClusterView(
+          binarySource(graphFile),
+          graphFile.clusters,
+        );
+        return clusterView.graph;
+      }
+      return binaryToGraph(graphFile);
+    }
+    graphFile = null;
+    const res = await fetch("graph.json", { cache: "no-store" });
+    if (!res.ok) throw new Error(`Failed to fetch graph.json: ${res.status}`);
+    const json = await res.json();
+    if (json.clusters) {
+      clusterView = new ClusterView(jsonSource(json), json.clusters);
+      return clusterView.graph;
+    }
+    return jsonToGraph(json);
   } catch (err) {
     container.innerHTML =
-      '<div style="padding:20px;color:#a00">Error loading graph.json — see console for details.</div>';
+      '<div style="padding:20px;color:#a00">Error loading the graph — see console for details.</div>';
     console.error(err);
     throw err;
   }
@@ -78,7 +130,21 @@ function stopLayout() {
   }
 }
 
+// Whether rose laid the graph out, so that every node has coordinates.
+function hasCoordinates(g) {
+  return g.everyNode(
+    (_node, attrs) => Number.isFinite(attrs.x) && Number.isFinite(attrs.y),
+  );
+}
+
+// Graphs laid out by rose are shown as they are, and the layout only
+// runs when it is started.
 function setNodeCoordinates(g) {
+  if (hasCoordinates(g)) {
+    createLayout(g);
+    layoutToggleBtn.textContent = "Start layout";
+    return;
+  }
   circular.assign(g);
   // random.assign(g);
   createLayout(g);
@@ -106,25 +172,271 @@ function jsonToGraph(json) {
   return g;
 }
 
+function binaryNodeAttributes(file, id) {
+  const attrs = { color: nodeColor(file, id), size: nodeSize(file, id) };
+  if (file.positions) {
+    attrs.x = file.positions[2 * id];
+    attrs.y = file.positions[2 * id + 1];
+  }
+  if (id === 0) {
+    attrs.label = "Start";
+    attrs.forceLabel = true;
+  } else if (file.flags[id] & WINNING_FLAG) {
+    attrs.label = "Winning";
+    attrs.forceLabel = true;
+  }
+  return attrs;
+}
+
+function forEachBinaryEdge(file, callback) {
+  for (let source = 0; source < file.nNodes; source++) {
+    const end = file.edgeOffsets[source + 1];
+    for (let e = file.edgeOffsets[source]; e < end; e++) {
+      callback(source, file.edgeTargets[e], {
+        type: "arrow",
+        label: moveTypeToString(file.edgeMoves[e]),
+        size: 1,
+      });
+    }
+  }
+}
+
+function binaryToGraph(file) {
+  const g = new Graph();
+  for (let id = 0; id < file.nNodes; id++) {
+    g.addNode(id, binaryNodeAttributes(file, id));
+  }
+  forEachBinaryEdge(file, (source, target, attrs) => {
+    g.addEdge(source, target, attrs);
+  });
+  return g;
+}
+
+// The graph's nodes and edges as `ClusterView` reads them.
+function binarySource(file) {
+  return {
+    nNodes: file.nNodes,
+    nodeAttributes: (id) => binaryNodeAttributes(file, id),
+    position: (id) =>
+      file.positions
+        ? [file.positions[2 * id], file.positions[2 * id + 1]]
+        : null,
+    isWinning: (id) => (file.flags[id] & WINNING_FLAG) !== 0,
+    forEachEdge: (callback) => forEachBinaryEdge(file, callback),
+  };
+}
+
+function jsonSource(json) {
+  return {
+    nNodes: json.nodes.length,
+    nodeAttributes: (id) => {
+      const attrs = Object.assign({}, json.nodes[id]);
+      delete attrs.id;
+      return attrs;
+    },
+    position: (id) =>
+      Number.isFinite(json.nodes[id].x)
+        ? [json.nodes[id].x, json.nodes[id].y]
+        : null,
+    isWinning: (id) => json.nodes[id].label === "Winning",
+    forEachEdge: (callback) => {
+      for (const e of json.edges) {
+        callback(e.source, e.target, Object.assign({}, e));
+      }
+    },
+  };
+}
+
+// The table of a node, as exported text, a packed state, or a node of
+// graph.bin.
+function nodeTableText(g, node) {
+  const attrs = g.getNodeAttributes(node);
+  if (attrs.table) return attrs.table;
+  if (attrs.state) return packedTableToString(attrs.state);
+  if (graphFile) return nodeTable(graphFile, Number(node));
+  return null;
+}
+
+// The layout worker restarts on every change to the graph, so it is
+// stopped while `change` runs and restarted after.
+function changeGraph(change) {
+  const running =
+    layout && typeof layout.isRunning === "function" && layout.isRunning();
+  if (layout && typeof layout.kill === "function") {
+    try {
+      layout.kill();
+    } catch (_e) {}
+  }
+  layout = null;
+  change();
+  createLayout(currentGraph);
+  if (running) startLayout();
+}
+
+function expandCluster(node) {
+  changeGraph(() => clusterView.expand(node));
+}
+
+// Adds a batch of `rose --serve`, placing each new node next to the first
+// node with an edge to it, which is usually the node it was found from.
+function addBatch(g, batch) {
+  for (const n of batch.nodes) {
+    const attrs = Object.assign({}, n);
+    delete attrs.id;
+    g.addNode(n.id, attrs);
+  }
+  for (const e of batch.edges) {
+    g.mergeEdge(e.source, e.target, Object.assign({}, e));
+  }
+  // Parents have smaller ids, so they are placed before their children.
+  placeNodes(g, batch.nodes, (id) => g.inNeighbors(id));
+}
+
+// Places each of `nodes` next to the first of its `anchors` that was
+// placed already, or next to the origin if none was.
+function placeNodes(g, nodes, anchors) {
+  for (const n of nodes) {
+    const anchor = anchors(n.id).find((a) =>
+      Number.isFinite(g.getNodeAttribute(a, "x")),
+    );
+    const angle = Math.random() * 2 * Math.PI;
+    const x = anchor ? g.getNodeAttribute(anchor, "x") : 0;
+    const y = anchor ? g.getNodeAttribute(anchor, "y") : 0;
+    g.mergeNodeAttributes(n.id, {
+      x: x + STREAM_SPREAD * Math.cos(angle),
+      y: y + STREAM_SPREAD * Math.sin(angle),
+    });
+  }
+}
+
+// Shows the graph while `rose --serve` explores it, adding the nodes and
+// edges of each slice of its BFS as they arrive.
+function streamGraph(url) {
+  const g = new Graph();
+  currentGraph = g;
+  initRenderer(g);
+  const source = new EventSource(url);
+  // A stream that reconnects is sent every batch again.
+  source.addEventListener("open", () => {
+    if (g.order > 0) changeGraph(() => g.clear());
+  });
+  source.addEventListener("batch", (event) => {
+    const batch = JSON.parse(event.data);
+    const first = g.order === 0;
+    changeGraph(() => addBatch(g, batch));
+    if (first) startLayout();
+  });
+  source.addEventListener("done", (event) => {
+    console.log("rose finished exploring", JSON.parse(event.data));
+    source.close();
+  });
+}
+
+// Adds the nodes and edges of a `/neighbourhood` answer of
+// `rose --query` that are not in the graph yet. The answer lists nodes
+// nearest first, so each is placed next to a neighbour nearer the node
+// asked about.
+function addNeighbourhood(g, result) {
+  const added = result.nodes.filter((n) => !g.hasNode(n.id));
+  for (const n of added) {
+    const attrs = {
+      depth: n.depth,
+      color: outcomeColor(
+        n.outcome,
+        n.win_distance,
+        n.depth,
+        result.max_depth,
+        n.winning,
+      ),
+      size: depthSize(n.depth, result.max_depth),
+    };
+    if (n.id === 0) {
+      attrs.label = "Start";
+      attrs.forceLabel = true;
+    } else if (n.winning) {
+      attrs.label = "Winning";
+      attrs.forceLabel = true;
+    }
+    g.addNode(n.id, attrs);
+  }
+  for (const e of result.edges) {
+    g.mergeEdge(e.source, e.target, {
+      type: "arrow",
+      label: e.label,
+      size: 1,
+    });
+  }
+  placeNodes(g, added, (id) => g.neighbors(id));
+}
+
+async function fetchQuery(path) {
+  const response = await fetch(new URL(path, queryUrl));
+  if (!response.ok) throw new Error(`${path}: ${response.status}`);
+  return response.json();
+}
+
+// Fetches the neighbourhood of `node` and adds what is new of it.
+async function exploreNeighbourhood(g, node, hops) {
+  const result = await fetchQuery(`neighbourhood?id=${node}&hops=${hops}`);
+  const first = g.order === 0;
+  changeGraph(() => addNeighbourhood(g, result));
+  if (first) startLayout();
+  if (result.truncated) console.log(`The neighbourhood of ${node} was cut`);
+}
+
+// Shows the graph `rose --query` holds a part at a time: the nodes near
+// the start first, then the neighbours of each node clicked.
+function queryGraph(url) {
+  queryUrl = url;
+  const g = new Graph();
+  currentGraph = g;
+  initRenderer(g);
+  exploreNeighbourhood(g, 0, QUERY_START_HOPS).catch(console.error);
+}
+
+async function showQueriedNode(g, node) {
+  const result = await fetchQuery(`node?id=${node}`);
+  g.setNodeAttribute(node, "table", result.table);
+  tableView.textContent = result.table;
+  await exploreNeighbourhood(g, node, QUERY_CLICK_HOPS);
+}
+
 function initRenderer(g) {
   renderer = new Sigma(g, container, {
     // renderEdgeLabels: true,
   });
   renderer.on("clickNode", ({ node }) => {
-    const attrs = g.getNodeAttributes(node);
-    tableView.textContent = attrs.table || "No table data";
+    if (clusterView?.isCluster(node)) {
+      expandCluster(node);
+      return;
+    }
+    if (queryUrl) {
+      showQueriedNode(g, node).catch(console.error);
+      return;
+    }
+    tableView.textContent = nodeTableText(g, node) || "No table data";
   });
 }
 
-async function loadAndRender(path = "graph.json") {
-  const graph = await loadGraph(path);
-  renderer = resetRenderer(renderer);
+async function loadAndRender() {
   if (!Graph) throw new Error("graphology not available");
   if (!Sigma) throw new Error("Sigma module not available");
-  currentGraph = jsonToGraph(graph);
+  const params = new URLSearchParams(window.location.search);
+  const streamUrl = params.get("stream");
+  if (streamUrl !== null) {
+    streamGraph(streamUrl || DEFAULT_STREAM_URL);
+    return;
+  }
+  const url = params.get("query");
+  if (url !== null) {
+    queryGraph(url || DEFAULT_QUERY_URL);
+    return;
+  }
+  const graph = await loadGraph();
+  renderer = resetRenderer(renderer);
+  currentGraph = graph;
   setNodeCoordinates(currentGraph);
   initRenderer(currentGraph);
-  layoutToggleBtn.textContent = "Stop layout";
 }
 
 loadAndRender();
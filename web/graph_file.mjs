@@ -0,0 +1,203 @@
+// Reads the binary graph format written by `write_graph_to_binary_file`
+// and described in graph_file.hpp. Every array is a view into the fetched
+// buffer, so nothing is parsed or copied per node.
+import { TABLE_STATE_SIZE, tableToString } from "./table.mjs";
+
+const MAGIC = "ROSEGRPH";
+const VERSION = 2;
+const HEADER_SIZE = 32;
+export const WINNING_FLAG = 1;
+const WINNABLE_FLAG = 2;
+const LOSING_FLAG = 4;
+const HAS_POSITIONS = 1;
+const HAS_CLUSTERS = 2;
+const HAS_OUTCOMES = 4;
+const KNOWN_FLAGS = HAS_POSITIONS | HAS_CLUSTERS | HAS_OUTCOMES;
+
+const MOVE_TYPES = ["SW", "WF", "WT", "TF", "TT", "FT"];
+
+function alignTo8(offset) {
+  return Math.ceil(offset / 8) * 8;
+}
+
+function layout(nNodes, nEdges, hasPositions) {
+  const depths = HEADER_SIZE;
+  const edgeOffsets = alignTo8(depths + 4 * nNodes);
+  const edgeTargets = alignTo8(edgeOffsets + 4 * (nNodes + 1));
+  const edgeMoves = alignTo8(edgeTargets + 4 * nEdges);
+  const flags = alignTo8(edgeMoves + 2 * nEdges);
+  const states = alignTo8(flags + nNodes);
+  const positions = alignTo8(states + TABLE_STATE_SIZE * nNodes);
+  const clusters = alignTo8(positions + (hasPositions ? 8 * nNodes : 0));
+  return {
+    depths,
+    edgeOffsets,
+    edgeTargets,
+    edgeMoves,
+    flags,
+    states,
+    positions,
+    clusters,
+  };
+}
+
+export function parseGraphFile(buffer) {
+  const view = new DataView(buffer);
+  const magic = new TextDecoder().decode(new Uint8Array(buffer, 0, 8));
+  if (buffer.byteLength < HEADER_SIZE || magic !== MAGIC) {
+    throw new Error("Not a graph file");
+  }
+  const version = view.getUint32(8, true);
+  if (version !== VERSION) {
+    throw new Error(`Unsupported graph file version ${version}`);
+  }
+  const nNodes = view.getUint32(12, true);
+  const nEdges = view.getUint32(16, true);
+  const maxDepth = view.getUint32(20, true);
+  if (view.getUint32(24, true) !== TABLE_STATE_SIZE) {
+    throw new Error("Unsupported graph file state size");
+  }
+  const flags = view.getUint32(28, true);
+  if ((flags & ~KNOWN_FLAGS) !== 0) {
+    throw new Error(`Unsupported graph file flags ${flags}`);
+  }
+  const offsets = layout(nNodes, nEdges, (flags & HAS_POSITIONS) !== 0);
+  let size = offsets.clusters;
+  // The cluster of each node, then of each cluster of each level in the
+  // next, led by the level count and the cluster counts.
+  let clusters = null;
+  if (flags & HAS_CLUSTERS) {
+    if (buffer.byteLength < offsets.clusters + 4) {
+      throw new Error("Graph file size does not match its header");
+    }
+    const nLevels = view.getUint32(offsets.clusters, true);
+    const counts = new Uint32Array(buffer, offsets.clusters + 4, nLevels);
+    clusters = [];
+    let offset = offsets.clusters + 4 * (1 + nLevels);
+    let levelSize = nNodes;
+    for (const count of counts) {
+      if (buffer.byteLength < offset + 4 * levelSize) break;
+      clusters.push(new Uint32Array(buffer, offset, levelSize));
+      offset += 4 * levelSize;
+      levelSize = count;
+    }
+    size = alignTo8(offset);
+  }
+  // The distance of each node to a win, after the clusters.
+  let winDistances = null;
+  if (flags & HAS_OUTCOMES) {
+    if (buffer.byteLength >= size + 4 * nNodes) {
+      winDistances = new Uint32Array(buffer, size, nNodes);
+    }
+    size = alignTo8(size + 4 * nNodes);
+  }
+  if (size !== buffer.byteLength) {
+    throw new Error("Graph file size does not match its header");
+  }
+  return {
+    nNodes,
+    nEdges,
+    maxDepth,
+    depths: new Uint32Array(buffer, offsets.depths, nNodes),
+    edgeOffsets: new Uint32Array(buffer, offsets.edgeOffsets, nNodes + 1),
+    edgeTargets: new Uint32Array(buffer, offsets.edgeTargets, nEdges),
+    edgeMoves: new Uint16Array(buffer, offsets.edgeMoves, nEdges),
+    flags: new Uint8Array(buffer, offsets.flags, nNodes),
+    states: new Uint8Array(buffer, offsets.states, TABLE_STATE_SIZE * nNodes),
+    // x and y of each node, laid out by rose, or null.
+    positions:
+      flags & HAS_POSITIONS
+        ? new Float32Array(buffer, offsets.positions, 2 * nNodes)
+        : null,
+    clusters,
+    // Labelled by rose with `--outcomes`, or null.
+    winDistances,
+  };
+}
+
+export function moveTypeToString(bits) {
+  return MOVE_TYPES[bits & 7];
+}
+
+// "winnable", "losing" or "unknown", as `outcome_to_string` in rose
+// names them, or null for a file without outcomes.
+export function nodeOutcome(file, id) {
+  if (!file.winDistances) return null;
+  if (file.flags[id] & WINNABLE_FLAG) return "winnable";
+  if (file.flags[id] & LOSING_FLAG) return "losing";
+  return "unknown";
+}
+
+export function nodeTable(file, id) {
+  const start = id * TABLE_STATE_SIZE;
+  return tableToString(file.states.subarray(start, start + TABLE_STATE_SIZE));
+}
+
+// Colours and sizes as `node_colour` and `get_node_size` in
+// serialise.cpp set them in graph.json.
+const START_COLOR = [0x14, 0x46, 0xa0];
+const END_COLOR = [0xdb, 0x30, 0x69];
+const WINNING_COLOR = "#4CAF50FF";
+const WINNING_RGB = [0x4c, 0xaf, 0x50];
+const WINNABLE_FAR_RGB = [0x1b, 0x5e, 0x20];
+const WINNABLE_FAR_MOVES = 150;
+const DEADEND_COLOR = "#F5D547FF";
+const NODE_MIN_SIZE = 1;
+const NODE_MAX_SIZE = 4;
+
+function hex(value) {
+  return value.toString(16).toUpperCase().padStart(2, "0");
+}
+
+// The colour of a node `depth` moves from the start of a graph explored
+// to `maxDepth`.
+export function depthColor(depth, maxDepth, winning) {
+  if (winning) return WINNING_COLOR;
+  return lerpColor(START_COLOR, END_COLOR, depth / maxDepth);
+}
+
+function lerpColor(from, to, t) {
+  const rgb = from.map((start, i) =>
+    Math.trunc(start * (1 - t) + to[i] * t),
+  );
+  return `#${rgb.map(hex).join("")}FF`;
+}
+
+// The colour of a node labelled with an `outcome` by rose: winnable nodes
+// darken with their distance to a win, losing ones take the dead-end
+// colour and unknown ones keep the colour of their depth.
+export function outcomeColor(
+  outcome,
+  winDistance,
+  depth,
+  maxDepth,
+  winning,
+) {
+  if (outcome === "losing") return DEADEND_COLOR;
+  if (outcome === "winnable") {
+    const t = Math.min(1, winDistance / WINNABLE_FAR_MOVES);
+    return lerpColor(WINNING_RGB, WINNABLE_FAR_RGB, t);
+  }
+  return depthColor(depth, maxDepth, winning);
+}
+
+export function depthSize(depth, maxDepth) {
+  return (
+    NODE_MIN_SIZE +
+    ((maxDepth - depth) * (NODE_MAX_SIZE - NODE_MIN_SIZE)) / maxDepth
+  );
+}
+
+export function nodeColor(file, id) {
+  return outcomeColor(
+    nodeOutcome(file, id),
+    file.winDistances?.[id],
+    file.depths[id],
+    file.maxDepth,
+    (file.flags[id] & WINNING_FLAG) !== 0,
+  );
+}
+
+export function nodeSize(file, id) {
+  return depthSize(file.depths[id], file.maxDepth);
+}
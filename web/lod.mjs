@@ -0,0 +1,224 @@
+// Shows a graph through the cluster hierarchy that `rose --lod` exports:
+// the clusters of the top level first, each replaced by the clusters or
+// nodes it holds when it is clicked. `parents[k][i]` is the cluster in
+// level k + 1 of item i of level k, where level 0 holds the graph's nodes.
+//
+// A source describes the graph's nodes and edges:
+//   nNodes
+//   nodeAttributes(id)    Sigma attributes of a node
+//   position(id)          [x, y] laid out by rose, or null
+//   isWinning(id)
+//   forEachEdge((source, target, attrs) => ...)
+import Graph from "graphology";
+
+const CLUSTER_MIN_SIZE = 4;
+const CLUSTER_MAX_SIZE = 12;
+
+function clusterKey(level, index) {
+  return level === 0 ? String(index) : `c${level}:${index}`;
+}
+
+function parseKey(key) {
+  if (!key.startsWith("c")) return { level: 0, index: Number(key) };
+  const [level, index] = key.slice(1).split(":").map(Number);
+  return { level, index };
+}
+
+function maxOf(array) {
+  let max = 0;
+  for (const value of array) max = Math.max(max, value);
+  return max;
+}
+
+export class ClusterView {
+  constructor(source, parents) {
+    this.source = source;
+    this.parents = parents;
+    this.top = parents.length;
+    this.sizes = [source.nNodes];
+    for (let k = 0; k < this.top; k++) {
+      this.sizes.push(
+        k + 1 < this.top ? parents[k + 1].length : maxOf(parents[k]) + 1,
+      );
+    }
+    this.expanded = this.sizes.map((size) => new Uint8Array(size));
+    this.summarise();
+    this.indexChildren();
+    this.graph = new Graph();
+    for (let i = 0; i < this.sizes[this.top]; i++) {
+      this.addItem(this.top, i, null);
+    }
+    this.resetEdges();
+  }
+
+  isCluster(key) {
+    return key.startsWith("c");
+  }
+
+  // Node counts, first nodes, labels and centres of mass of the clusters
+  // of each level, built up from the level below. Clusters are numbered in
+  // the order of their first node, which is their shallowest.
+  summarise() {
+    this.summaries = [null];
+    let below = null;
+    for (let k = 0; k < this.top; k++) {
+      const size = this.sizes[k + 1];
+      const summary = {
+        count: new Uint32Array(size),
+        first: new Uint32Array(size).fill(0xffffffff),
+        start: new Uint8Array(size),
+        winning: new Uint8Array(size),
+        x: new Float64Array(size),
+        y: new Float64Array(size),
+      };
+      const parents = this.parents[k];
+      for (let i = 0; i < parents.length; i++) {
+        const c = parents[i];
+        if (k === 0) {
+          const position = this.source.position(i);
+          summary.count[c] += 1;
+          summary.first[c] = Math.min(summary.first[c], i);
+          summary.start[c] |= i === 0;
+          summary.winning[c] |= this.source.isWinning(i);
+          if (position) {
+            summary.x[c] += position[0];
+            summary.y[c] += position[1];
+          }
+        } else {
+          summary.count[c] += below.count[i];
+          summary.first[c] = Math.min(summary.first[c], below.first[i]);
+          summary.start[c] |= below.start[i];
+          summary.winning[c] |= below.winning[i];
+          summary.x[c] += below.x[i];
+          summary.y[c] += below.y[i];
+        }
+      }
+      this.summaries.push(summary);
+      below = summary;
+    }
+  }
+
+  // The items of the level below each cluster, in CSR form.
+  indexChildren() {
+    this.children = [null];
+    for (let k = 0; k < this.top; k++) {
+      const parents = this.parents[k];
+      const offsets = new Uint32Array(this.sizes[k + 1] + 1);
+      for (const c of parents) offsets[c + 1]++;
+      for (let c = 0; c < this.sizes[k + 1]; c++) {
+        offsets[c + 1] += offsets[c];
+      }
+      const items = new Uint32Array(parents.length);
+      const next = offsets.slice(0, -1);
+      for (let i = 0; i < parents.length; i++) items[next[parents[i]]++] = i;
+      this.children.push({ offsets, items });
+    }
+  }
+
+  clusterAttributes(level, index) {
+    const summary = this.summaries[level];
+    const count = summary.count[index];
+    const first = this.source.nodeAttributes(summary.first[index]);
+    const attrs = {
+      color: first.color,
+      size: Math.min(
+        CLUSTER_MIN_SIZE + 2 * Math.log10(count),
+        CLUSTER_MAX_SIZE,
+      ),
+      label: `${count} nodes`,
+    };
+    if (summary.start[index]) {
+      attrs.label = "Start";
+      attrs.forceLabel = true;
+    } else if (summary.winning[index]) {
+      attrs.label = "Winning";
+      attrs.forceLabel = true;
+    }
+    if (this.source.position(0)) {
+      attrs.x = summary.x[index] / count;
+      attrs.y = summary.y[index] / count;
+    }
+    return attrs;
+  }
+
+  // Adds an item, placing it near `around` if rose did not lay it out.
+  addItem(level, index, around) {
+    const attrs =
+      level === 0
+        ? this.source.nodeAttributes(index)
+        : this.clusterAttributes(level, index);
+    if (around && !Number.isFinite(attrs.x)) {
+      const angle = Math.random() * 2 * Math.PI;
+      attrs.x = around.x + around.radius * Math.cos(angle);
+      attrs.y = around.y + around.radius * Math.sin(angle);
+    }
+    this.graph.addNode(clusterKey(level, index), attrs);
+  }
+
+  // Replaces a cluster with the items it holds. Returns whether `key` was
+  // a cluster.
+  expand(key) {
+    if (!this.isCluster(key) || !this.graph.hasNode(key)) return false;
+    const { level, index } = parseKey(key);
+    const attrs = this.graph.getNodeAttributes(key);
+    const around = { x: attrs.x, y: attrs.y, radius: this.spacing() / 4 };
+    this.graph.dropNode(key);
+    this.expanded[level][index] = 1;
+    const { offsets, items } = this.children[level];
+    for (let i = offsets[index]; i < offsets[index + 1]; i++) {
+      this.addItem(level - 1, items[i], around);
+    }
+    this.resetEdges();
+    return true;
+  }
+
+  // The typical distance between neighbouring items on screen.
+  spacing() {
+    let minX = Infinity;
+    let maxX = -Infinity;
+    let minY = Infinity;
+    let maxY = -Infinity;
+    this.graph.forEachNode((_node, { x, y }) => {
+      minX = Math.min(minX, x);
+      maxX = Math.max(maxX, x);
+      minY = Math.min(minY, y);
+      maxY = Math.max(maxY, y);
+    });
+    const extent = Math.max(maxX - minX, maxY - minY, 1);
+    return extent / Math.sqrt(Math.max(this.graph.order, 1));
+  }
+
+  // The key of the item shown for each node: its highest ancestor that
+  // is not expanded.
+  visibleKeys() {
+    const keys = new Array(this.source.nNodes);
+    const chain = new Uint32Array(this.top + 1);
+    for (let node = 0; node < this.source.nNodes; node++) {
+      chain[0] = node;
+      for (let k = 0; k < this.top; k++) {
+        chain[k + 1] = this.parents[k][chain[k]];
+      }
+      let level = this.top;
+      while (level > 0 && this.expanded[level][chain[level]]) level--;
+      keys[node] = clusterKey(level, chain[level]);
+    }
+    return keys;
+  }
+
+  // Draws the graph's edges between the items shown, merging the edges
+  // between two clusters into one.
+  resetEdges() {
+    const keys = this.visibleKeys();
+    this.graph.clearEdges();
+    this.source.forEachEdge((source, target, attrs) => {
+      const from = keys[source];
+      const to = keys[target];
+      if (from === to || this.graph.hasEdge(from, to)) return;
+      const shown =
+        this.isCluster(from) || this.isCluster(to)
+          ? { type: "arrow", size: 1 }
+          : attrs;
+      this.graph.addEdge(from, to, shown);
+    });
+  }
+}
@@ -0,0 +1,97 @@
+// Renders a packed table (`Table::pack` in table.hpp) as the text of
+// `Table::to_string`, so exported graphs need not carry the text.
+
+const NUM_CARDS = 52;
+const NULL_INDEX = NUM_CARDS;
+const HIDDEN_INDEX = NUM_CARDS + 1;
+const NUM_SUITS = 4;
+const TABLEAU_COLUMNS = 7;
+
+const STOCK_OFFSET = 0;
+const WASTE_OFFSET = 1;
+const FOUNDATION_OFFSET = 2;
+const VISIBLE_OFFSET = FOUNDATION_OFFSET + NUM_SUITS;
+const HIDDEN_OFFSET = VISIBLE_OFFSET + TABLEAU_COLUMNS;
+const DECK_OFFSET = HIDDEN_OFFSET + TABLEAU_COLUMNS;
+export const TABLE_STATE_SIZE = DECK_OFFSET + NUM_CARDS;
+
+const SUITS = ["♠", "♥", "♦", "♣"];
+const RANKS = [
+  "A",
+  "2",
+  "3",
+  "4",
+  "5",
+  "6",
+  "7",
+  "8",
+  "9",
+  "10",
+  "J",
+  "Q",
+  "K",
+];
+
+function cardToString(card) {
+  if (card === HIDDEN_INDEX) return "?";
+  if (card === NULL_INDEX) return " ";
+  return RANKS[Math.floor(card / NUM_SUITS)] + SUITS[card % NUM_SUITS];
+}
+
+function center(text, width) {
+  const padding = Math.max(width - text.length, 0);
+  const left = Math.floor(padding / 2);
+  return " ".repeat(left) + text + " ".repeat(padding - left);
+}
+
+// Cards of the pile starting at `top`, from the top down.
+function pile(state, top) {
+  const cards = [];
+  for (let card = top; card !== NULL_INDEX; ) {
+    cards.push(card);
+    card = state[DECK_OFFSET + card];
+  }
+  return cards;
+}
+
+function headerToString(state) {
+  const stock = state[STOCK_OFFSET] === NULL_INDEX ? " " : "?";
+  let result = `Stock: ${stock.padEnd(3)}`;
+  result += `Waste: ${cardToString(state[WASTE_OFFSET]).padEnd(3)}`;
+  result += "Foundations: ";
+  for (let suit = 0; suit < NUM_SUITS; suit++) {
+    result += cardToString(state[FOUNDATION_OFFSET + suit]).padEnd(4);
+  }
+  return `${result}\n`;
+}
+
+function tableauToString(state) {
+  const columns = [];
+  for (let col = 0; col < TABLEAU_COLUMNS; col++) {
+    const hidden = pile(state, state[HIDDEN_OFFSET + col]);
+    const visible = pile(state, state[VISIBLE_OFFSET + col]);
+    // Bottom to top, with hidden cards first.
+    columns.push(hidden.map(() => HIDDEN_INDEX).concat(visible.reverse()));
+  }
+  const depth = Math.max(...columns.map((column) => column.length));
+  let result = "";
+  for (let row = 0; row < depth; row++) {
+    for (const column of columns) {
+      result +=
+        row < column.length ? center(cardToString(column[row]), 5) : "     ";
+    }
+    result += "\n";
+  }
+  return result;
+}
+
+export function tableToString(state) {
+  return headerToString(state) + tableauToString(state);
+}
+
+// Decodes the base64 "state" of a graph.json node exported with
+// `--packed-tables`.
+export function packedTableToString(base64) {
+  const state = Uint8Array.from(atob(base64), (c) => c.charCodeAt(0));
+  return tableToString(state);
+}